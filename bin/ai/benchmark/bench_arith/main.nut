@@ -0,0 +1,17 @@
+/* $Id$ */
+
+/* Integer arithmetic and comparisons on local variables. */
+class Benchmark extends AIController {
+	function Start();
+};
+
+function Benchmark::Start()
+{
+	local sum = 0;
+	while (true) {
+		for (local i = 0; i < 10000; i++) {
+			sum += i * 3 - (i % 7);
+			if (sum > 100000000) sum -= 100000000;
+		}
+	}
+}
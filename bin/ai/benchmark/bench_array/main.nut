@@ -0,0 +1,19 @@
+/* $Id$ */
+
+/* Reading and writing the elements of a local array. */
+class Benchmark extends AIController {
+	function Start();
+};
+
+function Benchmark::Start()
+{
+	local a = array(100, 0);
+	local sum = 0;
+	while (true) {
+		for (local i = 0; i < 10000; i++) {
+			local j = i % 100;
+			a[j] = a[j] + i;
+			sum = (sum + a[(j * 7) % 100]) % 1000003;
+		}
+	}
+}
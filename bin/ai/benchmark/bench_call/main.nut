@@ -0,0 +1,32 @@
+/* $Id$ */
+
+/* Calling functions and methods of class instances. */
+class Counter {
+	count = 0;
+
+	function Increase()
+	{
+		this.count++;
+		return this.count;
+	}
+};
+
+function Add(a, b)
+{
+	return a + b;
+}
+
+class Benchmark extends AIController {
+	function Start();
+};
+
+function Benchmark::Start()
+{
+	local counter = Counter();
+	local sum = 0;
+	while (true) {
+		for (local i = 0; i < 10000; i++) {
+			sum = Add(sum, counter.Increase()) % 1000;
+		}
+	}
+}
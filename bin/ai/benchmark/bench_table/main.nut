@@ -0,0 +1,20 @@
+/* $Id$ */
+
+/* Reading and writing the slots of a local table. */
+class Benchmark extends AIController {
+	function Start();
+};
+
+function Benchmark::Start()
+{
+	local t = { a = 1, b = 2, c = 3 };
+	local sum = 0;
+	while (true) {
+		for (local i = 0; i < 10000; i++) {
+			t.a = t.b + i;
+			sum += t.a + t.c;
+			t.b = i % 5;
+		}
+		sum = 0;
+	}
+}
@@ -0,0 +1,14 @@
+/* $Id$ */
+
+class Benchmark extends AIInfo {
+	function GetAuthor()      { return "OpenTTD NoAI Developers Team"; }
+	function GetName()        { return "Benchmark"; }
+	function GetShortName()   { return "BNCH"; }
+	function GetDescription() { return "This runs a micro-benchmark of the script interpreter for as long as the game runs."; }
+	function GetVersion()     { return 1; }
+	function GetAPIVersion()  { return "1.9"; }
+	function GetDate()        { return "2018-06-01"; }
+	function CreateInstance() { return "Benchmark"; }
+}
+
+RegisterAI(Benchmark());
@@ -0,0 +1,126 @@
+#!/bin/sh
+
+# $Id$
+
+# Micro-benchmarks of the script interpreter. Each benchmark is an AI that
+# executes the same small loop for as long as the game runs; the game is run
+# for a fixed number of ticks with the null drivers, so the same amount of
+# script operations is executed every run and the time it takes is measured.
+#
+# Usage: run.sh [<benchmark> [<ticks>]]
+#        run.sh newgrf <savegame> [<iterations>]
+#        run.sh blitter <savegame> [<iterations>] [<resolution>]
+#        run.sh game <savegame> [<ticks>]
+#
+# 'newgrf' measures resolving the NewGRF sprite groups of the engines and
+# vehicles of a savegame with the newgrf_benchmark console command.
+# 'blitter' measures drawing the savegame with every 32bpp blitter using the
+# blitter_benchmark console command; this needs base graphics and a build
+# that is not a dedicated server.
+# 'game' measures the time a game loop of the savegame takes; running the
+# savegame for one tick is timed as well, so loading it is not counted; so it
+# needs at least 2 ticks.
+
+if ! [ -f ai/benchmark/run.sh ]; then
+	echo "Make sure you are in the root of OpenTTD before starting this script."
+	exit 1
+fi
+
+if [ -f scripts/game_start.scr ]; then
+	mv scripts/game_start.scr scripts/game_start.scr.benchmark
+fi
+
+# Run a console command on a savegame and print what it printed to the console.
+# $1 is the savegame, $2 the console command; the other parameters are passed to openttd.
+run_console_benchmark() {
+	sav=$1
+	cmd=$2
+	shift 2
+
+	rm -f ai/benchmark/tmp.log
+	echo "script ai/benchmark/tmp.log" > scripts/game_start.scr
+	echo "$cmd" >> scripts/game_start.scr
+	echo "script" >> scripts/game_start.scr
+
+	./openttd -x -c ai/benchmark/benchmark.cfg -snull -mnull -vnull:ticks=1 "$@" -g $sav > /dev/null 2>&1
+	if [ -f ai/benchmark/tmp.log ]; then
+		grep -v "^file output started to" ai/benchmark/tmp.log
+	fi
+
+	rm -f ai/benchmark/tmp.log scripts/game_start.scr
+}
+
+case "$1" in
+	newgrf)
+		iterations=100
+		if [ -n "$3" ]; then
+			iterations=$3
+		fi
+		run_console_benchmark "$2" "newgrf_benchmark $iterations"
+		;;
+
+	blitter)
+		iterations=100
+		if [ -n "$3" ]; then
+			iterations=$3
+		fi
+		resolution=1920x1080
+		if [ -n "$4" ]; then
+			resolution=$4
+		fi
+		# Blitters that are not available (on this CPU) make openttd stop before it prints anything.
+		for blitter in 32bpp-optimized 32bpp-anim 32bpp-sse2 32bpp-sse2-anim 32bpp-ssse3 32bpp-sse4 32bpp-sse4-anim 32bpp-avx2 32bpp-avx2-anim; do
+			run_console_benchmark "$2" "blitter_benchmark $iterations" -b $blitter -r $resolution
+		done
+		;;
+
+	game)
+		ticks=1000
+		if [ -n "$3" ]; then
+			ticks=$3
+		fi
+		if [ "$ticks" -lt 2 ]; then
+			echo "The game benchmark needs at least 2 ticks."
+			if [ -f scripts/game_start.scr.benchmark ]; then
+				mv scripts/game_start.scr.benchmark scripts/game_start.scr
+			fi
+			exit 1
+		fi
+
+		start=`date +%s%N`
+		./openttd -x -c ai/benchmark/benchmark.cfg -snull -mnull -vnull:ticks=1 -g $2 > /dev/null 2>&1
+		middle=`date +%s%N`
+		./openttd -x -c ai/benchmark/benchmark.cfg -snull -mnull -vnull:ticks=$ticks -g $2 > /dev/null 2>&1
+		end=`date +%s%N`
+		echo "`basename $2`: $(( ((end - middle) - (middle - start)) / (ticks - 1) / 1000 )) us per tick over $ticks ticks"
+		;;
+
+	*)
+		ticks=5000
+		if [ -n "$2" ]; then
+			ticks=$2
+		fi
+
+		if [ -d "ai/benchmark/bench_$1" ]; then
+			benchmarks="ai/benchmark/bench_$1"
+		else
+			benchmarks=ai/benchmark/bench_*
+		fi
+
+		for bench in $benchmarks; do
+			# Make sure that only one info.nut is present for each run. Otherwise openttd gets confused.
+			cp ai/benchmark/benchmark_info.nut $bench/info.nut
+
+			start=`date +%s%N`
+			./openttd -x -c ai/benchmark/benchmark.cfg -snull -mnull -vnull:ticks=$ticks -g ai/regression/empty.sav > /dev/null 2>&1
+			end=`date +%s%N`
+			echo "`basename $bench`: $(( (end - start) / 1000000 )) ms for $ticks ticks"
+
+			rm $bench/info.nut
+		done
+		;;
+esac
+
+if [ -f scripts/game_start.scr.benchmark ]; then
+	mv scripts/game_start.scr.benchmark scripts/game_start.scr
+fi
@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# $Id$
+
+# Checks that the TGP map generator generates the expected height maps. Every
+# map of heightmap.txt is generated on a single thread and on multiple threads;
+# both must give the height map with the listed hash.
+#
+# Each line of heightmap.txt is: <seed> <map_x> <map_y> <climate> <hash>
+# where map_x and map_y are the logarithms of the map size and climate is the
+# number of the landscape setting. To add a map, use '-' as hash and copy the
+# hash this script prints.
+
+if ! [ -f ai/regression/heightmap.sh ]; then
+	echo "Make sure you are in the root of OpenTTD before starting this script."
+	exit 1
+fi
+
+if [ -f scripts/autoexec.scr ]; then
+	mv scripts/autoexec.scr scripts/autoexec.scr.regression
+fi
+
+ret=0
+while read seed map_x map_y climate expected; do
+	case "$seed" in
+		""|"#"*) continue ;;
+	esac
+
+	for threads in 1 8; do
+		echo -n "Generating map $seed (2^$map_x x 2^$map_y, climate $climate) on $threads thread(s)... "
+
+		echo "setting map_x $map_x" > scripts/autoexec.scr
+		echo "setting map_y $map_y" >> scripts/autoexec.scr
+		echo "setting landscape $climate" >> scripts/autoexec.scr
+		echo "tgp_threads $threads" >> scripts/autoexec.scr
+
+		hash=`./openttd -x -c ai/regression/heightmap.cfg -snull -mnull -vnull:ticks=1 -G $seed -g -d map=1 < /dev/null 2>&1 | sed -n 's/.*Generated height map with hash \([0-9a-f]*\).*/\1/p'`
+		if [ "$hash" = "$expected" ]; then
+			echo "passed!"
+		else
+			echo "failed! Expected hash $expected, got '$hash'"
+			ret=1
+		fi
+	done
+done < ai/regression/heightmap.txt
+
+rm -f scripts/autoexec.scr
+
+if [ -f scripts/autoexec.scr.regression ]; then
+	mv scripts/autoexec.scr.regression scripts/autoexec.scr
+fi
+
+exit $ret
@@ -324,6 +324,7 @@ SQRESULT sq_getobjtypetag(HSQOBJECT *o,SQUserPointer * typetag);
 
 /*GC*/
 SQInteger sq_collectgarbage(HSQUIRRELVM v);
+SQInteger sq_collectgarbagestep(HSQUIRRELVM v,SQInteger work);
 
 /*serialization*/
 SQRESULT sq_writeclosure(HSQUIRRELVM vm,SQWRITEFUNC writef,SQUserPointer up);
@@ -1090,6 +1090,15 @@ SQInteger sq_collectgarbage(HSQUIRRELVM v)
 #endif
 }
 
+SQInteger sq_collectgarbagestep(HSQUIRRELVM v,SQInteger work)
+{
+#ifndef NO_GARBAGE_COLLECTOR
+	return _ss(v)->CollectGarbageStep(v,work);
+#else
+	return -1;
+#endif
+}
+
 const SQChar *sq_getfreevariable(HSQUIRRELVM v,SQInteger idx,SQUnsignedInteger nval)
 {
 	SQObjectPtr &self = stack_get(v,idx);
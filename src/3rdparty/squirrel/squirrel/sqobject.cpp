@@ -486,104 +486,83 @@ bool SQFunctionProto::Load(SQVM *v,SQUserPointer up,SQREADFUNC read,SQObjectPtr
 
 #ifndef NO_GARBAGE_COLLECTOR
 
-#define START_MARK() 	if(!(_uiRef&MARK_FLAG)){ \
-		_uiRef|=MARK_FLAG;
-
-#define END_MARK() RemoveFromChain(&_sharedstate->_gc_chain, this); \
-		AddToChain(chain, this); }
+/* The Mark functions mark the objects referenced by an object that has been
+ * marked itself already; see SQSharedState::CollectGarbageStep. */
 
 void SQVM::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		SQSharedState::MarkObject(_lasterror,chain);
-		SQSharedState::MarkObject(_errorhandler,chain);
-		SQSharedState::MarkObject(_debughook,chain);
-		SQSharedState::MarkObject(_roottable, chain);
-		SQSharedState::MarkObject(temp_reg, chain);
-		for(SQUnsignedInteger i = 0; i < _stack.size(); i++) SQSharedState::MarkObject(_stack[i], chain);
-		for(SQUnsignedInteger j = 0; j < _vargsstack.size(); j++) SQSharedState::MarkObject(_vargsstack[j], chain);
-		for(SQInteger k = 0; k < _callsstacksize; k++) SQSharedState::MarkObject(_callsstack[k]._closure, chain);
-	END_MARK()
+	_sharedstate->MarkObject(_lasterror,chain);
+	_sharedstate->MarkObject(_errorhandler,chain);
+	_sharedstate->MarkObject(_debughook,chain);
+	_sharedstate->MarkObject(_roottable, chain);
+	_sharedstate->MarkObject(temp_reg, chain);
+	for(SQUnsignedInteger i = 0; i < _stack.size(); i++) _sharedstate->MarkObject(_stack[i], chain);
+	for(SQUnsignedInteger j = 0; j < _vargsstack.size(); j++) _sharedstate->MarkObject(_vargsstack[j], chain);
+	for(SQInteger k = 0; k < _callsstacksize; k++) _sharedstate->MarkObject(_callsstack[k]._closure, chain);
 }
 
 void SQArray::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		SQInteger len = _values.size();
-		for(SQInteger i = 0;i < len; i++) SQSharedState::MarkObject(_values[i], chain);
-	END_MARK()
+	SQInteger len = _values.size();
+	for(SQInteger i = 0;i < len; i++) _sharedstate->MarkObject(_values[i], chain);
 }
 void SQTable::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		if(_delegate) _delegate->Mark(chain);
-		SQInteger len = _numofnodes;
-		for(SQInteger i = 0; i < len; i++){
-			SQSharedState::MarkObject(_nodes[i].key, chain);
-			SQSharedState::MarkObject(_nodes[i].val, chain);
-		}
-	END_MARK()
+	if(_delegate) _sharedstate->MarkCollectable(_delegate,chain);
+	SQInteger len = _numofnodes;
+	for(SQInteger i = 0; i < len; i++){
+		_sharedstate->MarkObject(_nodes[i].key, chain);
+		_sharedstate->MarkObject(_nodes[i].val, chain);
+	}
 }
 
 void SQClass::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		_members->Mark(chain);
-		if(_base) _base->Mark(chain);
-		SQSharedState::MarkObject(_attributes, chain);
-		for(SQUnsignedInteger i =0; i< _defaultvalues.size(); i++) {
-			SQSharedState::MarkObject(_defaultvalues[i].val, chain);
-			SQSharedState::MarkObject(_defaultvalues[i].attrs, chain);
-		}
-		for(SQUnsignedInteger j =0; j< _methods.size(); j++) {
-			SQSharedState::MarkObject(_methods[j].val, chain);
-			SQSharedState::MarkObject(_methods[j].attrs, chain);
-		}
-		for(SQUnsignedInteger k =0; k< _metamethods.size(); k++) {
-			SQSharedState::MarkObject(_metamethods[k], chain);
-		}
-	END_MARK()
+	_sharedstate->MarkCollectable(_members,chain);
+	if(_base) _sharedstate->MarkCollectable(_base,chain);
+	_sharedstate->MarkObject(_attributes, chain);
+	for(SQUnsignedInteger i =0; i< _defaultvalues.size(); i++) {
+		_sharedstate->MarkObject(_defaultvalues[i].val, chain);
+		_sharedstate->MarkObject(_defaultvalues[i].attrs, chain);
+	}
+	for(SQUnsignedInteger j =0; j< _methods.size(); j++) {
+		_sharedstate->MarkObject(_methods[j].val, chain);
+		_sharedstate->MarkObject(_methods[j].attrs, chain);
+	}
+	for(SQUnsignedInteger k =0; k< _metamethods.size(); k++) {
+		_sharedstate->MarkObject(_metamethods[k], chain);
+	}
 }
 
 void SQInstance::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		_class->Mark(chain);
-		SQUnsignedInteger nvalues = _class->_defaultvalues.size();
-		for(SQUnsignedInteger i =0; i< nvalues; i++) {
-			SQSharedState::MarkObject(_values[i], chain);
-		}
-	END_MARK()
+	_sharedstate->MarkCollectable(_class,chain);
+	SQUnsignedInteger nvalues = _class->_defaultvalues.size();
+	for(SQUnsignedInteger i =0; i< nvalues; i++) {
+		_sharedstate->MarkObject(_values[i], chain);
+	}
 }
 
 void SQGenerator::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		for(SQUnsignedInteger i = 0; i < _stack.size(); i++) SQSharedState::MarkObject(_stack[i], chain);
-		for(SQUnsignedInteger j = 0; j < _vargsstack.size(); j++) SQSharedState::MarkObject(_vargsstack[j], chain);
-		SQSharedState::MarkObject(_closure, chain);
-	END_MARK()
+	for(SQUnsignedInteger i = 0; i < _stack.size(); i++) _sharedstate->MarkObject(_stack[i], chain);
+	for(SQUnsignedInteger j = 0; j < _vargsstack.size(); j++) _sharedstate->MarkObject(_vargsstack[j], chain);
+	_sharedstate->MarkObject(_closure, chain);
 }
 
 void SQClosure::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		for(SQUnsignedInteger i = 0; i < _outervalues.size(); i++) SQSharedState::MarkObject(_outervalues[i], chain);
-		for(SQUnsignedInteger i = 0; i < _defaultparams.size(); i++) SQSharedState::MarkObject(_defaultparams[i], chain);
-	END_MARK()
+	for(SQUnsignedInteger i = 0; i < _outervalues.size(); i++) _sharedstate->MarkObject(_outervalues[i], chain);
+	for(SQUnsignedInteger i = 0; i < _defaultparams.size(); i++) _sharedstate->MarkObject(_defaultparams[i], chain);
 }
 
 void SQNativeClosure::Mark(SQCollectable **chain)
 {
-	START_MARK()
-		for(SQUnsignedInteger i = 0; i < _outervalues.size(); i++) SQSharedState::MarkObject(_outervalues[i], chain);
-	END_MARK()
+	for(SQUnsignedInteger i = 0; i < _outervalues.size(); i++) _sharedstate->MarkObject(_outervalues[i], chain);
 }
 
 void SQUserData::Mark(SQCollectable **chain){
-	START_MARK()
-		if(_delegate) _delegate->Mark(chain);
-	END_MARK()
+	if(_delegate) _sharedstate->MarkCollectable(_delegate,chain);
 }
 
 void SQCollectable::UnMark() { _uiRef&=~MARK_FLAG; }
@@ -73,10 +73,25 @@ struct SQWeakRef : SQRefCounted
 
 struct SQObjectPtr;
 
+#ifndef NO_GARBAGE_COLLECTOR
+/* Number of incremental garbage collections that are marking objects. While
+ * one is, every new reference to an object has to be reported to it. */
+struct SQCollectable;
+extern SQInteger _sq_gc_marking;
+void sq_gcbarrier(SQObjectType type,const SQObjectValue &unval);
+void sq_gcbarrier(SQCollectable *c);
+
+#define __AddRef(type,unval) if(ISREFCOUNTED(type))	\
+		{ \
+			unval.pRefCounted->_uiRef++; \
+			if(_sq_gc_marking != 0) sq_gcbarrier(type,unval); \
+		}
+#else
 #define __AddRef(type,unval) if(ISREFCOUNTED(type))	\
 		{ \
 			unval.pRefCounted->_uiRef++; \
 		}
+#endif
 
 #define __Release(type,unval) if(ISREFCOUNTED(type) && ((--unval.pRefCounted->_uiRef)<=0))	\
 		{	\
@@ -92,9 +107,16 @@ struct SQObjectPtr;
 	} \
 }
 
+#ifndef NO_GARBAGE_COLLECTOR
 #define __ObjAddRef(obj) { \
 	(obj)->_uiRef++; \
+	if(_sq_gc_marking != 0) sq_gcbarrier(obj); \
 }
+#else
+#define __ObjAddRef(obj) { \
+	(obj)->_uiRef++; \
+}
+#endif
 
 #define type(obj) ((obj)._type)
 #define is_delegable(t) (type(t)&SQOBJECT_DELEGABLE)
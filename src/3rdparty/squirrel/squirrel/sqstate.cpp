@@ -101,6 +101,10 @@ SQSharedState::SQSharedState()
 	_scratchpadsize=0;
 #ifndef NO_GARBAGE_COLLECTOR
 	_gc_chain=NULL;
+	_gc_marked=NULL;
+	_gc_marking=false;
+	_gc_work=0;
+	_gc_debt=0;
 #endif
 	sq_new(_stringtable,SQStringTable);
 	sq_new(_metamethods,SQObjectPtrVec);
@@ -162,6 +166,9 @@ SQSharedState::SQSharedState()
 
 SQSharedState::~SQSharedState()
 {
+#ifndef NO_GARBAGE_COLLECTOR
+	AbortGarbageCollection();
+#endif
 	_constructoridx = _null_;
 	_table(_registry)->Finalize();
 	_table(_consts)->Finalize();
@@ -228,46 +235,154 @@ SQInteger SQSharedState::GetMetaMethodIdxByName(const SQObjectPtr &name)
 
 #ifndef NO_GARBAGE_COLLECTOR
 
+SQInteger _sq_gc_marking = 0;
+
+void sq_gcbarrier(SQCollectable *c)
+{
+	SQSharedState *ss = c->_sharedstate;
+	if(!ss->_gc_marking || (c->_uiRef&MARK_FLAG)) return;
+	ss->MarkCollectable(c,&ss->_gc_marked);
+	ss->_gc_debt++;
+}
+
+void sq_gcbarrier(SQObjectType type,const SQObjectValue &unval)
+{
+	switch(type){
+	case OT_TABLE:sq_gcbarrier(unval.pTable);break;
+	case OT_ARRAY:sq_gcbarrier(unval.pArray);break;
+	case OT_USERDATA:sq_gcbarrier(unval.pUserData);break;
+	case OT_CLOSURE:sq_gcbarrier(unval.pClosure);break;
+	case OT_NATIVECLOSURE:sq_gcbarrier(unval.pNativeClosure);break;
+	case OT_GENERATOR:sq_gcbarrier(unval.pGenerator);break;
+	case OT_THREAD:sq_gcbarrier(unval.pThread);break;
+	case OT_CLASS:sq_gcbarrier(unval.pClass);break;
+	case OT_INSTANCE:sq_gcbarrier(unval.pInstance);break;
+	default: break; //shutup compiler
+	}
+}
+
+void SQSharedState::MarkCollectable(SQCollectable *c,SQCollectable **chain)
+{
+	if(c->_uiRef&MARK_FLAG) return;
+	c->_uiRef|=MARK_FLAG;
+	SQCollectable::RemoveFromChain(&_gc_chain,c);
+	SQCollectable::AddToChain(chain,c);
+	_gc_gray.push_back(c);
+}
+
 void SQSharedState::MarkObject(SQObjectPtr &o,SQCollectable **chain)
 {
+	_gc_work++;
 	switch(type(o)){
-	case OT_TABLE:_table(o)->Mark(chain);break;
-	case OT_ARRAY:_array(o)->Mark(chain);break;
-	case OT_USERDATA:_userdata(o)->Mark(chain);break;
-	case OT_CLOSURE:_closure(o)->Mark(chain);break;
-	case OT_NATIVECLOSURE:_nativeclosure(o)->Mark(chain);break;
-	case OT_GENERATOR:_generator(o)->Mark(chain);break;
-	case OT_THREAD:_thread(o)->Mark(chain);break;
-	case OT_CLASS:_class(o)->Mark(chain);break;
-	case OT_INSTANCE:_instance(o)->Mark(chain);break;
+	case OT_TABLE:MarkCollectable(_table(o),chain);break;
+	case OT_ARRAY:MarkCollectable(_array(o),chain);break;
+	case OT_USERDATA:MarkCollectable(_userdata(o),chain);break;
+	case OT_CLOSURE:MarkCollectable(_closure(o),chain);break;
+	case OT_NATIVECLOSURE:MarkCollectable(_nativeclosure(o),chain);break;
+	case OT_GENERATOR:MarkCollectable(_generator(o),chain);break;
+	case OT_THREAD:MarkCollectable(_thread(o),chain);break;
+	case OT_CLASS:MarkCollectable(_class(o),chain);break;
+	case OT_INSTANCE:MarkCollectable(_instance(o),chain);break;
 	default: break; //shutup compiler
 	}
 }
 
+void SQSharedState::MarkRoots()
+{
+	MarkObject(_root_vm,&_gc_marked);
+	_refs_table.Mark(this,&_gc_marked);
+	MarkObject(_registry,&_gc_marked);
+	MarkObject(_consts,&_gc_marked);
+	MarkObject(_metamethodsmap,&_gc_marked);
+	MarkObject(_table_default_delegate,&_gc_marked);
+	MarkObject(_array_default_delegate,&_gc_marked);
+	MarkObject(_string_default_delegate,&_gc_marked);
+	MarkObject(_number_default_delegate,&_gc_marked);
+	MarkObject(_generator_default_delegate,&_gc_marked);
+	MarkObject(_thread_default_delegate,&_gc_marked);
+	MarkObject(_closure_default_delegate,&_gc_marked);
+	MarkObject(_class_default_delegate,&_gc_marked);
+	MarkObject(_instance_default_delegate,&_gc_marked);
+	MarkObject(_weakref_default_delegate,&_gc_marked);
+}
+
+/*
+ * Stop a running collection without freeing anything, by unmarking all
+ * objects it marked.
+ */
+void SQSharedState::AbortGarbageCollection()
+{
+	if(!_gc_marking) return;
+	while(_gc_marked) {
+		SQCollectable *t = _gc_marked;
+		t->UnMark();
+		SQCollectable::RemoveFromChain(&_gc_marked,t);
+		SQCollectable::AddToChain(&_gc_chain,t);
+	}
+	_gc_gray.resize(0);
+	_gc_debt = 0;
+	_gc_marking = false;
+	_sq_gc_marking--;
+}
 
 SQInteger SQSharedState::CollectGarbage(SQVM *vm)
 {
-	SQInteger n=0;
-	SQCollectable *tchain=NULL;
-	SQVM *vms = _thread(_root_vm);
-
-	vms->Mark(&tchain);
-	SQInteger x = _table(_thread(_root_vm)->_roottable)->CountUsed();
-	_refs_table.Mark(&tchain);
-	MarkObject(_registry,&tchain);
-	MarkObject(_consts,&tchain);
-	MarkObject(_metamethodsmap,&tchain);
-	MarkObject(_table_default_delegate,&tchain);
-	MarkObject(_array_default_delegate,&tchain);
-	MarkObject(_string_default_delegate,&tchain);
-	MarkObject(_number_default_delegate,&tchain);
-	MarkObject(_generator_default_delegate,&tchain);
-	MarkObject(_thread_default_delegate,&tchain);
-	MarkObject(_closure_default_delegate,&tchain);
-	MarkObject(_class_default_delegate,&tchain);
-	MarkObject(_instance_default_delegate,&tchain);
-	MarkObject(_weakref_default_delegate,&tchain);
+	return CollectGarbageStep(vm,-1);
+}
+
+/*
+ * Do a step of an incremental collection, starting a new collection when
+ * none is running. Each step marks about 'work' references, and also scans
+ * as many objects as were marked by new references since the last step, so
+ * a script that creates many objects cannot keep the collection from
+ * finishing. A negative amount of work runs the whole collection at once.
+ *
+ * While the collection runs the script continues between steps, so every
+ * reference to an object that is added meanwhile marks that object too
+ * (see __AddRef). When no marked objects are left to scan, the roots are
+ * scanned again and everything that is still not marked is freed; that
+ * last step is not interrupted.
+ *
+ * Returns -1 while the collection is not finished, and the number of
+ * freed objects otherwise.
+ */
+SQInteger SQSharedState::CollectGarbageStep(SQVM *vm,SQInteger work)
+{
+	if(!_gc_marking) {
+		_gc_marking = true;
+		_sq_gc_marking++;
+		MarkRoots();
+	}
+
+	_gc_work = 0;
+	while(!_gc_gray.empty()) {
+		if(work >= 0 && _gc_work >= work && _gc_debt <= 0) return -1;
+		SQCollectable *c = _gc_gray.back();
+		_gc_gray.pop_back();
+		if(_gc_debt > 0) {
+			/* Catching up with the new references is not progress. */
+			SQInteger done = _gc_work;
+			c->Mark(&_gc_marked);
+			_gc_work = done;
+			_gc_debt--;
+		} else {
+			c->Mark(&_gc_marked);
+		}
+	}
 
+	/* The root VM is marked already, but its stack changed since it was scanned. */
+	_thread(_root_vm)->Mark(&_gc_marked);
+	MarkRoots();
+	while(!_gc_gray.empty()) {
+		SQCollectable *c = _gc_gray.back();
+		_gc_gray.pop_back();
+		c->Mark(&_gc_marked);
+	}
+	_gc_debt = 0;
+	_gc_marking = false;
+	_sq_gc_marking--;
+
+	SQInteger n=0;
 	SQCollectable *t = _gc_chain;
 	SQCollectable *nx = NULL;
 	if(t) {
@@ -283,14 +398,20 @@ SQInteger SQSharedState::CollectGarbage(SQVM *vm)
 		}
 	}
 
-	t = tchain;
+	/* Objects that lost all their references after they were marked are freed now. */
+	sqvector<SQCollectable *> unreferenced;
+	t = _gc_marked;
 	while(t) {
 		t->UnMark();
+		if(t->_uiRef == 0) unreferenced.push_back(t);
 		t = t->_next;
 	}
-	_gc_chain = tchain;
-	SQInteger z = _table(_thread(_root_vm)->_roottable)->CountUsed();
-	assert(z == x);
+	_gc_chain = _gc_marked;
+	_gc_marked = NULL;
+	for(SQUnsignedInteger i = 0; i < unreferenced.size(); i++) {
+		unreferenced[i]->Release();
+		n++;
+	}
 	return n;
 }
 #endif
@@ -353,12 +474,12 @@ RefTable::~RefTable()
 }
 
 #ifndef NO_GARBAGE_COLLECTOR
-void RefTable::Mark(SQCollectable **chain)
+void RefTable::Mark(SQSharedState *ss,SQCollectable **chain)
 {
 	RefNode *nodes = (RefNode *)_nodes;
 	for(SQUnsignedInteger n = 0; n < _numofslots; n++) {
 		if(type(nodes->obj) != OT_NULL) {
-			SQSharedState::MarkObject(nodes->obj,chain);
+			ss->MarkObject(nodes->obj,chain);
 		}
 		nodes++;
 	}
@@ -34,7 +34,7 @@ struct RefTable {
 	void AddRef(SQObject &obj);
 	SQBool Release(SQObject &obj);
 #ifndef NO_GARBAGE_COLLECTOR
-	void Mark(SQCollectable **chain);
+	void Mark(SQSharedState *ss,SQCollectable **chain);
 #endif
 	void Finalize();
 private:
@@ -63,7 +63,13 @@ public:
 	SQInteger GetMetaMethodIdxByName(const SQObjectPtr &name);
 #ifndef NO_GARBAGE_COLLECTOR
 	SQInteger CollectGarbage(SQVM *vm);
-	static void MarkObject(SQObjectPtr &o,SQCollectable **chain);
+	SQInteger CollectGarbageStep(SQVM *vm,SQInteger work);
+	void MarkObject(SQObjectPtr &o,SQCollectable **chain);
+	void MarkCollectable(SQCollectable *c,SQCollectable **chain);
+private:
+	void MarkRoots();
+	void AbortGarbageCollection();
+public:
 #endif
 	SQObjectPtrVec *_metamethods;
 	SQObjectPtr _metamethodsmap;
@@ -76,6 +82,11 @@ public:
 	SQObjectPtr _constructoridx;
 #ifndef NO_GARBAGE_COLLECTOR
 	SQCollectable *_gc_chain;
+	SQCollectable *_gc_marked; //objects marked by the running collection
+	sqvector<SQCollectable *> _gc_gray; //marked objects whose references are not marked yet
+	bool _gc_marking; //whether a collection is running
+	SQInteger _gc_work; //references marked by the running step of the collection
+	SQInteger _gc_debt; //objects marked by new references that still have to be scanned
 #endif
 	SQObjectPtr _root_vm;
 	SQObjectPtr _table_default_delegate;
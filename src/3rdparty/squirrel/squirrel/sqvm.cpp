@@ -18,6 +18,8 @@
 #include "sqclass.h"
 
 #include "../../../string_func.h"
+#include "../../../script/script_thread.hpp"
+#include "../../../script/script_profiler.hpp"
 
 #include "../../../safeguards.h"
 
@@ -115,6 +117,7 @@ SQVM::SQVM(SQSharedState *ss)
 	_can_suspend = false;
 	_in_stackoverflow = false;
 	_ops_till_suspend = 0;
+	_profiler = NULL;
 	_callsstack = NULL;
 	_callsstacksize = 0;
 	_alloccallsstacksize = 0;
@@ -468,12 +471,12 @@ bool SQVM::DerefInc(SQInteger op,SQObjectPtr &target, SQObjectPtr &self, SQObjec
 	return true;
 }
 
-#define arg0 (_i_._arg0)
-#define arg1 (_i_._arg1)
-#define sarg1 (*(const_cast<SQInt32 *>(&_i_._arg1)))
-#define arg2 (_i_._arg2)
-#define arg3 (_i_._arg3)
-#define sarg3 ((SQInteger)*((const signed char *)&_i_._arg3))
+#define arg0 (_i_->_arg0)
+#define arg1 (_i_->_arg1)
+#define sarg1 (*(const_cast<SQInt32 *>(&_i_->_arg1)))
+#define arg2 (_i_->_arg2)
+#define arg3 (_i_->_arg3)
+#define sarg3 ((SQInteger)*((const signed char *)&_i_->_arg3))
 
 SQRESULT SQVM::Suspend()
 {
@@ -573,6 +576,29 @@ bool SQVM::DELEGATE_OP(SQObjectPtr &trg,SQObjectPtr &o1,SQObjectPtr &o2)
 
 #define SQ_THROW() { goto exception_trap; }
 
+/* Dispatch the instructions with a jump table of label addresses where the
+ * compiler supports it, so every opcode jumps to the next one directly
+ * instead of via a shared switch. Define SQ_NO_COMPUTED_GOTO to disable. */
+#if defined(__GNUC__) && !defined(SQ_NO_COMPUTED_GOTO)
+#define SQ_COMPUTED_GOTO
+#endif
+
+/* Count the next instruction against the ops budget, suspend when it is exhausted, and fetch it. */
+#define FETCH_OP() { \
+	DecreaseOps(1); \
+	if (ShouldSuspend()) { _suspended = SQTrue; _suspended_traps = traps; return true; } \
+	if (_profiler != NULL) _profiler->CountOp(this); \
+	_i_ = ci->_ip++; \
+}
+
+#ifdef SQ_COMPUTED_GOTO
+#define OPCODE(op) case op: op##_label
+#define NEXT_OP() { FETCH_OP(); goto *_op_labels[_i_->op]; }
+#else
+#define OPCODE(op) case op
+#define NEXT_OP() continue
+#endif
+
 bool SQVM::CLOSURE_OP(SQObjectPtr &target, SQFunctionProto *func)
 {
 	SQInteger nouters;
@@ -696,11 +722,83 @@ bool SQVM::Execute(SQObjectPtr &closure, SQInteger target, SQInteger nargs, SQIn
 	if ((_nnativecalls + 1) > MAX_NATIVE_CALLS) { Raise_Error("Native stack overflow"); return false; }
 	_nnativecalls++;
 	AutoDec ad(&_nnativecalls);
+	/* Script code does not touch the game state, so other scripts may use it meanwhile. */
+	ScriptThread::GameStateUnlock unlock;
+	ScriptProfiler::Run run(_nnativecalls == 1 ? _profiler : NULL);
 	SQInteger traps = 0;
 	//temp_reg vars for OP_CALL
 	SQInteger ct_target;
 	SQInteger ct_stackbase;
 	bool ct_tailcall;
+	const SQInstruction *_i_;
+#ifdef SQ_COMPUTED_GOTO
+	/* Code of the opcodes, in the order of SQOpcode. */
+	static void *const _op_labels[] = {
+		&&_OP_LINE_label,
+		&&_OP_LOAD_label,
+		&&_OP_LOADINT_label,
+		&&_OP_LOADFLOAT_label,
+		&&_OP_DLOAD_label,
+		&&_OP_TAILCALL_label,
+		&&_OP_CALL_label,
+		&&_OP_PREPCALL_label,
+		&&_OP_PREPCALLK_label,
+		&&_OP_GETK_label,
+		&&_OP_MOVE_label,
+		&&_OP_NEWSLOT_label,
+		&&_OP_DELETE_label,
+		&&_OP_SET_label,
+		&&_OP_GET_label,
+		&&_OP_EQ_label,
+		&&_OP_NE_label,
+		&&_OP_ARITH_label,
+		&&_OP_BITW_label,
+		&&_OP_RETURN_label,
+		&&_OP_LOADNULLS_label,
+		&&_OP_LOADROOTTABLE_label,
+		&&_OP_LOADBOOL_label,
+		&&_OP_DMOVE_label,
+		&&_OP_JMP_label,
+		&&_OP_JNZ_label,
+		&&_OP_JZ_label,
+		&&_OP_LOADFREEVAR_label,
+		&&_OP_VARGC_label,
+		&&_OP_GETVARGV_label,
+		&&_OP_NEWTABLE_label,
+		&&_OP_NEWARRAY_label,
+		&&_OP_APPENDARRAY_label,
+		&&_OP_GETPARENT_label,
+		&&_OP_COMPARITH_label,
+		&&_OP_COMPARITHL_label,
+		&&_OP_INC_label,
+		&&_OP_INCL_label,
+		&&_OP_PINC_label,
+		&&_OP_PINCL_label,
+		&&_OP_CMP_label,
+		&&_OP_EXISTS_label,
+		&&_OP_INSTANCEOF_label,
+		&&_OP_AND_label,
+		&&_OP_OR_label,
+		&&_OP_NEG_label,
+		&&_OP_NOT_label,
+		&&_OP_BWNOT_label,
+		&&_OP_CLOSURE_label,
+		&&_OP_YIELD_label,
+		&&_OP_RESUME_label,
+		&&_OP_FOREACH_label,
+		&&_OP_POSTFOREACH_label,
+		&&_OP_DELEGATE_label,
+		&&_OP_CLONE_label,
+		&&_OP_TYPEOF_label,
+		&&_OP_PUSHTRAP_label,
+		&&_OP_POPTRAP_label,
+		&&_OP_THROW_label,
+		&&_OP_CLASS_label,
+		&&_OP_NEWSLOTA_label,
+		&&_OP_SCOPE_END_label,
+	};
+	assert_compile(lengthof(_op_labels) == _OP_SCOPE_END + 1);
+#endif
 
 	switch(et) {
 		case ET_CALL: {
@@ -743,23 +841,23 @@ exception_restore:
 	{
 		for(;;)
 		{
-			DecreaseOps(1);
-			if (ShouldSuspend()) { _suspended = SQTrue; _suspended_traps = traps; return true; }
-
-			const SQInstruction &_i_ = *ci->_ip++;
+			FETCH_OP();
 			//dumpstack(_stackbase);
-			//printf("%s %d %d %d %d\n",g_InstrDesc[_i_.op].name,arg0,arg1,arg2,arg3);
-			switch(_i_.op)
+			//printf("%s %d %d %d %d\n",g_InstrDesc[_i_->op].name,arg0,arg1,arg2,arg3);
+#ifdef SQ_COMPUTED_GOTO
+			goto *_op_labels[_i_->op];
+#endif
+			switch(_i_->op)
 			{
-			case _OP_LINE:
+			OPCODE(_OP_LINE):
 				if(type(_debughook) != OT_NULL && _rawval(_debughook) != _rawval(ci->_closure))
 					CallDebugHook('l',arg1);
-				continue;
-			case _OP_LOAD: TARGET = ci->_literals[arg1]; continue;
-			case _OP_LOADINT: TARGET = (SQInteger)arg1; continue;
-			case _OP_LOADFLOAT: TARGET = *((const SQFloat *)&arg1); continue;
-			case _OP_DLOAD: TARGET = ci->_literals[arg1]; STK(arg2) = ci->_literals[arg3];continue;
-			case _OP_TAILCALL:
+				NEXT_OP();
+			OPCODE(_OP_LOAD): TARGET = ci->_literals[arg1]; NEXT_OP();
+			OPCODE(_OP_LOADINT): TARGET = (SQInteger)arg1; NEXT_OP();
+			OPCODE(_OP_LOADFLOAT): TARGET = *((const SQFloat *)&arg1); NEXT_OP();
+			OPCODE(_OP_DLOAD): TARGET = ci->_literals[arg1]; STK(arg2) = ci->_literals[arg3];NEXT_OP();
+			OPCODE(_OP_TAILCALL):
 				temp_reg = STK(arg1);
 				if (type(temp_reg) == OT_CLOSURE && !_funcproto(_closure(temp_reg)->_function)->_bgenerator){
 					ct_tailcall = true;
@@ -770,7 +868,7 @@ exception_restore:
 					goto common_call;
 				}
 				FALLTHROUGH;
-			case _OP_CALL: {
+			OPCODE(_OP_CALL): {
 					ct_tailcall = false;
 					ct_target = arg0;
 					temp_reg = STK(arg1);
@@ -790,7 +888,7 @@ common_call:
 						}
 						CLEARSTACK(last_top);
 						}
-						continue;
+						NEXT_OP();
 					case OT_NATIVECLOSURE: {
 						bool suspend;
 						_suspended_target = ct_target;
@@ -817,7 +915,7 @@ common_call:
 							STK(ct_target) = clo;
 						}
 										   }
-						continue;
+						NEXT_OP();
 					case OT_CLASS:{
 						SQObjectPtr inst;
 						_GUARD(CreateClassInstance(_class(clo),inst,temp_reg));
@@ -847,18 +945,18 @@ common_call:
 						SQ_THROW();
 					}
 				}
-				  continue;
-			case _OP_PREPCALL:
-			case _OP_PREPCALLK:
+				  NEXT_OP();
+			OPCODE(_OP_PREPCALL):
+			OPCODE(_OP_PREPCALLK):
 				{
-					SQObjectPtr &key = _i_.op == _OP_PREPCALLK?(ci->_literals)[arg1]:STK(arg1);
+					SQObjectPtr &key = _i_->op == _OP_PREPCALLK?(ci->_literals)[arg1]:STK(arg1);
 					SQObjectPtr &o = STK(arg2);
 					if (!Get(o, key, temp_reg,false,true)) {
 						if(type(o) == OT_CLASS) { //hack?
 							if(_class_ddel->Get(key,temp_reg)) {
 								STK(arg3) = o;
 								TARGET = temp_reg;
-								continue;
+								NEXT_OP();
 							}
 						}
 						{ Raise_IdxError(key); SQ_THROW();}
@@ -867,8 +965,8 @@ common_call:
 					STK(arg3) = type(o) == OT_CLASS?STK(0):o;
 					TARGET = temp_reg;
 				}
-				continue;
-			case _OP_SCOPE_END:
+				NEXT_OP();
+			OPCODE(_OP_SCOPE_END):
 			{
 				SQInteger from = arg0;
 				SQInteger count = arg1 - arg0 + 2;
@@ -878,38 +976,65 @@ common_call:
 				if (_stackbase + count + from <= _top) {
 					while (--count >= 0) _stack._vals[_stackbase + count + from].Null();
 				}
-			} continue;
-			case _OP_GETK:
+			} NEXT_OP();
+			OPCODE(_OP_GETK):
+				/* Fast path for the slots of tables; everything else, including delegation, is handled by Get. */
+				if (type(STK(arg2)) == OT_TABLE && _table(STK(arg2))->Get(ci->_literals[arg1], temp_reg)) {
+					TARGET = temp_reg;
+					NEXT_OP();
+				}
 				if (!Get(STK(arg2), ci->_literals[arg1], temp_reg, false,true)) { Raise_IdxError(ci->_literals[arg1]); SQ_THROW();}
 				TARGET = temp_reg;
-				continue;
-			case _OP_MOVE: TARGET = STK(arg1); continue;
-			case _OP_NEWSLOT:
+				NEXT_OP();
+			OPCODE(_OP_MOVE): TARGET = STK(arg1); NEXT_OP();
+			OPCODE(_OP_NEWSLOT):
 				_GUARD(NewSlot(STK(arg1), STK(arg2), STK(arg3),false));
 				if(arg0 != arg3) TARGET = STK(arg3);
-				continue;
-			case _OP_DELETE: _GUARD(DeleteSlot(STK(arg1), STK(arg2), TARGET)); continue;
-			case _OP_SET:
+				NEXT_OP();
+			OPCODE(_OP_DELETE): _GUARD(DeleteSlot(STK(arg1), STK(arg2), TARGET)); NEXT_OP();
+			OPCODE(_OP_SET):
+				/* Fast path for existing slots of tables and integer indices of arrays. */
+				if ((type(STK(arg1)) == OT_TABLE && _table(STK(arg1))->Set(STK(arg2), STK(arg3))) ||
+						(type(STK(arg1)) == OT_ARRAY && type(STK(arg2)) == OT_INTEGER && _array(STK(arg1))->Set(_integer(STK(arg2)), STK(arg3)))) {
+					if (arg0 != arg3) TARGET = STK(arg3);
+					NEXT_OP();
+				}
 				if (!Set(STK(arg1), STK(arg2), STK(arg3),true)) { Raise_IdxError(STK(arg2)); SQ_THROW(); }
 				if (arg0 != arg3) TARGET = STK(arg3);
-				continue;
-			case _OP_GET:
+				NEXT_OP();
+			OPCODE(_OP_GET):
+				/* Fast path for the slots of tables and integer indices of arrays. */
+				if ((type(STK(arg1)) == OT_TABLE && _table(STK(arg1))->Get(STK(arg2), temp_reg)) ||
+						(type(STK(arg1)) == OT_ARRAY && type(STK(arg2)) == OT_INTEGER && _array(STK(arg1))->Get(_integer(STK(arg2)), temp_reg))) {
+					TARGET = temp_reg;
+					NEXT_OP();
+				}
 				if (!Get(STK(arg1), STK(arg2), temp_reg, false,true)) { Raise_IdxError(STK(arg2)); SQ_THROW(); }
 				TARGET = temp_reg;
-				continue;
-			case _OP_EQ:{
+				NEXT_OP();
+			OPCODE(_OP_EQ):{
 				bool res;
 				if(!IsEqual(STK(arg2),COND_LITERAL,res)) { SQ_THROW(); }
 				TARGET = res?_true_:_false_;
-				}continue;
-			case _OP_NE:{
+				}NEXT_OP();
+			OPCODE(_OP_NE):{
 				bool res;
 				if(!IsEqual(STK(arg2),COND_LITERAL,res)) { SQ_THROW(); }
 				TARGET = (!res)?_true_:_false_;
-				} continue;
-			case _OP_ARITH: _GUARD(ARITH_OP( arg3 , temp_reg, STK(arg2), STK(arg1))); TARGET = temp_reg; continue;
-			case _OP_BITW:	_GUARD(BW_OP( arg3,TARGET,STK(arg2),STK(arg1))); continue;
-			case _OP_RETURN:
+				} NEXT_OP();
+			OPCODE(_OP_ARITH):
+				/* Fast path for integer arithmetic that cannot fail. */
+				if (type(STK(arg2)) == OT_INTEGER && type(STK(arg1)) == OT_INTEGER) {
+					SQInteger i1 = _integer(STK(arg2)), i2 = _integer(STK(arg1));
+					switch (arg3) {
+						case '+': TARGET = i1 + i2; NEXT_OP();
+						case '-': TARGET = i1 - i2; NEXT_OP();
+						case '*': TARGET = i1 * i2; NEXT_OP();
+					}
+				}
+				_GUARD(ARITH_OP( arg3 , temp_reg, STK(arg2), STK(arg1))); TARGET = temp_reg; NEXT_OP();
+			OPCODE(_OP_BITW):	_GUARD(BW_OP( arg3,TARGET,STK(arg2),STK(arg1))); NEXT_OP();
+			OPCODE(_OP_RETURN):
 				if(ci->_generator) {
 					ci->_generator->Kill();
 				}
@@ -918,65 +1043,92 @@ common_call:
 					outres = temp_reg;
 					return true;
 				}
-				continue;
-			case _OP_LOADNULLS:{ for(SQInt32 n=0; n < arg1; n++) STK(arg0+n) = _null_; }continue;
-			case _OP_LOADROOTTABLE:	TARGET = _roottable; continue;
-			case _OP_LOADBOOL: TARGET = arg1?_true_:_false_; continue;
-			case _OP_DMOVE: STK(arg0) = STK(arg1); STK(arg2) = STK(arg3); continue;
-			case _OP_JMP: ci->_ip += (sarg1); continue;
-			case _OP_JNZ: if(!IsFalse(STK(arg0))) ci->_ip+=(sarg1); continue;
-			case _OP_JZ: if(IsFalse(STK(arg0))) ci->_ip+=(sarg1); continue;
-			case _OP_LOADFREEVAR: TARGET = _closure(ci->_closure)->_outervalues[arg1]; continue;
-			case _OP_VARGC: TARGET = SQInteger(ci->_vargs.size); continue;
-			case _OP_GETVARGV:
+				NEXT_OP();
+			OPCODE(_OP_LOADNULLS):{ for(SQInt32 n=0; n < arg1; n++) STK(arg0+n) = _null_; }NEXT_OP();
+			OPCODE(_OP_LOADROOTTABLE):	TARGET = _roottable; NEXT_OP();
+			OPCODE(_OP_LOADBOOL): TARGET = arg1?_true_:_false_; NEXT_OP();
+			OPCODE(_OP_DMOVE): STK(arg0) = STK(arg1); STK(arg2) = STK(arg3); NEXT_OP();
+			OPCODE(_OP_JMP): ci->_ip += (sarg1); NEXT_OP();
+			OPCODE(_OP_JNZ): if(!IsFalse(STK(arg0))) ci->_ip+=(sarg1); NEXT_OP();
+			OPCODE(_OP_JZ): if(IsFalse(STK(arg0))) ci->_ip+=(sarg1); NEXT_OP();
+			OPCODE(_OP_LOADFREEVAR): TARGET = _closure(ci->_closure)->_outervalues[arg1]; NEXT_OP();
+			OPCODE(_OP_VARGC): TARGET = SQInteger(ci->_vargs.size); NEXT_OP();
+			OPCODE(_OP_GETVARGV):
 				if(!GETVARGV_OP(TARGET,STK(arg1),ci)) { SQ_THROW(); }
-				continue;
-			case _OP_NEWTABLE: TARGET = SQTable::Create(_ss(this), arg1); continue;
-			case _OP_NEWARRAY: TARGET = SQArray::Create(_ss(this), 0); _array(TARGET)->Reserve(arg1); continue;
-			case _OP_APPENDARRAY: _array(STK(arg0))->Append(COND_LITERAL);	continue;
-			case _OP_GETPARENT: _GUARD(GETPARENT_OP(STK(arg1),TARGET)); continue;
-			case _OP_COMPARITH: _GUARD(DerefInc(arg3, TARGET, STK((((SQUnsignedInteger)arg1&0xFFFF0000)>>16)), STK(arg2), STK(arg1&0x0000FFFF), false)); continue;
-			case _OP_COMPARITHL: _GUARD(LOCAL_INC(arg3, TARGET, STK(arg1), STK(arg2))); continue;
-			case _OP_INC: {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, false));} continue;
-			case _OP_INCL: {SQObjectPtr o(sarg3); _GUARD(LOCAL_INC('+',TARGET, STK(arg1), o));} continue;
-			case _OP_PINC: {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, true));} continue;
-			case _OP_PINCL:	{SQObjectPtr o(sarg3); _GUARD(PLOCAL_INC('+',TARGET, STK(arg1), o));} continue;
-			case _OP_CMP:	_GUARD(CMP_OP((CmpOP)arg3,STK(arg2),STK(arg1),TARGET))	continue;
-			case _OP_EXISTS: TARGET = Get(STK(arg1), STK(arg2), temp_reg, true,false)?_true_:_false_;continue;
-			case _OP_INSTANCEOF:
+				NEXT_OP();
+			OPCODE(_OP_NEWTABLE): TARGET = SQTable::Create(_ss(this), arg1); NEXT_OP();
+			OPCODE(_OP_NEWARRAY): TARGET = SQArray::Create(_ss(this), 0); _array(TARGET)->Reserve(arg1); NEXT_OP();
+			OPCODE(_OP_APPENDARRAY): _array(STK(arg0))->Append(COND_LITERAL);	NEXT_OP();
+			OPCODE(_OP_GETPARENT): _GUARD(GETPARENT_OP(STK(arg1),TARGET)); NEXT_OP();
+			OPCODE(_OP_COMPARITH): _GUARD(DerefInc(arg3, TARGET, STK((((SQUnsignedInteger)arg1&0xFFFF0000)>>16)), STK(arg2), STK(arg1&0x0000FFFF), false)); NEXT_OP();
+			OPCODE(_OP_COMPARITHL): _GUARD(LOCAL_INC(arg3, TARGET, STK(arg1), STK(arg2))); NEXT_OP();
+			OPCODE(_OP_INC): {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, false));} NEXT_OP();
+			OPCODE(_OP_INCL):
+				if (type(STK(arg1)) == OT_INTEGER) {
+					STK(arg1) = _integer(STK(arg1)) + sarg3;
+					TARGET = STK(arg1);
+					NEXT_OP();
+				}
+				{SQObjectPtr o(sarg3); _GUARD(LOCAL_INC('+',TARGET, STK(arg1), o));} NEXT_OP();
+			OPCODE(_OP_PINC): {SQObjectPtr o(sarg3); _GUARD(DerefInc('+',TARGET, STK(arg1), STK(arg2), o, true));} NEXT_OP();
+			OPCODE(_OP_PINCL):
+				if (type(STK(arg1)) == OT_INTEGER) {
+					SQInteger i = _integer(STK(arg1));
+					TARGET = i;
+					STK(arg1) = i + sarg3;
+					NEXT_OP();
+				}
+				{SQObjectPtr o(sarg3); _GUARD(PLOCAL_INC('+',TARGET, STK(arg1), o));} NEXT_OP();
+			OPCODE(_OP_CMP):
+				if (type(STK(arg2)) == OT_INTEGER && type(STK(arg1)) == OT_INTEGER) {
+					SQInteger i1 = _integer(STK(arg2)), i2 = _integer(STK(arg1));
+					bool res;
+					switch ((CmpOP)arg3) {
+						case CMP_G:  res = i1 >  i2; break;
+						case CMP_GE: res = i1 >= i2; break;
+						case CMP_L:  res = i1 <  i2; break;
+						case CMP_LE: res = i1 <= i2; break;
+						default: NOT_REACHED();
+					}
+					TARGET = res ? _true_ : _false_;
+					NEXT_OP();
+				}
+				_GUARD(CMP_OP((CmpOP)arg3,STK(arg2),STK(arg1),TARGET))	NEXT_OP();
+			OPCODE(_OP_EXISTS): TARGET = Get(STK(arg1), STK(arg2), temp_reg, true,false)?_true_:_false_;NEXT_OP();
+			OPCODE(_OP_INSTANCEOF):
 				if(type(STK(arg1)) != OT_CLASS || type(STK(arg2)) != OT_INSTANCE)
 				{Raise_Error("cannot apply instanceof between a %s and a %s",GetTypeName(STK(arg1)),GetTypeName(STK(arg2))); SQ_THROW();}
 				TARGET = _instance(STK(arg2))->InstanceOf(_class(STK(arg1)))?_true_:_false_;
-				continue;
-			case _OP_AND:
+				NEXT_OP();
+			OPCODE(_OP_AND):
 				if(IsFalse(STK(arg2))) {
 					TARGET = STK(arg2);
 					ci->_ip += (sarg1);
 				}
-				continue;
-			case _OP_OR:
+				NEXT_OP();
+			OPCODE(_OP_OR):
 				if(!IsFalse(STK(arg2))) {
 					TARGET = STK(arg2);
 					ci->_ip += (sarg1);
 				}
-				continue;
-			case _OP_NEG: _GUARD(NEG_OP(TARGET,STK(arg1))); continue;
-			case _OP_NOT: TARGET = (IsFalse(STK(arg1))?_true_:_false_); continue;
-			case _OP_BWNOT:
+				NEXT_OP();
+			OPCODE(_OP_NEG): _GUARD(NEG_OP(TARGET,STK(arg1))); NEXT_OP();
+			OPCODE(_OP_NOT): TARGET = (IsFalse(STK(arg1))?_true_:_false_); NEXT_OP();
+			OPCODE(_OP_BWNOT):
 				if(type(STK(arg1)) == OT_INTEGER) {
 					SQInteger t = _integer(STK(arg1));
 					TARGET = SQInteger(~t);
-					continue;
+					NEXT_OP();
 				}
 				Raise_Error("attempt to perform a bitwise op on a %s", GetTypeName(STK(arg1)));
 				SQ_THROW();
-			case _OP_CLOSURE: {
+			OPCODE(_OP_CLOSURE): {
 				SQClosure *c = ci->_closure._unVal.pClosure;
 				SQFunctionProto *fp = c->_function._unVal.pFunctionProto;
 				if(!CLOSURE_OP(TARGET,fp->_functions[arg1]._unVal.pFunctionProto)) { SQ_THROW(); }
-				continue;
+				NEXT_OP();
 			}
-			case _OP_YIELD:{
+			OPCODE(_OP_YIELD):{
 				if(ci->_generator) {
 					if(sarg1 != MAX_FUNC_STACKSIZE) temp_reg = STK(arg1);
 					_GUARD(ci->_generator->Yield(this));
@@ -991,43 +1143,43 @@ common_call:
 				}
 
 				}
-				continue;
-			case _OP_RESUME:
+				NEXT_OP();
+			OPCODE(_OP_RESUME):
 				if(type(STK(arg1)) != OT_GENERATOR){ Raise_Error("trying to resume a '%s',only genenerator can be resumed", GetTypeName(STK(arg1))); SQ_THROW();}
 				_GUARD(_generator(STK(arg1))->Resume(this, arg0));
 				traps += ci->_etraps;
-                continue;
-			case _OP_FOREACH:{ int tojump;
+                NEXT_OP();
+			OPCODE(_OP_FOREACH):{ int tojump;
 				_GUARD(FOREACH_OP(STK(arg0),STK(arg2),STK(arg2+1),STK(arg2+2),arg2,sarg1,tojump));
 				ci->_ip += tojump; }
-				continue;
-			case _OP_POSTFOREACH:
+				NEXT_OP();
+			OPCODE(_OP_POSTFOREACH):
 				assert(type(STK(arg0)) == OT_GENERATOR);
 				if(_generator(STK(arg0))->_state == SQGenerator::eDead)
 					ci->_ip += (sarg1 - 1);
-				continue;
-			case _OP_DELEGATE: _GUARD(DELEGATE_OP(TARGET,STK(arg1),STK(arg2))); continue;
-			case _OP_CLONE:
+				NEXT_OP();
+			OPCODE(_OP_DELEGATE): _GUARD(DELEGATE_OP(TARGET,STK(arg1),STK(arg2))); NEXT_OP();
+			OPCODE(_OP_CLONE):
 				if(!Clone(STK(arg1), TARGET))
 				{ Raise_Error("cloning a %s", GetTypeName(STK(arg1))); SQ_THROW();}
-				continue;
-			case _OP_TYPEOF: TypeOf(STK(arg1), TARGET); continue;
-			case _OP_PUSHTRAP:{
+				NEXT_OP();
+			OPCODE(_OP_TYPEOF): TypeOf(STK(arg1), TARGET); NEXT_OP();
+			OPCODE(_OP_PUSHTRAP):{
 				SQInstruction *_iv = _funcproto(_closure(ci->_closure)->_function)->_instructions;
 				_etraps.push_back(SQExceptionTrap(_top,_stackbase, &_iv[(ci->_ip-_iv)+arg1], arg0)); traps++;
 				ci->_etraps++;
 							  }
-				continue;
-			case _OP_POPTRAP: {
+				NEXT_OP();
+			OPCODE(_OP_POPTRAP): {
 				for(SQInteger i = 0; i < arg0; i++) {
 					_etraps.pop_back(); traps--;
 					ci->_etraps--;
 				}
 							  }
-				continue;
-			case _OP_THROW:	Raise_Error(TARGET); SQ_THROW();
-			case _OP_CLASS: _GUARD(CLASS_OP(TARGET,arg1,arg2)); continue;
-			case _OP_NEWSLOTA:
+				NEXT_OP();
+			OPCODE(_OP_THROW):	Raise_Error(TARGET); SQ_THROW();
+			OPCODE(_OP_CLASS): _GUARD(CLASS_OP(TARGET,arg1,arg2)); NEXT_OP();
+			OPCODE(_OP_NEWSLOTA):
 				bool bstatic = (arg0&NEW_SLOT_STATIC_FLAG)?true:false;
 				if(type(STK(arg1)) == OT_CLASS) {
 					if(type(_class(STK(arg1))->_metamethods[MT_NEWMEMBER]) != OT_NULL ) {
@@ -1037,7 +1189,7 @@ common_call:
 						int nparams = 5;
 						if(Call(_class(STK(arg1))->_metamethods[MT_NEWMEMBER], nparams, _top - nparams, temp_reg,SQFalse,SQFalse)) {
 							Pop(nparams);
-							continue;
+							NEXT_OP();
 						}
 					}
 				}
@@ -1045,7 +1197,7 @@ common_call:
 				if((arg0&NEW_SLOT_ATTRIBUTES_FLAG)) {
 					_class(STK(arg1))->SetAttributes(STK(arg2),STK(arg2-1));
 				}
-				continue;
+				NEXT_OP();
 			}
 
 		}
@@ -1178,12 +1330,17 @@ bool SQVM::CallNative(SQNativeClosure *nclosure,SQInteger nargs,SQInteger stackb
 	}
 
 
+	/* Let the profiler attribute the time till the next operation to the native function. */
+	if (_profiler != NULL) _profiler->Sync(this);
+
 	/* Store the call stack size, so we can restore that */
 	SQInteger cstksize = _callsstacksize;
 	SQInteger ret;
 	try {
 		SQBool can_suspend = this->_can_suspend;
 		this->_can_suspend = false;
+		/* Native functions may access the game state. */
+		ScriptThread::GameStateLock lock;
 		ret = (nclosure->_function)(this);
 		this->_can_suspend = can_suspend;
 	} catch (...) {
@@ -28,6 +28,8 @@ struct SQExceptionTrap{
 
 typedef sqvector<SQExceptionTrap> ExceptionsTraps;
 
+class ScriptProfiler;
+
 struct SQVM : public CHAINABLE_OBJ
 {
 	struct VarArgs {
@@ -171,6 +173,7 @@ public:
 	SQBool _can_suspend;
 	SQInteger _ops_till_suspend;
 	SQBool _in_stackoverflow;
+	ScriptProfiler *_profiler;
 
 	bool ShouldSuspend()
 	{
@@ -21,6 +21,7 @@
 #include "ai_config.hpp"
 #include "ai_info.hpp"
 #include "ai.hpp"
+#include "../script/script_thread.hpp"
 
 #include "../safeguards.h"
 
@@ -77,14 +78,28 @@
 
 	Backup<CompanyByte> cur_company(_current_company, FILE_LINE);
 	const Company *c;
-	FOR_ALL_COMPANIES(c) {
-		if (c->is_ai) {
-			cur_company.Change(c->index);
-			c->ai_instance->GameLoop();
+	if (_settings_client.gui.threaded_ai) {
+		/* Run the AIs concurrently; their commands are still executed in the order of the companies. */
+		std::vector<ScriptThread> scripts;
+		FOR_ALL_COMPANIES(c) {
+			if (c->is_ai) scripts.push_back(ScriptThread(c->ai_instance, c->index));
+		}
+		ScriptThread::RunGameLoops(scripts);
+	} else {
+		FOR_ALL_COMPANIES(c) {
+			if (c->is_ai) {
+				cur_company.Change(c->index);
+				c->ai_instance->GameLoop();
+			}
 		}
 	}
 	cur_company.Restore();
 
+	/* Continue the garbage collections that are in progress. */
+	FOR_ALL_COMPANIES(c) {
+		if (c->is_ai) c->ai_instance->ContinueGarbageCollection();
+	}
+
 	/* Occasionally collect garbage; every 255 ticks do one company.
 	 * Effectively collecting garbage once every two months per AI. */
 	if ((AI::frame_counter & 255) == 0) {
@@ -174,6 +189,7 @@
 /* static */ void AI::Uninitialize(bool keepConfig)
 {
 	AI::KillAll();
+	ScriptThread::StopWorkers();
 
 	if (keepConfig) {
 		/* Run a rescan, which indexes all AIInfos again, and check if we can
@@ -15,24 +15,79 @@
 #include "tile_cmd.h"
 #include "viewport_func.h"
 #include "framerate_type.h"
+#include <unordered_map>
 
 #include "safeguards.h"
 
-/** The table/list with animated tiles. */
+/**
+ * The table/list with animated tiles. Deleted tiles are replaced by INVALID_TILE
+ * to keep the positions of the other tiles stable; the list is compacted once
+ * enough of those gaps have accumulated.
+ */
 SmallVector<TileIndex, 256> _animated_tiles;
 
+/** Position of each animated tile in #_animated_tiles. */
+static std::unordered_map<TileIndex, uint> _animated_tile_index;
+
+static uint _animated_tiles_deleted = 0;   ///< Number of deleted entries in #_animated_tiles.
+static bool _animating_tiles        = false; ///< Whether AnimateAnimatedTiles is iterating over #_animated_tiles.
+
+/**
+ * Remove the deleted entries from the animated tile table, keeping the order
+ * of the remaining tiles the same.
+ */
+void CompactAnimatedTiles()
+{
+	assert(!_animating_tiles);
+	if (_animated_tiles_deleted == 0) return;
+
+	uint count = 0;
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		TileIndex tile = _animated_tiles[i];
+		if (tile == INVALID_TILE) continue;
+		if (count != i) {
+			_animated_tiles[count] = tile;
+			_animated_tile_index[tile] = count;
+		}
+		count++;
+	}
+	_animated_tiles.Resize(count);
+	_animated_tiles_deleted = 0;
+}
+
+/**
+ * Rebuild the index of the animated tile table after it has been loaded.
+ * Duplicate tiles are removed from the table.
+ */
+void RebuildAnimatedTileIndex()
+{
+	_animated_tile_index.clear();
+	_animated_tiles_deleted = 0;
+
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		TileIndex tile = _animated_tiles[i];
+		if (!_animated_tile_index.insert(std::make_pair(tile, i)).second) {
+			_animated_tiles[i] = INVALID_TILE;
+			_animated_tiles_deleted++;
+		}
+	}
+	CompactAnimatedTiles();
+}
+
 /**
  * Removes the given tile from the animated tile table.
  * @param tile the tile to remove
  */
 void DeleteAnimatedTile(TileIndex tile)
 {
-	TileIndex *to_remove = _animated_tiles.Find(tile);
-	if (to_remove != _animated_tiles.End()) {
-		/* The order of the remaining elements must stay the same, otherwise the animation loop may miss a tile. */
-		_animated_tiles.ErasePreservingOrder(to_remove);
-		MarkTileDirtyByTile(tile);
-	}
+	std::unordered_map<TileIndex, uint>::iterator it = _animated_tile_index.find(tile);
+	if (it == _animated_tile_index.end()) return;
+
+	/* The order of the remaining elements must stay the same, otherwise the animation loop may miss a tile. */
+	_animated_tiles[it->second] = INVALID_TILE;
+	_animated_tile_index.erase(it);
+	_animated_tiles_deleted++;
+	MarkTileDirtyByTile(tile);
 }
 
 /**
@@ -43,7 +98,13 @@ void DeleteAnimatedTile(TileIndex tile)
 void AddAnimatedTile(TileIndex tile)
 {
 	MarkTileDirtyByTile(tile);
-	_animated_tiles.Include(tile);
+	if (_animated_tile_index.count(tile) != 0) return;
+
+	/* Reclaim the space of deleted tiles before the table grows too much. */
+	if (!_animating_tiles && _animated_tiles_deleted > _animated_tiles.Length() / 2) CompactAnimatedTiles();
+
+	_animated_tile_index[tile] = _animated_tiles.Length();
+	*_animated_tiles.Append() = tile;
 }
 
 /**
@@ -53,21 +114,18 @@ void AnimateAnimatedTiles()
 {
 	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
 
-	const TileIndex *ti = _animated_tiles.Begin();
-	while (ti < _animated_tiles.End()) {
-		const TileIndex curr = *ti;
-		AnimateTile(curr);
-		/* During the AnimateTile call, DeleteAnimatedTile could have been called,
-		 * deleting an element we've already processed and pushing the rest one
-		 * slot to the left. We can detect this by checking whether the index
-		 * in the current slot has changed - if it has, an element has been deleted,
-		 * and we should process the current slot again instead of going forward.
-		 * NOTE: this will still break if more than one animated tile is being
-		 *       deleted during the same AnimateTile call, but no code seems to
-		 *       be doing this anyway.
-		 */
-		if (*ti == curr) ++ti;
+	/* Deleting tiles during the AnimateTile call only leaves a gap in the table,
+	 * and added tiles are appended to it, so iterating by position visits every
+	 * tile exactly once, in the same order as before. The table may be
+	 * reallocated by additions, so do not keep pointers into it. */
+	_animating_tiles = true;
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		const TileIndex curr = _animated_tiles[i];
+		if (curr != INVALID_TILE) AnimateTile(curr);
 	}
+	_animating_tiles = false;
+
+	if (_animated_tiles_deleted > _animated_tiles.Length() / 4) CompactAnimatedTiles();
 }
 
 /**
@@ -76,4 +134,6 @@ void AnimateAnimatedTiles()
 void InitializeAnimatedTiles()
 {
 	_animated_tiles.Clear();
+	_animated_tile_index.clear();
+	_animated_tiles_deleted = 0;
 }
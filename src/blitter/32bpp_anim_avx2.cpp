@@ -0,0 +1,135 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_anim_avx2.cpp Implementation of the AVX2 parts of the 32 bpp blitter with animation support. */
+
+#ifdef WITH_AVX2
+
+#include "../stdafx.h"
+#include "../video/video_driver.hpp"
+#include "../core/mem_func.hpp"
+#include "../table/sprites.h"
+#include "32bpp_avx2.hpp"
+#include "32bpp_anim_avx2.hpp"
+
+#include <immintrin.h>
+
+#include "../safeguards.h"
+
+/**
+ * Update the animated pixels of a part of a line, one pixel at a time.
+ * @param dst   The pixels on the screen.
+ * @param anim  The pixels in the animation buffer.
+ * @param count The number of pixels.
+ * @return Whether any pixel was updated.
+ */
+inline bool Blitter_32bppAVX2_Anim::PaletteAnimatePixels(Colour *dst, const uint16 *anim, int count)
+{
+	bool updated = false;
+	for (int i = 0; i < count; i++) {
+		uint8 colour = GB(anim[i], 0, 8);
+		if (colour >= PALETTE_ANIM_START) {
+			dst[i] = AdjustBrightness(LookupColourInPalette(colour), GB(anim[i], 8, 8));
+			updated = true;
+		}
+	}
+	return updated;
+}
+
+void Blitter_32bppAVX2_Anim::PaletteAnimate(const Palette &palette)
+{
+	assert(!_screen_disable_anim);
+
+	this->palette = palette;
+	/* If first_dirty is 0, it is for 8bpp indication to send the new
+	 *  palette. However, only the animation colours might possibly change.
+	 *  Especially when going between toyland and non-toyland. */
+	assert(this->palette.first_dirty == PALETTE_ANIM_START || this->palette.first_dirty == 0);
+
+	const uint16 *anim = this->anim_buf;
+	Colour *dst = (Colour *)_screen.dst_ptr;
+
+	bool screen_dirty = false;
+
+	/* Let's walk the anim buffer and try to find the pixels */
+	const int width = this->anim_buf_width;
+	const int screen_pitch = _screen.pitch;
+	const int anim_pitch = this->anim_buf_pitch;
+	const int *palette_data = (const int *)this->palette.palette;
+	const __m256i anim_cmp = _mm256_set1_epi32(PALETTE_ANIM_START - 1);
+	const __m256i brightness_cmp = _mm256_set1_epi32(Blitter_32bppBase::DEFAULT_BRIGHTNESS);
+	const __m256i colour_mask = _mm256_set1_epi32(0xFF);
+	for (int y = this->anim_buf_height; y != 0 ; y--) {
+		int x = 0;
+		for (; x + 8 <= width; x += 8) {
+			/* One pixel per 32 bits lane; colour in the low byte, brightness in the byte above. */
+			__m256i data = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(anim + x)));
+			__m256i colour_data = _mm256_and_si256(data, colour_mask);
+
+			/* fast path, no animation */
+			__m256i animated = _mm256_cmpgt_epi32(colour_data, anim_cmp);
+			if (_mm256_testz_si256(animated, animated)) continue;
+
+			__m256i default_brightness = _mm256_cmpeq_epi32(_mm256_srli_epi32(data, 8), brightness_cmp);
+			if (_mm256_testc_si256(default_brightness, animated)) {
+				/* All animated pixels are of the expected brightness; look them up at once and only store those. */
+				__m256i colours = _mm256_i32gather_epi32(palette_data, colour_data, sizeof(Colour));
+				_mm256_maskstore_epi32((int *)(dst + x), animated, colours);
+			} else {
+				/* slow path: unexpected brightnesses */
+				this->PaletteAnimatePixels(dst + x, anim + x, 8);
+			}
+			screen_dirty = true;
+		}
+
+		/* The pixels at the end of the line that do not fill a whole block. */
+		if (x < width && this->PaletteAnimatePixels(dst + x, anim + x, width - x)) screen_dirty = true;
+
+		dst += screen_pitch;
+		anim += anim_pitch;
+	}
+
+	if (screen_dirty) {
+		/* Make sure the backend redraws the whole screen */
+		VideoDriver::GetInstance()->MakeDirty(0, 0, _screen.width, _screen.height);
+	}
+}
+
+void Blitter_32bppAVX2_Anim::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+{
+	if (pal != PALETTE_TO_TRANSPARENT && pal != PALETTE_NEWSPAPER) {
+		/* A colour table we do not handle here, so let our parent handle it. */
+		Blitter_32bppSSE4_Anim::DrawColourMappingRect(dst, width, height, pal);
+		return;
+	}
+
+	Colour *udst = (Colour *)dst;
+	if (_screen_disable_anim) {
+		/* Not drawing to the screen, so there is no animation buffer to update. */
+		do {
+			DrawColourMappingLineAVX2(udst, width, pal);
+			udst += _screen.pitch;
+		} while (--height);
+		return;
+	}
+
+	uint16 *anim = this->anim_buf + this->ScreenToAnimOffset((uint32 *)dst);
+
+	do {
+		DrawColourMappingLineAVX2(udst, width, pal);
+
+		/* The pixels are not animated anymore. */
+		MemSetT(anim, 0, width);
+
+		udst += _screen.pitch;
+		anim += this->anim_buf_pitch;
+	} while (--height);
+}
+
+#endif /* WITH_AVX2 */
@@ -0,0 +1,80 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_avx2.cpp Implementation of the AVX2 parts of the 32 bpp blitter. */
+
+#ifdef WITH_AVX2
+
+#include "../stdafx.h"
+#include "../table/sprites.h"
+#include "32bpp_avx2.hpp"
+
+#include <immintrin.h>
+
+#include "../safeguards.h"
+
+/**
+ * Apply a colour mapping to a part of a line of the screen, eight pixels at a time.
+ * @param dst   The pixels on the screen.
+ * @param width The number of pixels.
+ * @param pal   The colour mapping; either #PALETTE_TO_TRANSPARENT or #PALETTE_NEWSPAPER.
+ */
+void DrawColourMappingLineAVX2(Colour *dst, int width, PaletteID pal)
+{
+	const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+
+	int x = 0;
+	if (pal == PALETTE_TO_TRANSPARENT) {
+		/* Same as MakeTransparent(colour, 154) on eight pixels: scale all channels, then make the pixels opaque. */
+		const __m256i nom = _mm256_set1_epi16(154);
+		for (; x + 8 <= width; x += 8) {
+			__m256i data = _mm256_loadu_si256((const __m256i *)(dst + x));
+			__m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(data, _mm256_setzero_si256()), nom), 8);
+			__m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(data, _mm256_setzero_si256()), nom), 8);
+			_mm256_storeu_si256((__m256i *)(dst + x), _mm256_or_si256(_mm256_packus_epi16(lo, hi), alpha));
+		}
+		for (; x < width; x++) dst[x] = Blitter_32bppBase::MakeTransparent(dst[x], 154);
+	} else {
+		assert(pal == PALETTE_NEWSPAPER);
+
+		/* Same as MakeGrey() on eight pixels. */
+		const __m256i channel_mask = _mm256_set1_epi32(0xFF);
+		const __m256i r_factor = _mm256_set1_epi32(19595);
+		const __m256i g_factor = _mm256_set1_epi32(38470);
+		const __m256i b_factor = _mm256_set1_epi32(7471);
+		const __m256i grey_to_rgb = _mm256_set1_epi32(0x010101);
+		for (; x + 8 <= width; x += 8) {
+			__m256i data = _mm256_loadu_si256((const __m256i *)(dst + x));
+			__m256i r = _mm256_and_si256(_mm256_srli_epi32(data, 16), channel_mask);
+			__m256i g = _mm256_and_si256(_mm256_srli_epi32(data, 8), channel_mask);
+			__m256i b = _mm256_and_si256(data, channel_mask);
+			__m256i grey = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, r_factor), _mm256_mullo_epi32(g, g_factor)), _mm256_mullo_epi32(b, b_factor));
+			grey = _mm256_srli_epi32(grey, 16);
+			_mm256_storeu_si256((__m256i *)(dst + x), _mm256_or_si256(_mm256_mullo_epi32(grey, grey_to_rgb), alpha));
+		}
+		for (; x < width; x++) dst[x] = Blitter_32bppBase::MakeGrey(dst[x]);
+	}
+}
+
+void Blitter_32bppAVX2::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+{
+	if (pal != PALETTE_TO_TRANSPARENT && pal != PALETTE_NEWSPAPER) {
+		/* A colour table we do not handle here, so let our parent handle it. */
+		Blitter_32bppSSE4::DrawColourMappingRect(dst, width, height, pal);
+		return;
+	}
+
+	Colour *udst = (Colour *)dst;
+	do {
+		DrawColourMappingLineAVX2(udst, width, pal);
+		udst += _screen.pitch;
+	} while (--height);
+}
+
+#endif /* WITH_AVX2 */
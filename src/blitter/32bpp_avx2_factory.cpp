@@ -0,0 +1,29 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file 32bpp_avx2_factory.cpp Instantiation of the factories of the AVX2 blitters.
+ * The blitters themselves are compiled for AVX2, which would make the factories
+ * crash on processors without it before they could tell the blitter is not usable.
+ */
+
+#ifdef WITH_AVX2
+
+#include "../stdafx.h"
+#include "32bpp_avx2.hpp"
+#include "32bpp_anim_avx2.hpp"
+
+#include "../safeguards.h"
+
+/** Instantiation of the AVX2 32bpp blitter factory. */
+static FBlitter_32bppAVX2 iFBlitter_32bppAVX2;
+/** Instantiation of the AVX2 32bpp blitter factory (with palette animation). */
+static FBlitter_32bppAVX2_Anim iFBlitter_32bppAVX2_Anim;
+
+#endif /* WITH_AVX2 */
@@ -205,9 +205,8 @@ bool StationCargoReroute::operator()(CargoPacket *cp)
 		this->destination->AddToCache(cp_new);
 	}
 
-	/* Legal, as insert doesn't invalidate iterators in the MultiMap, however
-	 * this might insert the packet between range.first and range.second (which might be end())
-	 * This is why we check for GetKey above to avoid infinite loops. */
+	/* Legal, as inserting doesn't move the buckets in the FlatMultiMap. The
+	 * packet never ends up in the bucket being shifted from, as next != avoid. */
 	this->destination->packets.Insert(next, cp_new);
 	return cp_new == cp;
 }
@@ -256,6 +256,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 	assert(cp != NULL);
 	assert(action == MTA_LOAD ||
 			(action == MTA_KEEP && this->action_counts[MTA_LOAD] == 0));
+	this->ApplyPendingAge();
 	this->AddToMeta(cp, action);
 
 	if (this->count == cp->count) {
@@ -288,6 +289,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 template<class Taction>
 void VehicleCargoList::ShiftCargo(Taction action)
 {
+	this->ApplyPendingAge();
 	Iterator it(this->packets.begin());
 	while (it != this->packets.end() && action.MaxMove() > 0) {
 		CargoPacket *cp = *it;
@@ -311,6 +313,7 @@ template<class Taction>
 void VehicleCargoList::PopCargo(Taction action)
 {
 	if (this->packets.empty()) return;
+	this->ApplyPendingAge();
 	Iterator it(--(this->packets.end()));
 	Iterator begin(this->packets.begin());
 	while (action.MaxMove() > 0) {
@@ -336,7 +339,9 @@ void VehicleCargoList::PopCargo(Taction action)
  */
 void VehicleCargoList::RemoveFromCache(const CargoPacket *cp, uint count)
 {
+	assert(this->pending_age == 0);
 	this->feeder_share -= cp->FeederShare(count);
+	if (cp->days_in_transit == 0xFF) this->saturated_count -= count;
 	this->Parent::RemoveFromCache(cp, count);
 }
 
@@ -347,7 +352,13 @@ void VehicleCargoList::RemoveFromCache(const CargoPacket *cp, uint count)
  */
 void VehicleCargoList::AddToCache(const CargoPacket *cp)
 {
+	assert(this->pending_age == 0);
 	this->feeder_share += cp->feeder_share;
+	if (cp->days_in_transit == 0xFF) {
+		this->saturated_count += cp->count;
+	} else {
+		this->age_headroom = min<uint>(this->age_headroom, 0xFF - cp->days_in_transit);
+	}
 	this->Parent::AddToCache(cp);
 }
 
@@ -380,18 +391,42 @@ void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
 }
 
 /**
- * Ages the all cargo in this list.
+ * Ages the all cargo in this list. The packets themselves are only updated
+ * when they are needed or when one of them is about to reach the maximum
+ * days in transit; until then only the cached sum is kept up to date.
  */
 void VehicleCargoList::AgeCargo()
 {
+	if (this->count == 0) return;
+	if (this->pending_age >= this->age_headroom) this->ApplyAge();
+
+	/* No packet reaches the maximum with this aging, so all cargo that
+	 * isn't already at the maximum ages by one day. */
+	this->pending_age++;
+	this->cargo_days_in_transit += this->count - this->saturated_count;
+}
+
+/**
+ * Write the deferred aging to the packets and recompute the number of times
+ * the cargo can be aged before any packet has to be looked at again.
+ */
+void VehicleCargoList::ApplyAge() const
+{
+	this->saturated_count = 0;
+	this->age_headroom = 0xFF;
 	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
 		CargoPacket *cp = *it;
-		/* If we're at the maximum, then we can't increase no more. */
-		if (cp->days_in_transit == 0xFF) continue;
+		/* If we're at the maximum, then we can't increase no more. The
+		 * headroom guarantees that the other packets don't exceed it. */
+		if (cp->days_in_transit != 0xFF) cp->days_in_transit += this->pending_age;
 
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+		if (cp->days_in_transit == 0xFF) {
+			this->saturated_count += cp->count;
+		} else {
+			this->age_headroom = min<uint>(this->age_headroom, 0xFF - cp->days_in_transit);
+		}
 	}
+	this->pending_age = 0;
 }
 
 /**
@@ -451,6 +486,7 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 {
 	this->AssertCountConsistency();
 	assert(this->action_counts[MTA_LOAD] == 0);
+	this->ApplyPendingAge();
 	this->action_counts[MTA_TRANSFER] = this->action_counts[MTA_DELIVER] = this->action_counts[MTA_KEEP] = 0;
 	Iterator deliver = this->packets.end();
 	Iterator it = this->packets.begin();
@@ -541,7 +577,9 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 /** Invalidates the cached data and rebuild it. */
 void VehicleCargoList::InvalidateCache()
 {
+	this->ApplyPendingAge();
 	this->feeder_share = 0;
+	this->saturated_count = 0;
 	this->Parent::InvalidateCache();
 }
 
@@ -673,6 +711,7 @@ uint VehicleCargoList::Truncate(uint max_move)
 uint VehicleCargoList::Reroute(uint max_move, VehicleCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
 	max_move = min(this->action_counts[MTA_TRANSFER], max_move);
+	dest->ApplyPendingAge();
 	this->ShiftCargo(VehicleCargoReroute(this, dest, max_move, avoid, avoid2, ge));
 	return max_move;
 }
@@ -696,14 +735,13 @@ void StationCargoList::Append(CargoPacket *cp, StationID next)
 	assert(cp != NULL);
 	this->AddToCache(cp);
 
-	StationCargoPacketMap::List &list = this->packets[next];
-	for (StationCargoPacketMap::List::reverse_iterator it(list.rbegin());
-			it != list.rend(); it++) {
-		if (StationCargoList::TryMerge(*it, cp)) return;
+	StationCargoPacketMap::Bucket &bucket = this->packets[next];
+	for (uint i = bucket.Size(); i > 0; i--) {
+		if (StationCargoList::TryMerge(bucket[i - 1], cp)) return;
 	}
 
 	/* The packet could not be merged with another one */
-	list.push_back(cp);
+	bucket.PushBack(cp);
 }
 
 /**
@@ -721,17 +759,21 @@ void StationCargoList::Append(CargoPacket *cp, StationID next)
 template <class Taction>
 bool StationCargoList::ShiftCargo(Taction &action, StationID next)
 {
-	std::pair<Iterator, Iterator> range(this->packets.equal_range(next));
-	for (Iterator it(range.first); it != range.second && it.GetKey() == next;) {
-		if (action.MaxMove() == 0) return false;
-		CargoPacket *cp = *it;
-		if (action(cp)) {
-			it = this->packets.erase(it);
-		} else {
-			return false;
+	/* The bucket stays in place if the action adds packets for other next
+	 * hops to this list, so it can be used throughout the loop. */
+	StationCargoPacketMap::Bucket *bucket = this->packets.Find(next);
+	if (bucket == NULL) return true;
+
+	bool all = true;
+	while (!bucket->IsEmpty()) {
+		if (action.MaxMove() == 0 || !action(bucket->Front())) {
+			all = false;
+			break;
 		}
+		bucket->PopFront();
 	}
-	return true;
+	this->packets.RemoveIfEmpty(bucket);
+	return all;
 }
 
 /**
@@ -796,13 +838,16 @@ uint StationCargoList::Truncate(uint max_move, StationCargoAmountMap *cargo_per_
 				}
 				if (loop > 0) {
 					if (do_count) (*cargo_per_source)[cp->source] -= diff;
+					this->packets.RemoveAll(NULL);
 					return moved;
 				} else {
 					if (do_count) (*cargo_per_source)[cp->source] += cp->count;
 					++it;
 				}
 			} else {
-				it = this->packets.erase(it);
+				/* Only mark the packet as removed; the list is compacted in one go. */
+				*it = NULL;
+				++it;
 				if (do_count && loop > 0) {
 					(*cargo_per_source)[cp->source] -= cp->count;
 				}
@@ -811,6 +856,7 @@ uint StationCargoList::Truncate(uint max_move, StationCargoAmountMap *cargo_per_
 				delete cp;
 			}
 		}
+		this->packets.RemoveAll(NULL);
 		loop++;
 	}
 	return moved;
@@ -18,8 +18,9 @@
 #include "order_type.h"
 #include "cargo_type.h"
 #include "vehicle_type.h"
-#include "core/multimap.hpp"
+#include "core/flatmultimap.hpp"
 #include <list>
+#include <map>
 
 /** Unique identifier for a single cargo packet. */
 typedef uint32 CargoPacketID;
@@ -216,12 +217,8 @@ class CargoList {
 public:
 	/** The iterator for our container. */
 	typedef typename Tcont::iterator Iterator;
-	/** The reverse iterator for our container. */
-	typedef typename Tcont::reverse_iterator ReverseIterator;
 	/** The const iterator for our container. */
 	typedef typename Tcont::const_iterator ConstIterator;
-	/** The const reverse iterator for our container. */
-	typedef typename Tcont::const_reverse_iterator ConstReverseIterator;
 
 	/** Kind of actions that could be done with packets on move. */
 	enum MoveToAction {
@@ -288,6 +285,10 @@ protected:
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transfered, delivered, kept and loaded.
 
+	mutable uint saturated_count;           ///< Cache for the amount of cargo that reached the maximum days in transit.
+	mutable byte pending_age;               ///< Number of times the cargo was aged without updating the packets yet.
+	mutable byte age_headroom;              ///< Number of times the cargo can be aged before the first packet reaches the maximum days in transit.
+
 	template<class Taction>
 	void ShiftCargo(Taction action);
 
@@ -314,7 +315,14 @@ protected:
 	static MoveToAction ChooseAction(const CargoPacket *cp, StationID cargo_next,
 			StationID current_station, bool accepted, StationIDStack next_station);
 
+	void ApplyAge() const;
+
 public:
+	/** The reverse iterator for our container. */
+	typedef CargoPacketList::reverse_iterator ReverseIterator;
+	/** The const reverse iterator for our container. */
+	typedef CargoPacketList::const_reverse_iterator ConstReverseIterator;
+
 	/** The station cargo list needs to control the unloading. */
 	friend class StationCargoList;
 	/** The super class ought to know what it's doing. */
@@ -330,6 +338,26 @@ public:
 	friend class CargoReturn;
 	friend class VehicleCargoReroute;
 
+	/**
+	 * Write the aging deferred by AgeCargo() to the packets, so their
+	 * days_in_transit is up to date. Has to be done before the packets are
+	 * inspected or moved elsewhere.
+	 */
+	inline void ApplyPendingAge() const
+	{
+		if (this->pending_age != 0) this->ApplyAge();
+	}
+
+	/**
+	 * Returns a pointer to the cargo packet list (so you can iterate over it etc).
+	 * @return Pointer to the packet list.
+	 */
+	inline const CargoPacketList *Packets() const
+	{
+		this->ApplyPendingAge();
+		return this->Parent::Packets();
+	}
+
 	/**
 	 * Returns source of the first cargo packet in this list.
 	 * @return The before mentioned source.
@@ -454,7 +482,7 @@ public:
 	}
 };
 
-typedef MultiMap<StationID, CargoPacket *> StationCargoPacketMap;
+typedef FlatMultiMap<StationID, CargoPacket *> StationCargoPacketMap;
 typedef std::map<StationID, uint> StationCargoAmountMap;
 
 /**
@@ -499,10 +527,10 @@ public:
 	inline bool HasCargoFor(StationIDStack next) const
 	{
 		while (!next.IsEmpty()) {
-			if (this->packets.find(next.Pop()) != this->packets.end()) return true;
+			if (this->packets.Find(next.Pop()) != NULL) return true;
 		}
 		/* Packets for INVALID_STTION can go anywhere. */
-		return this->packets.find(INVALID_STATION) != this->packets.end();
+		return this->packets.Find(INVALID_STATION) != NULL;
 	}
 
 	/**
@@ -511,7 +539,7 @@ public:
 	 */
 	inline StationID Source() const
 	{
-		return this->count == 0 ? INVALID_STATION : this->packets.begin()->second.front()->source;
+		return this->count == 0 ? INVALID_STATION : (*this->packets.begin())->source;
 	}
 
 	/**
@@ -175,20 +175,23 @@ static void UpdateFences(TileIndex tile)
 }
 
 
-/** Convert to or from snowy tiles. */
-static void TileLoopClearAlps(TileIndex tile)
+/**
+ * Convert to or from snowy tiles.
+ * @param tile The tile to convert.
+ * @return Whether the tile changed.
+ */
+static bool TileLoopClearAlps(TileIndex tile)
 {
 	int k = GetTileZ(tile) - GetSnowLine() + 1;
 
 	if (k < 0) {
 		/* Below the snow line, do nothing if no snow. */
-		if (!IsSnowTile(tile)) return;
+		if (!IsSnowTile(tile)) return false;
 	} else {
 		/* At or above the snow line, make snow tile if needed. */
 		if (!IsSnowTile(tile)) {
 			MakeSnow(tile);
-			MarkTileDirtyByTile(tile);
-			return;
+			return true;
 		}
 	}
 	/* Update snow density. */
@@ -201,10 +204,10 @@ static void TileLoopClearAlps(TileIndex tile)
 		AddClearDensity(tile, -1);
 	} else {
 		/* Density at the required level. */
-		if (k >= 0) return;
+		if (k >= 0) return false;
 		ClearSnow(tile);
 	}
-	MarkTileDirtyByTile(tile);
+	return true;
 }
 
 /**
@@ -223,7 +226,12 @@ static inline bool NeighbourIsNormal(TileIndex tile)
 	return false;
 }
 
-static void TileLoopClearDesert(TileIndex tile)
+/**
+ * Convert to or from desert tiles.
+ * @param tile The tile to convert.
+ * @return Whether the tile changed.
+ */
+static bool TileLoopClearDesert(TileIndex tile)
 {
 	/* Current desert level - 0 if it is not desert */
 	uint current = 0;
@@ -235,7 +243,7 @@ static void TileLoopClearDesert(TileIndex tile)
 		expected = NeighbourIsNormal(tile) ? 1 : 3;
 	}
 
-	if (current == expected) return;
+	if (current == expected) return false;
 
 	if (expected == 0) {
 		SetClearGroundDensity(tile, CLEAR_GRASS, 3);
@@ -244,35 +252,30 @@ static void TileLoopClearDesert(TileIndex tile)
 		SetClearGroundDensity(tile, CLEAR_DESERT, expected);
 	}
 
-	MarkTileDirtyByTile(tile);
+	return true;
 }
 
-static void TileLoop_Clear(TileIndex tile)
+/**
+ * Update the ground of a clear tile: the snow or desert, and the growth of grass and fields.
+ * @param tile The tile to update.
+ * @return Whether the tile has to be redrawn.
+ */
+static bool TileLoopClearGround(TileIndex tile)
 {
-	/* If the tile is at any edge flood it to prevent maps without water. */
-	if (_settings_game.construction.freeform_edges && DistanceFromEdge(tile) == 1) {
-		int z;
-		if (IsTileFlat(tile, &z) && z == 0) {
-			DoFloodTile(tile);
-			MarkTileDirtyByTile(tile);
-			return;
-		}
-	}
-	AmbientSoundEffect(tile);
-
+	bool dirty = false;
 	switch (_settings_game.game_creation.landscape) {
-		case LT_TROPIC: TileLoopClearDesert(tile); break;
-		case LT_ARCTIC: TileLoopClearAlps(tile);   break;
+		case LT_TROPIC: dirty = TileLoopClearDesert(tile); break;
+		case LT_ARCTIC: dirty = TileLoopClearAlps(tile);   break;
 	}
 
 	switch (GetClearGround(tile)) {
 		case CLEAR_GRASS:
-			if (GetClearDensity(tile) == 3) return;
+			if (GetClearDensity(tile) == 3) return dirty;
 
 			if (_game_mode != GM_EDITOR) {
 				if (GetClearCounter(tile) < 7) {
 					AddClearCounter(tile, 1);
-					return;
+					return dirty;
 				} else {
 					SetClearCounter(tile, 0);
 					AddClearDensity(tile, 1);
@@ -285,11 +288,11 @@ static void TileLoop_Clear(TileIndex tile)
 		case CLEAR_FIELDS:
 			UpdateFences(tile);
 
-			if (_game_mode == GM_EDITOR) return;
+			if (_game_mode == GM_EDITOR) return dirty;
 
 			if (GetClearCounter(tile) < 7) {
 				AddClearCounter(tile, 1);
-				return;
+				return dirty;
 			} else {
 				SetClearCounter(tile, 0);
 			}
@@ -305,10 +308,40 @@ static void TileLoop_Clear(TileIndex tile)
 			break;
 
 		default:
+			return dirty;
+	}
+
+	return true;
+}
+
+/**
+ * Update the ground of a clear tile of a newly generated landscape, like its
+ * tile loop does, but without flooding it at the edge of the map and without
+ * redrawing it. So the ground of different tiles can be updated at the same
+ * time, as long as there are no fields and the game is not in the scenario
+ * editor, where the growth of grass is random.
+ * @param tile The tile to update.
+ */
+void SettleClearTile(TileIndex tile)
+{
+	assert(IsTileType(tile, MP_CLEAR) && !IsClearGround(tile, CLEAR_FIELDS));
+	TileLoopClearGround(tile);
+}
+
+static void TileLoop_Clear(TileIndex tile)
+{
+	/* If the tile is at any edge flood it to prevent maps without water. */
+	if (_settings_game.construction.freeform_edges && DistanceFromEdge(tile) == 1) {
+		int z;
+		if (IsTileFlat(tile, &z) && z == 0) {
+			DoFloodTile(tile);
+			MarkTileDirtyByTile(tile);
 			return;
+		}
 	}
+	AmbientSoundEffect(tile);
 
-	MarkTileDirtyByTile(tile);
+	if (TileLoopClearGround(tile)) MarkTileDirtyByTile(tile);
 }
 
 void GenerateClearTile()
@@ -17,4 +17,6 @@
 void DrawHillyLandTile(const TileInfo *ti);
 void DrawClearLandTile(const TileInfo *ti, byte set);
 
+void SettleClearTile(TileIndex tile);
+
 #endif /* CLEAR_FUNC_H */
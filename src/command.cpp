@@ -26,6 +26,7 @@
 #include "signal_func.h"
 #include "core/backup_type.hpp"
 #include "object_base.h"
+#include "pathfinder/depot_cache.h"
 
 #include "table/strings.h"
 
@@ -427,6 +428,19 @@ bool IsCommandAllowedWhilePaused(uint32 cmd)
 
 static int _docommand_recursive = 0;
 
+/**
+ * Invalidate the caches that depend on the landscape or the settings after
+ * successfully executing a command that may have changed them. Tests and
+ * failed commands change nothing; the commands a failed command executed
+ * before failing invalidated the caches themselves.
+ * @param cmd The executed command.
+ */
+static void InvalidateCachesAfterCommand(uint32 cmd)
+{
+	CommandType type = _command_proc_table[cmd].type;
+	if (type == CMDT_LANDSCAPE_CONSTRUCTION || type == CMDT_SERVER_SETTING) InvalidateNearestDepotCache();
+}
+
 /**
  * Shorthand for calling the long DoCommand with a container.
  *
@@ -498,6 +512,8 @@ error:
 		return res;
 	}
 
+	InvalidateCachesAfterCommand(cmd & CMD_ID_MASK);
+
 	/* if toplevel, subtract the money. */
 	if (--_docommand_recursive == 0 && !(flags & DC_BANKRUPT)) {
 		SubtractMoneyFromCompany(res);
@@ -718,6 +734,7 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd,
 	BasePersistentStorageArray::SwitchMode(PSM_ENTER_COMMAND);
 	CommandCost res2 = proc(tile, flags | DC_EXEC, p1, p2, text);
 	BasePersistentStorageArray::SwitchMode(PSM_LEAVE_COMMAND);
+	if (res2.Succeeded()) InvalidateCachesAfterCommand(cmd_id);
 
 	if (cmd_id == CMD_COMPANY_CTRL) {
 		cur_company.Trash();
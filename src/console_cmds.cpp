@@ -34,10 +34,14 @@
 #include "gamelog.h"
 #include "ai/ai.hpp"
 #include "ai/ai_config.hpp"
+#include "ai/ai_instance.hpp"
 #include "newgrf.h"
 #include "console_func.h"
 #include "engine_base.h"
 #include "game/game.hpp"
+#include "game/game_instance.hpp"
+#include "script/script_profiler.hpp"
+#include "tgp.h"
 #include "table/strings.h"
 
 #include "safeguards.h"
@@ -1290,6 +1294,74 @@ DEF_CONSOLE_CMD(ConRescanGame)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConScriptProfile)
+{
+	if (argc != 3) {
+		IConsoleHelp("Profile where a script spends its time and operations. Usage: 'script_profile <company-id>|game start|stop|reset|flat|collapsed|collapsed_time'");
+		IConsoleHelp("Use the company id of an AI, or 'game' for the Game Script. For company-id's, see the list of companies from the dropdown menu. Company 1 is 1, etc.");
+		IConsoleHelp("'flat' prints the totals per function; 'collapsed' and 'collapsed_time' print the operations respectively microseconds per call stack, for use with flame graph tools.");
+		return true;
+	}
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleWarning("Scripts can only be profiled in a game.");
+		return true;
+	}
+
+	ScriptInstance *instance;
+	if (strcasecmp(argv[1], "game") == 0) {
+		instance = Game::GetInstance();
+		if (instance == NULL) {
+			IConsoleWarning("No Game Script is running.");
+			return true;
+		}
+	} else {
+		CompanyID company_id = (CompanyID)(atoi(argv[1]) - 1);
+		if (!Company::IsValidID(company_id)) {
+			IConsolePrintF(CC_DEFAULT, "Unknown company. Company range is between 1 and %d.", MAX_COMPANIES);
+			return true;
+		}
+
+		if (!Company::IsValidAiID(company_id) || Company::Get(company_id)->ai_instance == NULL) {
+			IConsoleWarning("Company is not controlled by an AI.");
+			return true;
+		}
+		instance = Company::Get(company_id)->ai_instance;
+	}
+
+	if (strcasecmp(argv[2], "start") == 0) {
+		instance->StartProfiling();
+		IConsolePrint(CC_DEFAULT, "Profiling started.");
+		return true;
+	}
+
+	if (strcasecmp(argv[2], "stop") == 0) {
+		instance->StopProfiling();
+		IConsolePrint(CC_DEFAULT, "Profiling stopped.");
+		return true;
+	}
+
+	ScriptProfiler *profiler = instance->GetProfiler();
+	if (profiler == NULL) {
+		IConsoleWarning("The script has not been profiled. Use 'start' to start profiling it.");
+		return true;
+	}
+
+	if (strcasecmp(argv[2], "reset") == 0) {
+		profiler->Reset();
+	} else if (strcasecmp(argv[2], "flat") == 0) {
+		profiler->Print(ScriptProfiler::SPF_FLAT);
+	} else if (strcasecmp(argv[2], "collapsed") == 0) {
+		profiler->Print(ScriptProfiler::SPF_COLLAPSED_OPS);
+	} else if (strcasecmp(argv[2], "collapsed_time") == 0) {
+		profiler->Print(ScriptProfiler::SPF_COLLAPSED_TIME);
+	} else {
+		IConsoleError("Unknown action.");
+	}
+
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConRescanNewGRF)
 {
 	if (argc == 0) {
@@ -1882,6 +1954,23 @@ DEF_CONSOLE_CMD(ConNewGRFReload)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConNewGRFBenchmark)
+{
+	extern void ConPrintNewGRFBenchmark(uint iterations); // newgrf_engine.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Measure how fast the NewGRF sprite groups of the engines and vehicles are resolved. Usage: 'newgrf_benchmark [<iterations>]'");
+		IConsoleHelp("The sprite and a few callbacks are resolved for every engine and vehicle with NewGRF graphics, 100 times by default.");
+		return true;
+	}
+
+	uint32 iterations = 100;
+	if (argc > 2 || (argc == 2 && !GetArgumentInteger(&iterations, argv[1]))) return false;
+
+	ConPrintNewGRFBenchmark(iterations);
+	return true;
+}
+
 #ifdef _DEBUG
 /******************
  *  debug commands
@@ -1926,6 +2015,37 @@ DEF_CONSOLE_CMD(ConFramerateWindow)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConBlitterBenchmark)
+{
+	extern void ConPrintBlitterBenchmark(uint iterations); // gfx.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Measure how fast the current blitter draws. Usage: 'blitter_benchmark [<iterations>]'");
+		IConsoleHelp("The screen is redrawn, colour mapped and palette animated, 100 times by default.");
+		return true;
+	}
+
+	uint32 iterations = 100;
+	if (argc > 2 || (argc == 2 && !GetArgumentInteger(&iterations, argv[1]))) return false;
+
+	ConPrintBlitterBenchmark(iterations);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConTGPThreads)
+{
+	if (argc == 0) {
+		IConsoleHelp("Set the number of threads the height map of new maps is generated with. Usage: 'tgp_threads [<threads>]'");
+		IConsoleHelp("0 chooses it by the number of processor cores and the size of the map. The height map does not depend on it.");
+		return true;
+	}
+
+	if (argc > 2 || (argc == 2 && !GetArgumentInteger(&_tgp_threads, argv[1]))) return false;
+
+	IConsolePrintF(CC_DEFAULT, "TGP threads: %u", _tgp_threads);
+	return true;
+}
+
 /*******************************
  * console command registration
  *******************************/
@@ -1987,6 +2107,7 @@ void IConsoleStdLibRegister()
 	IConsoleCmdRegister("list_game",    ConListGame);
 	IConsoleCmdRegister("list_game_libs", ConListGameLibs);
 	IConsoleCmdRegister("rescan_game",    ConRescanGame);
+	IConsoleCmdRegister("script_profile", ConScriptProfile);
 
 	IConsoleCmdRegister("companies",       ConCompanies);
 	IConsoleAliasRegister("players",       "companies");
@@ -2058,7 +2179,10 @@ void IConsoleStdLibRegister()
 #endif
 	IConsoleCmdRegister("fps",     ConFramerate);
 	IConsoleCmdRegister("fps_wnd", ConFramerateWindow);
+	IConsoleCmdRegister("blitter_benchmark", ConBlitterBenchmark);
+	IConsoleCmdRegister("tgp_threads", ConTGPThreads);
 
 	/* NewGRF development stuff */
 	IConsoleCmdRegister("reload_newgrfs",  ConNewGRFReload, ConHookNewGRFDeveloperTool);
+	IConsoleCmdRegister("newgrf_benchmark", ConNewGRFBenchmark, ConHookNewGRFDeveloperTool);
 }
@@ -0,0 +1,120 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file flatmap.hpp Map keeping its items in a sorted contiguous array. */
+
+#ifndef FLATMAP_HPP
+#define FLATMAP_HPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/**
+ * Map with the interface of a (subset of) std::map, but keeping the items in a
+ * vector sorted by key. Lookups are binary searches on contiguous memory and
+ * appending items in ascending key order is cheap, which makes it suitable for
+ * small maps that are mostly rebuilt rather than modified.
+ * @note Inserting or erasing items invalidates all iterators.
+ * @tparam Tkey Key type of the map.
+ * @tparam Tvalue Value type of the map.
+ */
+template <typename Tkey, typename Tvalue>
+class FlatMap {
+public:
+	typedef std::pair<Tkey, Tvalue> value_type;
+	typedef std::vector<value_type> Storage;
+	typedef typename Storage::iterator iterator;
+	typedef typename Storage::const_iterator const_iterator;
+	typedef typename Storage::reverse_iterator reverse_iterator;
+	typedef typename Storage::const_reverse_iterator const_reverse_iterator;
+
+private:
+	Storage items; ///< Items of the map, sorted by key.
+
+	/** Comparator for binary searching by key. */
+	struct KeyCompare {
+		inline bool operator()(const value_type &item, const Tkey &key) const { return item.first < key; }
+		inline bool operator()(const Tkey &key, const value_type &item) const { return key < item.first; }
+	};
+
+public:
+	inline iterator begin() { return this->items.begin(); }
+	inline iterator end() { return this->items.end(); }
+	inline const_iterator begin() const { return this->items.begin(); }
+	inline const_iterator end() const { return this->items.end(); }
+	inline reverse_iterator rbegin() { return this->items.rbegin(); }
+	inline reverse_iterator rend() { return this->items.rend(); }
+	inline const_reverse_iterator rbegin() const { return this->items.rbegin(); }
+	inline const_reverse_iterator rend() const { return this->items.rend(); }
+
+	inline bool empty() const { return this->items.empty(); }
+	inline size_t size() const { return this->items.size(); }
+	inline void clear() { this->items.clear(); }
+	inline void swap(FlatMap &other) { this->items.swap(other.items); }
+
+	/**
+	 * Find the first item with a key not less than the given one.
+	 * @param key Key to look for.
+	 * @return Iterator to the item or end().
+	 */
+	inline const_iterator lower_bound(const Tkey &key) const
+	{
+		return std::lower_bound(this->items.begin(), this->items.end(), key, KeyCompare());
+	}
+
+	/**
+	 * Find the first item with a key greater than the given one.
+	 * @param key Key to look for.
+	 * @return Iterator to the item or end().
+	 */
+	inline const_iterator upper_bound(const Tkey &key) const
+	{
+		return std::upper_bound(this->items.begin(), this->items.end(), key, KeyCompare());
+	}
+
+	/**
+	 * Find the item with the given key.
+	 * @param key Key to look for.
+	 * @return Iterator to the item or end().
+	 */
+	inline const_iterator find(const Tkey &key) const
+	{
+		const_iterator it = this->lower_bound(key);
+		return (it != this->items.end() && !(key < it->first)) ? it : this->items.end();
+	}
+
+	/**
+	 * Get the value for a key, inserting a default constructed one if the key
+	 * isn't present yet. Appending keys in ascending order is O(1).
+	 * @param key Key to look for.
+	 * @return The value.
+	 */
+	Tvalue &operator[](const Tkey &key)
+	{
+		if (this->items.empty() || this->items.back().first < key) {
+			this->items.push_back(value_type(key, Tvalue()));
+			return this->items.back().second;
+		}
+		iterator it = std::lower_bound(this->items.begin(), this->items.end(), key, KeyCompare());
+		if (key < it->first) it = this->items.insert(it, value_type(key, Tvalue()));
+		return it->second;
+	}
+
+	/**
+	 * Reserve storage for a number of items.
+	 * @param count Number of items.
+	 */
+	inline void reserve(size_t count)
+	{
+		this->items.reserve(count);
+	}
+};
+
+#endif /* FLATMAP_HPP */
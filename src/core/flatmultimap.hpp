@@ -0,0 +1,383 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file flatmultimap.hpp Multimap with contiguous storage for the items of each key and deterministic ordering of items with equal keys. */
+
+#ifndef FLATMULTIMAP_HPP
+#define FLATMULTIMAP_HPP
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+/**
+ * Multimap keeping the items of each key in a contiguous bucket. The buckets
+ * are kept in a vector sorted by key. Items can cheaply be added to the back
+ * and removed from the front of a bucket. Buckets are recycled, so their
+ * storage is reused when a key disappears and another key shows up.
+ * Buckets don't move in memory while they are in use, so a reference to a
+ * bucket stays valid when other keys are added.
+ * @tparam Tkey Key type of the map.
+ * @tparam Tvalue Value type of the map.
+ */
+template <typename Tkey, typename Tvalue>
+class FlatMultiMap {
+public:
+	template <class Tmap, class Titem> class Iterator;
+
+	/** Items stored for a single key. */
+	class Bucket {
+		friend class FlatMultiMap;
+		template <class Tmap, class Titem> friend class Iterator;
+
+		Tkey key;                  ///< Key of the items in this bucket.
+		std::vector<Tvalue> items; ///< Storage for the items, including the ones already removed from the front.
+		uint head;                 ///< Index of the first item that hasn't been removed yet.
+
+	public:
+		/**
+		 * Get the key of this bucket.
+		 * @return The key.
+		 */
+		inline const Tkey &GetKey() const { return this->key; }
+
+		/**
+		 * Get the number of items in this bucket.
+		 * @return Number of items.
+		 */
+		inline uint Size() const { return (uint)this->items.size() - this->head; }
+
+		/**
+		 * Check whether the bucket holds any items.
+		 * @return True if there are no items.
+		 */
+		inline bool IsEmpty() const { return this->head == this->items.size(); }
+
+		/**
+		 * Get an item of this bucket.
+		 * @param index Position of the item, counted from the front.
+		 * @return The item.
+		 */
+		inline Tvalue &operator[](uint index) { return this->items[this->head + index]; }
+
+		/**
+		 * Get an item of this bucket.
+		 * @param index Position of the item, counted from the front.
+		 * @return The item.
+		 */
+		inline const Tvalue &operator[](uint index) const { return this->items[this->head + index]; }
+
+		/**
+		 * Get the first item of this bucket.
+		 * @return The first item.
+		 */
+		inline Tvalue &Front()
+		{
+			assert(!this->IsEmpty());
+			return this->items[this->head];
+		}
+
+		/**
+		 * Append an item to the back of this bucket.
+		 * @param value Item to append.
+		 */
+		inline void PushBack(const Tvalue &value)
+		{
+			this->items.push_back(value);
+		}
+
+		/**
+		 * Remove the first item of this bucket. The storage of removed items
+		 * is reclaimed once they make up the larger part of the storage.
+		 */
+		void PopFront()
+		{
+			assert(!this->IsEmpty());
+			if (++this->head == this->items.size()) {
+				this->items.clear();
+				this->head = 0;
+			} else if (this->head >= 32 && this->head * 2 >= this->items.size()) {
+				this->items.erase(this->items.begin(), this->items.begin() + this->head);
+				this->head = 0;
+			}
+		}
+
+		/**
+		 * Remove all items equal to the given one, keeping the order of the others.
+		 * @param value Item to be removed.
+		 */
+		void Remove(const Tvalue &value)
+		{
+			this->items.erase(std::remove(this->items.begin() + this->head, this->items.end(), value), this->items.end());
+			if (this->IsEmpty()) {
+				this->items.clear();
+				this->head = 0;
+			}
+		}
+	};
+
+	typedef std::vector<Bucket *> BucketVector; ///< Buckets sorted by key.
+
+	/**
+	 * STL-style iterator over all items of a FlatMultiMap, ordered by key and
+	 * by insertion for items with equal keys.
+	 * @tparam Tmap Type of the map, possibly const.
+	 * @tparam Titem Type of the items, possibly const.
+	 */
+	template <class Tmap, class Titem>
+	class Iterator {
+		friend class FlatMultiMap;
+
+		Tmap *map;   ///< Map being iterated.
+		uint bucket; ///< Index of the current bucket.
+		uint item;   ///< Index of the current item in the storage of the current bucket.
+
+		/**
+		 * Create an iterator pointing at the first item of a bucket.
+		 * @param map Map to iterate.
+		 * @param bucket Index of the bucket.
+		 */
+		Iterator(Tmap *map, uint bucket) : map(map), bucket(bucket)
+		{
+			this->item = bucket < map->buckets.size() ? map->buckets[bucket]->head : 0;
+		}
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Tvalue value_type;
+		typedef ptrdiff_t difference_type;
+		typedef Titem *pointer;
+		typedef Titem &reference;
+
+		Iterator() : map(NULL), bucket(0), item(0) {}
+
+		/**
+		 * Create a const iterator from a non-const one.
+		 * @param other Iterator to copy.
+		 */
+		template <class Tother_map, class Tother_item>
+		Iterator(const Iterator<Tother_map, Tother_item> &other) : map(other.map), bucket(other.bucket), item(other.item) {}
+
+		template <class Tother_map, class Tother_item> friend class Iterator;
+
+		inline Titem &operator*() const { return this->map->buckets[this->bucket]->items[this->item]; }
+		inline Titem *operator->() const { return &this->operator*(); }
+
+		/**
+		 * Get the key of the current item.
+		 * @return The key.
+		 */
+		inline const Tkey &GetKey() const { return this->map->buckets[this->bucket]->key; }
+
+		Iterator &operator++()
+		{
+			if (++this->item == this->map->buckets[this->bucket]->items.size()) {
+				*this = Iterator(this->map, this->bucket + 1);
+			}
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator tmp = *this;
+			this->operator++();
+			return tmp;
+		}
+
+		template <class Tother_map, class Tother_item>
+		inline bool operator==(const Iterator<Tother_map, Tother_item> &other) const
+		{
+			return this->bucket == other.bucket && this->item == other.item;
+		}
+
+		template <class Tother_map, class Tother_item>
+		inline bool operator!=(const Iterator<Tother_map, Tother_item> &other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	typedef Iterator<FlatMultiMap, Tvalue> iterator;
+	typedef Iterator<const FlatMultiMap, const Tvalue> const_iterator;
+
+private:
+	BucketVector buckets; ///< Buckets in use, sorted by key; none of them is empty.
+	BucketVector unused;  ///< Buckets that can be reused for new keys.
+
+	/**
+	 * Find the position of the first bucket not less than the given key.
+	 * @param key Key to look for.
+	 * @return Iterator into the bucket vector.
+	 */
+	typename BucketVector::const_iterator LowerBound(const Tkey &key) const
+	{
+		typename BucketVector::const_iterator first = this->buckets.begin();
+		size_t count = this->buckets.size();
+		while (count > 0) {
+			size_t step = count / 2;
+			typename BucketVector::const_iterator it = first + step;
+			if ((*it)->key < key) {
+				first = it + 1;
+				count -= step + 1;
+			} else {
+				count = step;
+			}
+		}
+		return first;
+	}
+
+	/* Buckets are owned by the map, so it can't be copied. */
+	FlatMultiMap(const FlatMultiMap &other);
+	FlatMultiMap &operator=(const FlatMultiMap &other);
+
+public:
+	FlatMultiMap() {}
+
+	~FlatMultiMap()
+	{
+		for (typename BucketVector::iterator it = this->buckets.begin(); it != this->buckets.end(); ++it) delete *it;
+		for (typename BucketVector::iterator it = this->unused.begin(); it != this->unused.end(); ++it) delete *it;
+	}
+
+	inline iterator begin() { return iterator(this, 0); }
+	inline iterator end() { return iterator(this, (uint)this->buckets.size()); }
+	inline const_iterator begin() const { return const_iterator(this, 0); }
+	inline const_iterator end() const { return const_iterator(this, (uint)this->buckets.size()); }
+
+	/**
+	 * Get all buckets in use, sorted by key.
+	 * @return The buckets.
+	 */
+	inline const BucketVector &Buckets() const { return this->buckets; }
+
+	/**
+	 * Find the bucket for a key.
+	 * @param key Key to look for.
+	 * @return The bucket or NULL if there are no items with that key.
+	 */
+	Bucket *Find(const Tkey &key) const
+	{
+		typename BucketVector::const_iterator it = this->LowerBound(key);
+		return (it != this->buckets.end() && (*it)->key == key) ? *it : NULL;
+	}
+
+	/**
+	 * Get the bucket for a key, creating an empty one if it doesn't exist yet.
+	 * @note An empty bucket has to be filled or removed with RemoveIfEmpty
+	 *       before the map is iterated.
+	 * @param key Key to look for.
+	 * @return The bucket.
+	 */
+	Bucket &operator[](const Tkey &key)
+	{
+		typename BucketVector::const_iterator it = this->LowerBound(key);
+		if (it != this->buckets.end() && (*it)->key == key) return **it;
+
+		Bucket *bucket;
+		if (this->unused.empty()) {
+			bucket = new Bucket();
+			bucket->head = 0;
+		} else {
+			bucket = this->unused.back();
+			this->unused.pop_back();
+		}
+		bucket->key = key;
+		this->buckets.insert(this->buckets.begin() + (it - this->buckets.begin()), bucket);
+		return *bucket;
+	}
+
+	/**
+	 * Append an item to the items with the given key.
+	 * @param key Key of the item.
+	 * @param value Item to be added.
+	 */
+	inline void Insert(const Tkey &key, const Tvalue &value)
+	{
+		(*this)[key].PushBack(value);
+	}
+
+	/**
+	 * Remove a bucket from the map if it doesn't hold any items anymore.
+	 * @param bucket Bucket to check.
+	 */
+	void RemoveIfEmpty(Bucket *bucket)
+	{
+		if (!bucket->IsEmpty()) return;
+		typename BucketVector::const_iterator it = this->LowerBound(bucket->key);
+		assert(it != this->buckets.end() && *it == bucket);
+		this->buckets.erase(this->buckets.begin() + (it - this->buckets.begin()));
+		this->unused.push_back(bucket);
+	}
+
+	/**
+	 * Remove all items equal to the given one and all buckets that become empty.
+	 * @param value Item to be removed.
+	 */
+	void RemoveAll(const Tvalue &value)
+	{
+		for (uint i = 0; i < this->buckets.size();) {
+			Bucket *bucket = this->buckets[i];
+			bucket->Remove(value);
+			if (bucket->IsEmpty()) {
+				this->buckets.erase(this->buckets.begin() + i);
+				this->unused.push_back(bucket);
+			} else {
+				i++;
+			}
+		}
+	}
+
+	/**
+	 * Get the range of items with the given key.
+	 * @param key Key to look for.
+	 * @return Pair of iterators pointing to the first item with the key and behind the last one.
+	 */
+	std::pair<const_iterator, const_iterator> equal_range(const Tkey &key) const
+	{
+		uint bucket = (uint)(this->LowerBound(key) - this->buckets.begin());
+		const_iterator first(this, bucket);
+		if (bucket == this->buckets.size() || this->buckets[bucket]->key != key) return std::make_pair(first, first);
+		return std::make_pair(first, const_iterator(this, bucket + 1));
+	}
+
+	/** Remove all items; the buckets are kept for reuse. */
+	void clear()
+	{
+		for (typename BucketVector::iterator it = this->buckets.begin(); it != this->buckets.end(); ++it) {
+			(*it)->items.clear();
+			(*it)->head = 0;
+			this->unused.push_back(*it);
+		}
+		this->buckets.clear();
+	}
+
+	/**
+	 * Count all items in the map.
+	 * @return Number of items.
+	 */
+	size_t size() const
+	{
+		size_t ret = 0;
+		for (typename BucketVector::const_iterator it = this->buckets.begin(); it != this->buckets.end(); ++it) {
+			ret += (*it)->Size();
+		}
+		return ret;
+	}
+
+	/**
+	 * Count the keys in the map.
+	 * @return Number of different keys.
+	 */
+	inline size_t MapSize() const
+	{
+		return this->buckets.size();
+	}
+};
+
+#endif /* FLATMULTIMAP_HPP */
@@ -90,7 +90,17 @@ uint64 ottd_rdtsc() {return 0;}
 #if defined(_MSC_VER)
 void ottd_cpuid(int info[4], int type)
 {
-	__cpuid(info, type);
+	__cpuidex(info, type, 0);
+}
+
+/**
+ * Read an extended control register of the CPU.
+ * @param reg The register to read.
+ * @return The value of the register.
+ */
+static uint64 ottd_xgetbv(uint reg)
+{
+	return _xgetbv(reg);
 }
 #elif defined(__x86_64__) || defined(__i386)
 void ottd_cpuid(int info[4], int type)
@@ -110,21 +120,34 @@ void ottd_cpuid(int info[4], int type)
 			/* It is safe to write "=r" for (info[1]) as in case that PIC is enabled for i386,
 			 * the compiler will not choose EBX as target register (but something else).
 			 */
-			: "a" (type)
+			: "a" (type), "c" (0)
 	);
 #else
 	__asm__ __volatile__ (
 			"cpuid           \n\t"
 			: "=a" (info[0]), "=b" (info[1]), "=c" (info[2]), "=d" (info[3])
-			: "a" (type)
+			: "a" (type), "c" (0)
 	);
 #endif /* i386 PIC */
 }
+
+static uint64 ottd_xgetbv(uint reg)
+{
+	uint32 high, low;
+	/* Encoded xgetbv, as older assemblers do not know the instruction. */
+	__asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (low), "=d" (high) : "c" (reg));
+	return ((uint64)high << 32) | low;
+}
 #else
 void ottd_cpuid(int info[4], int type)
 {
 	info[0] = info[1] = info[2] = info[3] = 0;
 }
+
+static uint64 ottd_xgetbv(uint reg)
+{
+	return 0;
+}
 #endif
 
 bool HasCPUIDFlag(uint type, uint index, uint bit)
@@ -137,3 +160,12 @@ bool HasCPUIDFlag(uint type, uint index, uint bit)
 	ottd_cpuid(cpu_info, type);
 	return HasBit(cpu_info[index], bit);
 }
+
+bool HasAVX2Support()
+{
+	/* The OS must have enabled XSAVE and AVX, and support saving the SSE and AVX state. */
+	if (!HasCPUIDFlag(1, 2, 27) || !HasCPUIDFlag(1, 2, 28)) return false;
+	if ((ottd_xgetbv(0) & 0x6) != 0x6) return false;
+
+	return HasCPUIDFlag(7, 1, 5);
+}
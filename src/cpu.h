@@ -34,4 +34,10 @@ void ottd_cpuid(int info[4], int type);
  */
 bool HasCPUIDFlag(uint type, uint index, uint bit);
 
+/**
+ * Check whether the CPU supports AVX2 and the OS saves the AVX registers on context switches.
+ * @return True iff AVX2 instructions can be used.
+ */
+bool HasAVX2Support();
+
 #endif /* CPU_H */
@@ -179,6 +179,7 @@ namespace {
 		PerformanceData(1),                     // PFE_ACC_GL_AIRCRAFT
 		PerformanceData(1),                     // PFE_GL_LANDSCAPE
 		PerformanceData(1),                     // PFE_GL_LINKGRAPH
+		PerformanceData(1),                     // PFE_GL_SCRIPT_GC
 		PerformanceData(GL_RATE),               // PFE_DRAWING
 		PerformanceData(1),                     // PFE_ACC_DRAWWORLD
 		PerformanceData(60.0),                  // PFE_VIDEO
@@ -825,6 +826,7 @@ void ConPrintFramerate()
 		"  GL aircraft ticks",
 		"  GL landscape ticks",
 		"  GL link graph delays",
+		"  GL script garbage collection",
 		"Drawing",
 		"  Viewport drawing",
 		"Video output",
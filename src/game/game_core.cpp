@@ -41,9 +41,11 @@
 	Game::instance->GameLoop();
 	cur_company.Restore();
 
-	/* Occasionally collect garbage */
+	/* Occasionally collect garbage; the collection continues in small steps in the next ticks. */
 	if ((Game::frame_counter & 255) == 0) {
 		Game::instance->CollectGarbage();
+	} else {
+		Game::instance->ContinueGarbageCollection();
 	}
 }
 
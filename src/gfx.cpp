@@ -21,12 +21,15 @@
 #include "network/network_func.h"
 #include "window_func.h"
 #include "newgrf_debug.h"
+#include "console_func.h"
 
 #include "table/palettes.h"
 #include "table/string_colours.h"
 #include "table/sprites.h"
 #include "table/control_codes.h"
 
+#include <chrono>
+
 #include "safeguards.h"
 
 byte _dirkeys;        ///< 1 = left, 2 = up, 4 = right, 8 = down
@@ -42,6 +45,7 @@ bool _right_button_down;    ///< Is right mouse button pressed?
 bool _right_button_clicked; ///< Is right mouse button clicked?
 DrawPixelInfo _screen;
 bool _screen_disable_anim = false;   ///< Disable palette animation (important for 32bpp-anim blitter during giant screenshot)
+bool _headless = false;              ///< The video driver has no screen, so nothing needs to be marked dirty or redrawn.
 bool _exit_game;
 GameMode _game_mode;
 SwitchMode _switch_mode;  ///< The next mainloop command.
@@ -1421,6 +1425,8 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
 	int width;
 	int height;
 
+	if (_headless) return;
+
 	if (left < 0) left = 0;
 	if (top < 0) top = 0;
 	if (right > _screen.width) right = _screen.width;
@@ -1710,3 +1716,49 @@ void SortResolutions(int count)
 {
 	QSortT(_resolutions, count, &compare_res);
 }
+
+/**
+ * Measure how fast the current blitter draws, and print the result to the console.
+ * The whole screen is redrawn, covered by the transparent and the grey colour
+ * mapping, and palette animated, each the given number of times.
+ * @param iterations Number of times to do each.
+ */
+void ConPrintBlitterBenchmark(uint iterations)
+{
+	using namespace std::chrono;
+
+	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
+	if (blitter->GetScreenDepth() == 0 || _screen.dst_ptr == NULL) {
+		IConsoleWarning("The current blitter does not draw anything.");
+		return;
+	}
+	IConsolePrintF(CC_DEFAULT, "Blitter '%s', %dx%d, %u iterations:", blitter->GetName(), _screen.width, _screen.height, iterations);
+
+	high_resolution_clock::time_point start = high_resolution_clock::now();
+	for (uint i = 0; i < iterations; i++) RedrawScreenRect(0, 0, _screen.width, _screen.height);
+	uint64 redraw = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+	start = high_resolution_clock::now();
+	for (uint i = 0; i < iterations; i++) {
+		blitter->DrawColourMappingRect(_screen.dst_ptr, _screen.width, _screen.height, PALETTE_TO_TRANSPARENT);
+		blitter->DrawColourMappingRect(_screen.dst_ptr, _screen.width, _screen.height, PALETTE_NEWSPAPER);
+	}
+	uint64 mapping = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+	IConsolePrintF(CC_DEFAULT, "  redraw screen:       " OTTD_PRINTF64 " us each", (int64)(redraw / max(iterations, 1U)));
+	IConsolePrintF(CC_DEFAULT, "  colour mapping:      " OTTD_PRINTF64 " us each", (int64)(mapping / max(iterations * 2, 1U)));
+
+	if (blitter->UsePaletteAnimation() != Blitter::PALETTE_ANIMATION_BLITTER || _screen_disable_anim) return;
+
+	/* Animate the whole screen; first draw it again so it has animated pixels. */
+	RedrawScreenRect(0, 0, _screen.width, _screen.height);
+	Palette palette = _cur_palette;
+	palette.first_dirty = PALETTE_ANIM_START;
+	palette.count_dirty = PALETTE_ANIM_SIZE;
+
+	start = high_resolution_clock::now();
+	for (uint i = 0; i < iterations; i++) blitter->PaletteAnimate(palette);
+	uint64 animate = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+	IConsolePrintF(CC_DEFAULT, "  palette animation:   " OTTD_PRINTF64 " us each", (int64)(animate / max(iterations, 1U)));
+}
@@ -65,6 +65,7 @@ extern bool _right_button_clicked;
 
 extern DrawPixelInfo _screen;
 extern bool _screen_disable_anim;   ///< Disable palette animation (important for 32bpp-anim blitter during giant screenshot)
+extern bool _headless;              ///< The video driver has no screen, so nothing needs to be marked dirty or redrawn.
 
 extern int _num_resolutions;
 extern Dimension _resolutions[32];
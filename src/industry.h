@@ -22,6 +22,7 @@
 
 typedef Pool<Industry, IndustryID, 64, 64000> IndustryPool;
 extern IndustryPool _industry_pool;
+extern uint16 _industry_counter_ticks;
 
 /**
  * Production level maximum, minimum and default values.
@@ -52,7 +53,7 @@ struct Industry : IndustryPool::PoolItem<&_industry_pool> {
 	byte last_month_pct_transported[INDUSTRY_NUM_OUTPUTS]; ///< percentage transported per cargo in the last full month
 	uint16 last_month_production[INDUSTRY_NUM_OUTPUTS];    ///< total units produced per cargo in the last full month
 	uint16 last_month_transported[INDUSTRY_NUM_OUTPUTS];   ///< total units transported per cargo in the last full month
-	uint16 counter;                                        ///< used for animation and/or production (if available cargo)
+	uint16 counter;                                        ///< used for animation and/or production (if available cargo); offset by #_industry_counter_ticks, see GetCounter()
 
 	IndustryType type;                  ///< type of industry.
 	OwnerByte owner;                    ///< owner of the industry.  Which SHOULD always be (imho) OWNER_NONE
@@ -114,6 +115,15 @@ struct Industry : IndustryPool::PoolItem<&_industry_pool> {
 		return Industry::Get(GetIndustryIndex(tile));
 	}
 
+	/**
+	 * Get the counter used for animation and production. It decreases by one every tick.
+	 * @return The counter.
+	 */
+	inline uint16 GetCounter() const
+	{
+		return this->counter - _industry_counter_ticks;
+	}
+
 	static Industry *GetRandom();
 	static void PostDestructor(size_t index);
 
@@ -161,6 +171,7 @@ protected:
 };
 
 void PlantRandomFarmField(const Industry *i);
+void RebuildIndustrySchedule();
 
 void ReleaseDisastersTargetingIndustry(IndustryID);
 
@@ -57,6 +57,55 @@ void BuildOilRig(TileIndex tile);
 static byte _industry_sound_ctr;
 static TileIndex _industry_sound_tile;
 
+uint16 _industry_counter_ticks; ///< Number of ticks the counters of all industries have been decreased by, see Industry::GetCounter().
+
+static const uint INDUSTRY_SOUND_TICKS = 64; ///< Industries try to play an ambient sound every this many ticks.
+static std::vector<IndustryID> _industry_sound_schedule[INDUSTRY_SOUND_TICKS];        ///< Per tick the industries trying to play a sound, sorted by index.
+static std::vector<IndustryID> _industry_production_schedule[INDUSTRY_PRODUCE_TICKS]; ///< Per tick the industries producing cargo, sorted by index.
+
+/**
+ * Add an industry to the ticks it has something to do in.
+ * @param i The industry.
+ */
+static void ScheduleIndustry(const Industry *i)
+{
+	std::vector<IndustryID> &sound = _industry_sound_schedule[(i->counter + 1) % INDUSTRY_SOUND_TICKS];
+	sound.insert(std::lower_bound(sound.begin(), sound.end(), i->index), i->index);
+	std::vector<IndustryID> &production = _industry_production_schedule[i->counter % INDUSTRY_PRODUCE_TICKS];
+	production.insert(std::lower_bound(production.begin(), production.end(), i->index), i->index);
+}
+
+/**
+ * Remove an industry from the ticks it has something to do in.
+ * @param i The industry.
+ */
+static void UnscheduleIndustry(const Industry *i)
+{
+	std::vector<IndustryID> &sound = _industry_sound_schedule[(i->counter + 1) % INDUSTRY_SOUND_TICKS];
+	std::vector<IndustryID>::iterator it = std::lower_bound(sound.begin(), sound.end(), i->index);
+	if (it != sound.end() && *it == i->index) sound.erase(it);
+	std::vector<IndustryID> &production = _industry_production_schedule[i->counter % INDUSTRY_PRODUCE_TICKS];
+	it = std::lower_bound(production.begin(), production.end(), i->index);
+	if (it != production.end() && *it == i->index) production.erase(it);
+}
+
+/**
+ * Store the actual counter in all industries and rebuild the ticks they have something to do in.
+ * The counters themselves don't change, so this can be done at any time.
+ */
+void RebuildIndustrySchedule()
+{
+	for (uint j = 0; j < INDUSTRY_SOUND_TICKS; j++) _industry_sound_schedule[j].clear();
+	for (uint j = 0; j < INDUSTRY_PRODUCE_TICKS; j++) _industry_production_schedule[j].clear();
+
+	Industry *i;
+	FOR_ALL_INDUSTRIES(i) {
+		i->counter = i->GetCounter();
+		ScheduleIndustry(i);
+	}
+	_industry_counter_ticks = 0;
+}
+
 uint16 Industry::counts[NUM_INDUSTRYTYPES];
 
 IndustrySpec _industry_specs[NUM_INDUSTRYTYPES];
@@ -137,6 +186,8 @@ Industry::~Industry()
 {
 	if (CleaningPool()) return;
 
+	UnscheduleIndustry(this);
+
 	/* Industry can also be destroyed when not fully initialized.
 	 * This means that we do not have to clear tiles either.
 	 * Also we must not decrement industry counts in that case. */
@@ -1114,8 +1165,8 @@ static void ProduceIndustryGoods(Industry *i)
 {
 	const IndustrySpec *indsp = GetIndustrySpec(i->type);
 
-	/* play a sound? */
-	if ((i->counter & 0x3F) == 0) {
+	/* play a sound? The counter has already been decreased for this tick. */
+	if (((i->GetCounter() + 1) & 0x3F) == 0) {
 		uint32 r;
 		uint num;
 		if (Chance16R(1, 14, r) && (num = indsp->number_of_sounds) != 0 && _settings_client.sound.ambient) {
@@ -1125,10 +1176,8 @@ static void ProduceIndustryGoods(Industry *i)
 		}
 	}
 
-	i->counter--;
-
 	/* produce some cargo */
-	if ((i->counter % INDUSTRY_PRODUCE_TICKS) == 0) {
+	if ((i->GetCounter() % INDUSTRY_PRODUCE_TICKS) == 0) {
 		if (HasBit(indsp->callback_mask, CBM_IND_PRODUCTION_256_TICKS)) IndustryProductionCallback(i, 1);
 
 		IndustryBehaviour indbehav = indsp->behaviour;
@@ -1161,7 +1210,7 @@ static void ProduceIndustryGoods(Industry *i)
 			if (cb_res != CALLBACK_FAILED) {
 				cut = ConvertBooleanCallback(indsp->grf_prop.grffile, CBID_INDUSTRY_SPECIAL_EFFECT, cb_res);
 			} else {
-				cut = ((i->counter % INDUSTRY_CUT_TREE_TICKS) == 0);
+				cut = ((i->GetCounter() % INDUSTRY_CUT_TREE_TICKS) == 0);
 			}
 
 			if (cut) ChopLumberMillTrees(i);
@@ -1187,9 +1236,18 @@ void OnTick_Industry()
 
 	if (_game_mode == GM_EDITOR) return;
 
-	Industry *i;
-	FOR_ALL_INDUSTRIES(i) {
-		ProduceIndustryGoods(i);
+	/* Decrease the counters of all industries. */
+	_industry_counter_ticks++;
+
+	/* Only handle the industries that have something to do in this tick, in order of their index.
+	 * An industry never tries to play a sound in the same tick it produces. */
+	const std::vector<IndustryID> &sound = _industry_sound_schedule[_industry_counter_ticks % INDUSTRY_SOUND_TICKS];
+	const std::vector<IndustryID> &production = _industry_production_schedule[_industry_counter_ticks % INDUSTRY_PRODUCE_TICKS];
+	std::vector<IndustryID> due(sound.size() + production.size());
+	std::merge(sound.begin(), sound.end(), production.begin(), production.end(), due.begin());
+
+	for (std::vector<IndustryID>::const_iterator it = due.begin(); it != due.end(); ++it) {
+		ProduceIndustryGoods(Industry::Get(*it));
 	}
 }
 
@@ -1687,7 +1745,8 @@ static void DoCreateNewIndustry(Industry *i, TileIndex tile, IndustryType type,
 
 	uint16 r = Random();
 	i->random_colour = GB(r, 0, 4);
-	i->counter = GB(r, 4, 12);
+	i->counter = GB(r, 4, 12) + _industry_counter_ticks;
+	ScheduleIndustry(i);
 	i->random = initial_random_bits;
 	i->was_cargo_delivered = false;
 	i->last_prod_year = _cur_year;
@@ -2779,6 +2838,7 @@ void InitializeIndustries()
 {
 	Industry::ResetIndustryCounts();
 	_industry_sound_tile = 0;
+	RebuildIndustrySchedule();
 
 	_industry_builder.Reset();
 }
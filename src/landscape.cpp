@@ -33,6 +33,8 @@
 #include "pathfinder/npf/aystar.h"
 #include "saveload/saveload.h"
 #include "framerate_type.h"
+#include "clear_func.h"
+#include "thread/thread.h"
 #include <list>
 #include <set>
 
@@ -797,6 +799,22 @@ CommandCost CmdClearArea(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 
 TileIndex _cur_tileloop_tile;
 
+/** Number of tiles of which the map data is requested before handling them in the tile loop. */
+static const uint TILE_LOOP_BATCH_SIZE = 64;
+
+/**
+ * Hint the processor to start loading the map data of a tile, as it is
+ * going to be accessed soon.
+ * @param tile The tile.
+ */
+static inline void PrefetchTile(TileIndex tile)
+{
+#if defined(__GNUC__)
+	__builtin_prefetch(&_m[tile]);
+	__builtin_prefetch(&_me[tile]);
+#endif
+}
+
 /**
  * Gradually iterate over all tiles on the map, calling their TileLoopProcs once every 256 ticks.
  */
@@ -829,11 +847,25 @@ void RunTileLoop()
 		count--;
 	}
 
-	while (count--) {
-		_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
+	/* The tiles of a tick are scattered over the whole map, so nearly every
+	 * visit is a cache miss. Therefore the tiles are handled in batches: first
+	 * the next tiles of the sequence are determined and their map data is
+	 * requested, then they are handled in the usual order. */
+	TileIndex batch[TILE_LOOP_BATCH_SIZE];
+	while (count != 0) {
+		uint batch_size = min(count, (uint)lengthof(batch));
+		for (uint i = 0; i < batch_size; i++) {
+			batch[i] = tile;
+			PrefetchTile(tile);
+
+			/* Get the next tile in sequence using a Galois LFSR. */
+			tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+		}
 
-		/* Get the next tile in sequence using a Galois LFSR. */
-		tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+		for (uint i = 0; i < batch_size; i++) {
+			_tile_type_procs[GetTileType(batch[i])]->tile_loop_proc(batch[i]);
+		}
+		count -= batch_size;
 	}
 
 	_cur_tileloop_tile = tile;
@@ -971,6 +1003,79 @@ static void GenerateTerrain(int type, uint flag)
 }
 
 
+/** Minimum number of tiles a thread of SettleLandscape handles. */
+static const uint SETTLE_LANDSCAPE_THREAD_THRESHOLD = 65536;
+
+/**
+ * Settle the ground of the clear tiles of a range of rows, except those at the edge of the map.
+ * @param part Unused.
+ * @param begin The first row to settle.
+ * @param end The row after the last one to settle.
+ * @param data Unused.
+ */
+static void SettleLandscapeThread(uint part, uint begin, uint end, void *data)
+{
+	for (uint y = max(begin, 2U); y < min(end, MapMaxY() - 1); y++) {
+		for (uint x = 2; x < MapMaxX() - 1; x++) {
+			TileIndex tile = TileXY(x, y);
+			if (IsTileType(tile, MP_CLEAR)) SettleClearTile(tile);
+		}
+	}
+}
+
+/**
+ * Let the tiles of a newly generated landscape settle, i.e. flood the coasts and
+ * update the ground density and the desert or snow of the clear tiles.
+ *
+ * This used to be done by running the tile loop 256 times, so every tile is
+ * handled once. As the landscape only consists of clear, water and void tiles
+ * at this point, the same can be done in two sweeps over the map: first the
+ * water is flooded, and then the ground of the clear tiles is updated. The
+ * ground of a clear tile only depends on the tile itself and the water around
+ * it, so the second sweep is done by multiple threads. The tiles are handled
+ * in a different order, so the generated map is not exactly the same; the
+ * original behaviour can be restored with the game_creation.settle_landscape
+ * setting.
+ * @param cls The progress to increase, four times.
+ */
+static void SettleLandscape(GenWorldProgress cls)
+{
+	if (!_settings_game.game_creation.settle_landscape) {
+		for (uint i = 0; i != 256; i++) {
+			if ((i % 64) == 0) IncreaseGeneratingWorldProgress(cls);
+			RunTileLoop();
+		}
+		return;
+	}
+
+	IncreaseGeneratingWorldProgress(cls);
+
+	/* Flood the coasts, and handle the tiles at the edge of the map, which might be flooded too. */
+	for (TileIndex tile = 0; tile != MapSize(); tile++) {
+		switch (GetTileType(tile)) {
+			case MP_WATER:
+				TileLoop_Water(tile);
+				break;
+
+			case MP_CLEAR:
+				if (DistanceFromEdge(tile) <= 1) _tile_type_procs[MP_CLEAR]->tile_loop_proc(tile);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	IncreaseGeneratingWorldProgress(cls);
+
+	/* The growth of grass in the scenario editor is random, so the order of the tiles matters there. */
+	uint num_threads = (_game_mode == GM_EDITOR || MapSize() < SETTLE_LANDSCAPE_THREAD_THRESHOLD) ? 1 : GetCPUCoreCount();
+	RunParallel(&SettleLandscapeThread, NULL, MapSizeY(), num_threads, "ottd:settle");
+
+	IncreaseGeneratingWorldProgress(cls);
+	IncreaseGeneratingWorldProgress(cls);
+}
+
 #include "table/genland.h"
 
 static void CreateDesertOrRainForest()
@@ -994,11 +1099,7 @@ static void CreateDesertOrRainForest()
 		}
 	}
 
-	for (uint i = 0; i != 256; i++) {
-		if ((i % 64) == 0) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
-
-		RunTileLoop();
-	}
+	SettleLandscape(GWP_LANDSCAPE);
 
 	for (TileIndex tile = 0; tile != MapSize(); ++tile) {
 		if ((tile % update_freq) == 0) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
@@ -1284,11 +1385,8 @@ static void CreateRivers()
 		}
 	}
 
-	/* Run tile loop to update the ground density. */
-	for (uint i = 0; i != 256; i++) {
-		if (i % 64 == 0) IncreaseGeneratingWorldProgress(GWP_RIVER);
-		RunTileLoop();
-	}
+	/* Update the ground density. */
+	SettleLandscape(GWP_RIVER);
 }
 
 void GenerateLandscape(byte mode)
@@ -14,6 +14,8 @@
 #include "core/alloc_func.hpp"
 #include "water_map.h"
 #include "string_func.h"
+#include "pathfinder/water_regions.h"
+#include "pathfinder/depot_cache.h"
 
 #include "safeguards.h"
 
@@ -63,6 +65,9 @@ void AllocateMap(uint size_x, uint size_y)
 
 	_m = CallocT<Tile>(_map_size);
 	_me = CallocT<TileExtended>(_map_size);
+
+	AllocateWaterRegions();
+	InvalidateNearestDepotCache();
 }
 
 
@@ -44,6 +44,7 @@ void InitializeAirportGui();
 void InitializeDockGui();
 void InitializeObjectGui();
 void InitializeIndustries();
+void InitializeTowns();
 void InitializeObjects();
 void InitializeTrees();
 void InitializeCompanies();
@@ -90,6 +91,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	InitializeObjectGui();
 	InitializeAIGui();
 	InitializeTrees();
+	InitializeTowns();
 	InitializeIndustries();
 	InitializeObjects();
 	InitializeBuildingCounts();
@@ -4811,6 +4811,7 @@ static void NewSpriteGroup(ByteReader *buf)
 			group->num_adjusts = adjusts.Length();
 			group->adjusts = MallocT<DeterministicSpriteGroupAdjust>(group->num_adjusts);
 			MemCpyT(group->adjusts, adjusts.Begin(), group->num_adjusts);
+			group->CompileAdjusts();
 
 			std::vector<DeterministicSpriteGroupRange> ranges;
 			ranges.resize(buf->ReadByte());
@@ -8327,6 +8328,7 @@ void ResetNewGRFData()
 
 	InitializeSoundPool();
 	_spritegroup_pool.CleanPool();
+	ClearVehicleResolveCache();
 }
 
 /**
@@ -24,6 +24,11 @@
 #include "company_base.h"
 #include "newgrf_railtype.h"
 #include "ship.h"
+#include "settings_type.h"
+#include "console_func.h"
+
+#include <map>
+#include <chrono>
 
 #include "safeguards.h"
 
@@ -354,6 +359,9 @@ static byte MapAircraftMovementAction(const Aircraft *v)
 		case VSG_SCOPE_SELF:   return &this->self_scope;
 		case VSG_SCOPE_PARENT: return &this->parent_scope;
 		case VSG_SCOPE_RELATIVE: {
+			/* Other vehicles of the chain are not tracked by the result cache. */
+			this->dependencies |= RD_VOLATILE;
+
 			int32 count = GB(relative, 0, 4);
 			if (this->self_scope.v != NULL && (relative != this->cached_relative_count || count == 0)) {
 				/* Note: This caching only works as long as the VSG_SCOPE_RELATIVE cannot be used in
@@ -445,6 +453,51 @@ static uint32 PositionHelper(const Vehicle *v, bool consecutive)
 	return chain_before | chain_after << 8 | (chain_before + chain_after + consecutive) << 16;
 }
 
+/**
+ * Get the inputs a vehicle variable depends on, besides the state that
+ * invalidates the vehicle's NewGRF cache (consist and cargo changes,
+ * company colours and random bits).
+ * @param variable Variable to check.
+ * @return Dependencies of the variable.
+ */
+static ResolverDependencies GetVehicleVariableDependencies(byte variable)
+{
+	switch (variable) {
+		case 0x25: // Engine GRF ID
+		case 0x40: // Length of consist
+		case 0x41: // Length of same consecutive wagons
+		case 0x42: // Consist cargo information
+		case 0x43: // Company information
+		case 0x47: // Vehicle cargo info
+		case 0x49: // Build year
+		case 0x4D: // Position within articulated vehicle
+		case 0x60: // Count consist's engine ID occurrence
+		case 0x80: // Vehicle type
+		case 0x81: // Vehicle subtype
+		case 0x84: // Index
+		case 0x85:
+		case 0xB9: // Cargo type
+		case 0xBA: // Cargo capacity
+		case 0xBB:
+		case 0xC2: // Max age
+		case 0xC3:
+		case 0xC4: // Build year
+		case 0xC6: // Engine ID
+		case 0xC7:
+		case 0xDA: // Next vehicle in chain
+		case 0xF2: // Cargo subtype
+		case 0xF3: // Vehicle length (trains)
+		case 0xFA: // Random bits
+		case 0xFB: // Triggers
+		case 0xFC: // First vehicle in chain (trains)
+		case 0xFD:
+			return RD_NONE;
+
+		default:
+			return RD_VOLATILE;
+	}
+}
+
 static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object, byte variable, uint32 parameter, bool *available)
 {
 	/* Calculated vehicle parameters */
@@ -911,6 +964,7 @@ static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object,
 		return UINT_MAX;
 	}
 
+	this->ro.dependencies |= GetVehicleVariableDependencies(variable);
 	return VehicleGetVariable(const_cast<Vehicle*>(this->v), this, variable, parameter, available);
 }
 
@@ -929,12 +983,18 @@ static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object,
 
 	uint totalsets = in_motion ? group->num_loaded : group->num_loading;
 
-	if (totalsets == 0) return NULL;
+	const SpriteGroup *result = NULL;
+	if (totalsets != 0) {
+		uint set = (v->cargo.StoredCount() * totalsets) / max((uint16)1, v->cargo_cap);
+		set = min(set, totalsets - 1);
 
-	uint set = (v->cargo.StoredCount() * totalsets) / max((uint16)1, v->cargo_cap);
-	set = min(set, totalsets - 1);
+		result = in_motion ? group->loaded[set] : group->loading[set];
+	}
 
-	return in_motion ? group->loaded[set] : group->loading[set];
+	this->resolved_real_group = group;
+	this->resolved_real_result = result;
+	this->num_real_resolves++;
+	return result;
 }
 
 /**
@@ -964,7 +1024,7 @@ VehicleResolverObject::VehicleResolverObject(EngineID engine_type, const Vehicle
 	self_scope(*this, engine_type, v, info_view),
 	parent_scope(*this, engine_type, ((v != NULL) ? v->First() : v), info_view),
 	relative_scope(*this, engine_type, v, info_view),
-	cached_relative_count(0)
+	cached_relative_count(0), resolved_real_group(NULL), resolved_real_result(NULL), num_real_resolves(0)
 {
 	if (wagon_override == WO_SELF) {
 		this->root_spritegroup = GetWagonOverrideSpriteSet(engine_type, CT_DEFAULT, engine_type);
@@ -992,6 +1052,153 @@ VehicleResolverObject::VehicleResolverObject(EngineID engine_type, const Vehicle
 }
 
 
+/** Identification of a resolved vehicle sprite group chain in the result cache. */
+struct VehicleResolveCacheKey {
+	const SpriteGroup *root; ///< Root sprite group of the chain.
+	VehicleID vehicle;       ///< Vehicle of the self scope.
+	EngineID engine;         ///< Engine of the self scope.
+	CallbackID callback;     ///< Callback being resolved.
+	uint32 callback_param1;  ///< First parameter (var 10) of the callback.
+	uint32 callback_param2;  ///< Second parameter (var 18) of the callback.
+	CargoID cargo_type;      ///< Cargo type of the vehicle; it is changed temporarily while refitting without invalidating the NewGRF cache.
+	byte cargo_subtype;      ///< Cargo subtype of the vehicle, for the same reason.
+	bool info_view;          ///< Whether the vehicle is drawn in an info window.
+
+	bool operator <(const VehicleResolveCacheKey &other) const
+	{
+		if (this->root != other.root) return this->root < other.root;
+		if (this->vehicle != other.vehicle) return this->vehicle < other.vehicle;
+		if (this->engine != other.engine) return this->engine < other.engine;
+		if (this->callback != other.callback) return this->callback < other.callback;
+		if (this->callback_param1 != other.callback_param1) return this->callback_param1 < other.callback_param1;
+		if (this->callback_param2 != other.callback_param2) return this->callback_param2 < other.callback_param2;
+		if (this->cargo_type != other.cargo_type) return this->cargo_type < other.cargo_type;
+		if (this->cargo_subtype != other.cargo_subtype) return this->cargo_subtype < other.cargo_subtype;
+		return this->info_view < other.info_view;
+	}
+};
+
+/** Cached result of resolving a vehicle sprite group chain. */
+struct VehicleResolveCacheEntry {
+	uint32 self_epoch;         ///< Resolve epoch of the vehicle when the result was resolved.
+	uint32 parent_epoch;       ///< Resolve epoch of the front vehicle when the result was resolved.
+	Date date;                 ///< Date the result is valid for, or #INVALID_DATE when it does not depend on the date.
+	const SpriteGroup *result; ///< The resolved sprite group, or the real sprite group when \c real is set.
+	bool real;                 ///< The chain ended in a real sprite group, which depends on the load state and is always resolved again.
+	uint16 callback_result;    ///< Callback result of the resolved sprite group.
+};
+
+typedef std::map<VehicleResolveCacheKey, VehicleResolveCacheEntry> VehicleResolveCache;
+
+static const size_t MAX_VEHICLE_RESOLVE_CACHE_SIZE = 1 << 16; ///< Number of cached results after which the cache is emptied.
+
+static VehicleResolveCache _vehicle_resolve_cache; ///< Cached results of resolving vehicle sprite group chains.
+static uint32 _vehicle_resolve_epoch = 0;          ///< Last resolve epoch handed out to a vehicle.
+
+/** Forget all cached results of vehicle sprite group chains. */
+void ClearVehicleResolveCache()
+{
+	_vehicle_resolve_cache.clear();
+}
+
+/**
+ * Get the resolve epoch of a vehicle, assigning a new one if the vehicle's NewGRF cache was invalidated.
+ * Epochs are unique over all vehicles, so results of deleted vehicles never match.
+ * @param v Vehicle to get the epoch of.
+ * @return The resolve epoch.
+ */
+static uint32 GetResolveEpoch(const Vehicle *v)
+{
+	if (v->grf_cache.resolve_epoch == 0) {
+		if (++_vehicle_resolve_epoch == 0) {
+			/* Wrapped around; make sure no old epoch can be handed out twice. */
+			ClearVehicleResolveCache();
+			Vehicle *u;
+			FOR_ALL_VEHICLES(u) u->grf_cache.resolve_epoch = 0;
+			_vehicle_resolve_epoch = 1;
+		}
+		const_cast<Vehicle *>(v)->grf_cache.resolve_epoch = _vehicle_resolve_epoch;
+	}
+	return v->grf_cache.resolve_epoch;
+}
+
+/**
+ * Resolve the sprite group chain, reusing an earlier result when the result cache is enabled.
+ * A result is reused as long as the vehicle and its front vehicle did not invalidate their
+ * NewGRF cache, and, if it read the date, the date did not change. Chains that read any
+ * other state or have side effects are not cached.
+ * The cache is not saved, so a reused result must always be the same as a fresh one; with
+ * desync debugging enabled this is verified for every reused result.
+ * @param[out] callback_result If not \c NULL, the callback result of the resolved group.
+ * @return The resolved sprite group.
+ * @pre The parent scope is the front vehicle of the self scope.
+ */
+const SpriteGroup *VehicleResolverObject::ResolveCached(uint16 *callback_result)
+{
+	const Vehicle *v = this->self_scope.v;
+	if (!_settings_client.gui.newgrf_resolve_cache || v == NULL) {
+		const SpriteGroup *result = this->Resolve();
+		if (callback_result != NULL) *callback_result = result != NULL ? result->GetCallbackResult() : CALLBACK_FAILED;
+		return result;
+	}
+	assert(this->parent_scope.v == v->First());
+
+	VehicleResolveCacheKey key;
+	key.root = this->root_spritegroup;
+	key.vehicle = v->index;
+	key.engine = this->self_scope.self_type;
+	key.callback = this->callback;
+	key.callback_param1 = this->callback_param1;
+	key.callback_param2 = this->callback_param2;
+	key.cargo_type = v->cargo_type;
+	key.cargo_subtype = v->cargo_subtype;
+	key.info_view = this->self_scope.info_view;
+
+	uint32 self_epoch = GetResolveEpoch(v);
+	uint32 parent_epoch = GetResolveEpoch(v->First());
+
+	VehicleResolveCache::const_iterator it = _vehicle_resolve_cache.find(key);
+	if (it != _vehicle_resolve_cache.end() && it->second.self_epoch == self_epoch && it->second.parent_epoch == parent_epoch &&
+			(it->second.date == INVALID_DATE || it->second.date == _date)) {
+		/* Leave the registers as resolving would have; results writing the output registers are not cached. */
+		extern TemporaryStorageArray<int32, 0x110> _temp_store;
+		_temp_store.ClearChanges();
+
+		const SpriteGroup *result = it->second.real ? this->ResolveReal((const RealSpriteGroup *)it->second.result) : it->second.result;
+		if (_debug_desync_level >= 2) {
+			const SpriteGroup *result2 = this->Resolve();
+			uint16 cb_result2 = result2 != NULL ? result2->GetCallbackResult() : CALLBACK_FAILED;
+			if (result != result2 || it->second.callback_result != cb_result2) {
+				DEBUG(desync, 2, "CACHE ERROR: VehicleResolverObject::ResolveCached() vehicle %d, engine %d, callback %d = [%p, %d], [%p, %d]",
+						v->index, this->self_scope.self_type, this->callback, result, it->second.callback_result, result2, cb_result2);
+			}
+		}
+
+		if (callback_result != NULL) *callback_result = it->second.callback_result;
+		return result;
+	}
+
+	this->num_real_resolves = 0;
+	const SpriteGroup *result = this->Resolve();
+	uint16 cb_result = result != NULL ? result->GetCallbackResult() : CALLBACK_FAILED;
+	if (callback_result != NULL) *callback_result = cb_result;
+
+	/* Only a real sprite group that ends the chain can be resolved again; anything else depends on the load state. */
+	bool real = this->num_real_resolves > 0;
+	if (this->num_real_resolves > 1 || (real && result != this->resolved_real_result)) this->dependencies |= RD_VOLATILE;
+	if (this->dependencies & RD_VOLATILE) return result;
+
+	if (_vehicle_resolve_cache.size() >= MAX_VEHICLE_RESOLVE_CACHE_SIZE) ClearVehicleResolveCache();
+
+	VehicleResolveCacheEntry &entry = _vehicle_resolve_cache[key];
+	entry.self_epoch = self_epoch;
+	entry.parent_epoch = parent_epoch;
+	entry.date = (this->dependencies & RD_DATE) ? _date : INVALID_DATE;
+	entry.result = real ? this->resolved_real_group : result;
+	entry.real = real;
+	entry.callback_result = cb_result;
+	return result;
+}
 
 void GetCustomEngineSprite(EngineID engine, const Vehicle *v, Direction direction, EngineImageType image_type, VehicleSpriteSeq *result)
 {
@@ -1003,7 +1210,7 @@ void GetCustomEngineSprite(EngineID engine, const Vehicle *v, Direction directio
 	for (uint stack = 0; stack < max_stack; ++stack) {
 		object.ResetState();
 		object.callback_param1 = image_type | (stack << 8);
-		const SpriteGroup *group = object.Resolve();
+		const SpriteGroup *group = object.ResolveCached();
 		uint32 reg100 = sprite_stack ? GetRegister(0x100) : 0;
 		if (group != NULL && group->GetNumResults() != 0) {
 			result->seq[result->count].sprite = group->GetResult() + (direction % group->GetNumResults());
@@ -1067,7 +1274,9 @@ bool UsesWagonOverride(const Vehicle *v)
 uint16 GetVehicleCallback(CallbackID callback, uint32 param1, uint32 param2, EngineID engine, const Vehicle *v)
 {
 	VehicleResolverObject object(engine, v, VehicleResolverObject::WO_UNCACHED, false, callback, param1, param2);
-	return object.ResolveCallback();
+	uint16 result;
+	object.ResolveCached(&result);
+	return result;
 }
 
 /**
@@ -1112,6 +1321,7 @@ static void DoTriggerVehicle(Vehicle *v, VehicleTrigger trigger, byte base_rando
 	VehicleResolverObject object(v->engine_type, v, VehicleResolverObject::WO_CACHED, false, CBID_RANDOM_TRIGGER);
 	object.waiting_triggers = v->waiting_triggers | trigger;
 	v->waiting_triggers = object.waiting_triggers; // store now for var 5F
+	v->grf_cache.resolve_epoch = 0; // cached results may depend on the triggers and random bits
 
 	const SpriteGroup *group = object.Resolve();
 	if (group == NULL) return;
@@ -1304,3 +1514,50 @@ void FillNewGRFVehicleCache(const Vehicle *v)
 	/* Make sure really all bits are set. */
 	assert(v->grf_cache.cache_valid == (1 << NCVV_END) - 1);
 }
+
+/**
+ * Resolve the sprite group chains of a vehicle or engine, bypassing the result cache.
+ * @param engine The engine.
+ * @param v The vehicle, or \c NULL for the engine in the purchase list.
+ * @return Number of resolved chains.
+ */
+static uint BenchmarkVehicleResolve(EngineID engine, const Vehicle *v)
+{
+	static const CallbackID callbacks[] = { CBID_NO_CALLBACK, CBID_VEHICLE_VISUAL_EFFECT, CBID_VEHICLE_LENGTH, CBID_VEHICLE_COLOUR_MAPPING };
+
+	for (uint i = 0; i < lengthof(callbacks); i++) {
+		VehicleResolverObject object(engine, v, VehicleResolverObject::WO_CACHED, false, callbacks[i]);
+		if (callbacks[i] == CBID_NO_CALLBACK) object.callback_param1 = v == NULL ? EIT_PURCHASE : EIT_ON_MAP;
+		object.Resolve();
+	}
+	return lengthof(callbacks);
+}
+
+/**
+ * Measure how fast the sprite group chains of the engines and vehicles with NewGRF graphics are
+ * resolved, and print the result to the console. The sprite and a few callbacks are resolved for
+ * every engine in the purchase list and every vehicle in the game.
+ * @param iterations Number of times to resolve all of them.
+ */
+void ConPrintNewGRFBenchmark(uint iterations)
+{
+	using namespace std::chrono;
+	high_resolution_clock::time_point start = high_resolution_clock::now();
+
+	uint resolves = 0;
+	for (uint i = 0; i < iterations; i++) {
+		const Engine *e;
+		FOR_ALL_ENGINES(e) {
+			if (e->GetGRF() != NULL) resolves += BenchmarkVehicleResolve(e->index, NULL);
+		}
+
+		const Vehicle *v;
+		FOR_ALL_VEHICLES(v) {
+			if (v->type < VEH_COMPANY_END && v->GetGRF() != NULL) resolves += BenchmarkVehicleResolve(v->engine_type, v);
+		}
+	}
+
+	uint64 us = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+	IConsolePrintF(CC_DEFAULT, "Resolved %u sprite group chains in " OTTD_PRINTF64 ".%03d ms", resolves, (int64)(us / 1000), (int)(us % 1000));
+	if (resolves != 0) IConsolePrintF(CC_DEFAULT, "Average per chain: " OTTD_PRINTF64 " ns", (int64)(us * 1000 / resolves));
+}
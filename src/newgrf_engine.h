@@ -61,14 +61,22 @@ struct VehicleResolverObject : public ResolverObject {
 	VehicleScopeResolver relative_scope; ///< Scope resolver for an other vehicle in the chain.
 	byte cached_relative_count;          ///< Relative position of the other vehicle.
 
+	mutable const RealSpriteGroup *resolved_real_group; ///< Real sprite group most recently passed to #ResolveReal.
+	mutable const SpriteGroup *resolved_real_result;    ///< Result of resolving #resolved_real_group.
+	mutable uint num_real_resolves;                     ///< Number of real sprite groups resolved by #ResolveCached.
+
 	VehicleResolverObject(EngineID engine_type, const Vehicle *v, WagonOverride wagon_override, bool info_view = false,
 			CallbackID callback = CBID_NO_CALLBACK, uint32 callback_param1 = 0, uint32 callback_param2 = 0);
 
 	/* virtual */ ScopeResolver *GetScope(VarSpriteGroupScope scope = VSG_SCOPE_SELF, byte relative = 0);
 
 	/* virtual */ const SpriteGroup *ResolveReal(const RealSpriteGroup *group) const;
+
+	const SpriteGroup *ResolveCached(uint16 *callback_result = NULL);
 };
 
+void ClearVehicleResolveCache();
+
 static const uint TRAININFO_DEFAULT_VEHICLE_WIDTH   = 29;
 static const uint ROADVEHINFO_DEFAULT_VEHICLE_WIDTH = 32;
 static const uint VEHICLEINFO_FULL_VEHICLE_WIDTH    = 32;
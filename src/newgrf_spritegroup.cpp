@@ -59,13 +59,49 @@ RandomizedSpriteGroup::~RandomizedSpriteGroup()
 	free(this->groups);
 }
 
-static inline uint32 GetVariable(const ResolverObject &object, ScopeResolver *scope, byte variable, uint32 parameter, bool *available)
+/**
+ * Get the inputs a global variable (common with Action7/9/D) depends on.
+ * Variables that are not known to be constant while the NewGRFs are loaded, or to only
+ * depend on the date, are volatile; e.g. settings that can be changed in game.
+ * @param variable Variable to check.
+ * @return Dependencies of the variable.
+ */
+static ResolverDependencies GetGlobalVariableDependencies(byte variable)
+{
+	switch (variable) {
+		case 0x03: // current climate
+		case 0x0B: // TTDPatch version
+		case 0x0D: // TTD version
+		case 0x0E: // Y-offset for train sprites
+		case 0x11: // current rail tool type
+		case 0x1A: // always -1
+		case 0x1B: // display options
+		case 0x1D: // TTD platform
+		case 0x1E: // miscellaneous GRF features
+		case 0x21: // OpenTTD version
+		case 0x22: // difficulty level
+			return RD_NONE;
+
+		case 0x00: // current date
+		case 0x01: // current year
+		case 0x02: // detailed date information
+		case 0x23: // long format date
+		case 0x24: // long format year
+			return RD_DATE;
+
+		default:
+			return RD_VOLATILE;
+	}
+}
+
+static inline uint32 GetVariable(ResolverObject &object, ScopeResolver *scope, byte variable, uint32 parameter, bool *available)
 {
 	uint32 value;
 	switch (variable) {
 		case 0x0C: return object.callback;
 		case 0x10: return object.callback_param1;
 		case 0x18: return object.callback_param2;
+		case 0x1A: return UINT_MAX; // Often used to load constants, so skip the generic lookup.
 		case 0x1C: return object.last_value;
 
 		case 0x5F: return (scope->GetRandomBits() << 8) | scope->GetTriggers();
@@ -78,7 +114,10 @@ static inline uint32 GetVariable(const ResolverObject &object, ScopeResolver *sc
 
 		default:
 			/* First handle variables common with Action7/9/D */
-			if (variable < 0x40 && GetGlobalVariable(variable, &value, object.grffile)) return value;
+			if (variable < 0x40 && GetGlobalVariable(variable, &value, object.grffile)) {
+				object.dependencies |= GetGlobalVariableDependencies(variable);
+				return value;
+			}
 			/* Not a common variable, so evaluate the feature specific variables */
 			return scope->GetVariable(variable, parameter, available);
 	}
@@ -144,10 +183,10 @@ static inline uint32 GetVariable(const ResolverObject &object, ScopeResolver *sc
 	return &this->default_scope;
 }
 
-/* Evaluate an adjustment for a variable of the given size.
+/* Evaluate the operand of an adjustment for a variable of the given size.
  * U is the unsigned type and S is the signed type to use. */
 template <typename U, typename S>
-static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver *scope, U last_value, uint32 value)
+static inline uint32 EvalAdjustOperandT(const DeterministicSpriteGroupAdjust *adjust, uint32 value)
 {
 	value >>= adjust->shift_num;
 	value  &= adjust->and_mask;
@@ -158,6 +197,14 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver
 		case DSGA_TYPE_NONE: break;
 	}
 
+	return value;
+}
+
+/* Apply the operation of an adjustment for a variable of the given size to its evaluated operand.
+ * U is the unsigned type and S is the signed type to use. */
+template <typename U, typename S>
+static inline U EvalAdjustOperationT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver *scope, U last_value, uint32 value)
+{
 	switch (adjust->operation) {
 		case DSGA_OP_ADD:  return last_value + value;
 		case DSGA_OP_SUB:  return last_value - value;
@@ -173,9 +220,13 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver
 		case DSGA_OP_AND:  return last_value & value;
 		case DSGA_OP_OR:   return last_value | value;
 		case DSGA_OP_XOR:  return last_value ^ value;
-		case DSGA_OP_STO:  _temp_store.StoreValue((U)value, (S)last_value); return last_value;
+		case DSGA_OP_STO:
+			/* Registers 0x100 and up are read by the caller after resolving. */
+			if ((U)value >= 0x100) scope->ro.dependencies |= RD_VOLATILE;
+			_temp_store.StoreValue((U)value, (S)last_value);
+			return last_value;
 		case DSGA_OP_RST:  return value;
-		case DSGA_OP_STOP: scope->StorePSA((U)value, (S)last_value); return last_value;
+		case DSGA_OP_STOP: scope->ro.dependencies |= RD_VOLATILE; scope->StorePSA((U)value, (S)last_value); return last_value;
 		case DSGA_OP_ROR:  return ROR<uint32>((U)last_value, (U)value & 0x1F); // mask 'value' to 5 bits, which should behave the same on all architectures.
 		case DSGA_OP_SCMP: return ((S)last_value == (S)value) ? 1 : ((S)last_value < (S)value ? 0 : 2);
 		case DSGA_OP_UCMP: return ((U)last_value == (U)value) ? 1 : ((U)last_value < (U)value ? 0 : 2);
@@ -186,56 +237,193 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver
 	}
 }
 
+/* Evaluate an adjustment for a variable of the given size.
+ * U is the unsigned type and S is the signed type to use. */
+template <typename U, typename S>
+static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver *scope, U last_value, uint32 value)
+{
+	return EvalAdjustOperationT<U, S>(adjust, scope, last_value, EvalAdjustOperandT<U, S>(adjust, value));
+}
+
+
+/**
+ * Fold the adjusts at the start of the chain that only operate on constants into a single adjust.
+ * Constants are loaded from variable 1A, which is always -1; chains that return a fixed
+ * (callback) result consist of nothing else. Adjusts with side effects are never folded.
+ */
+void DeterministicSpriteGroup::FoldConstantAdjusts()
+{
+	uint32 value = 0;
+	uint folded = 0;
+	for (; folded < this->num_adjusts; folded++) {
+		const DeterministicSpriteGroupAdjust *adjust = &this->adjusts[folded];
+		if (adjust->variable != 0x1A) break;
+		if (adjust->operation == DSGA_OP_STO || adjust->operation == DSGA_OP_STOP) break;
+		if (adjust->type != DSGA_TYPE_NONE && adjust->divmod_val == 0) break;
+
+		switch (this->size) {
+			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, NULL, value, UINT_MAX); break;
+			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, NULL, value, UINT_MAX); break;
+			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, NULL, value, UINT_MAX); break;
+			default: NOT_REACHED();
+		}
+	}
+	if (folded == 0) return;
+
+	/* Replace the folded adjusts by one loading the resulting constant. */
+	DeterministicSpriteGroupAdjust *adjust = &this->adjusts[0];
+	adjust->operation  = DSGA_OP_ADD;
+	adjust->type       = DSGA_TYPE_NONE;
+	adjust->variable   = 0x1A;
+	adjust->parameter  = 0;
+	adjust->shift_num  = 0;
+	adjust->and_mask   = value;
+	adjust->add_val    = 0;
+	adjust->divmod_val = 0;
+	adjust->subroutine = NULL;
+
+	MemMoveT(this->adjusts + 1, this->adjusts + folded, this->num_adjusts - folded);
+	this->num_adjusts -= folded - 1;
+}
+
+/**
+ * Lower the adjusts of the group into the form they are evaluated in.
+ * Leading constant adjusts are folded into one, the operands of all other
+ * constant adjusts are evaluated in advance, and the variables that do not
+ * depend on the scope are marked so they are read without the generic lookup.
+ * @note To be called once after loading the adjusts of the group.
+ */
+void DeterministicSpriteGroup::CompileAdjusts()
+{
+	this->FoldConstantAdjusts();
+
+	for (uint i = 0; i < this->num_adjusts; i++) {
+		DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
+		switch (adjust->variable) {
+			case 0x0C: adjust->source = DSGAS_CALLBACK;        break;
+			case 0x10: adjust->source = DSGAS_CALLBACK_PARAM1; break;
+			case 0x18: adjust->source = DSGAS_CALLBACK_PARAM2; break;
+			case 0x1C: adjust->source = DSGAS_LAST_VALUE;      break;
+			case 0x7B: adjust->source = DSGAS_INDIRECT;        break;
+			case 0x7D: adjust->source = DSGAS_TEMP_STORE;      break;
+			case 0x7E: adjust->source = DSGAS_SUBROUTINE;      break;
+
+			case 0x1A: {
+				/* A division by a constant zero is left to happen while resolving, as it always did. */
+				if (adjust->type != DSGA_TYPE_NONE && adjust->divmod_val == 0) {
+					adjust->source = DSGAS_VARIABLE;
+					break;
+				}
+
+				uint32 value;
+				switch (this->size) {
+					case DSG_SIZE_BYTE:  value = EvalAdjustOperandT<uint8,  int8> (adjust, UINT_MAX); break;
+					case DSG_SIZE_WORD:  value = EvalAdjustOperandT<uint16, int16>(adjust, UINT_MAX); break;
+					case DSG_SIZE_DWORD: value = EvalAdjustOperandT<uint32, int32>(adjust, UINT_MAX); break;
+					default: NOT_REACHED();
+				}
+				adjust->source   = DSGAS_CONSTANT;
+				adjust->type     = DSGA_TYPE_NONE;
+				adjust->shift_num = 0;
+				adjust->and_mask = value;
+				break;
+			}
+
+			default: adjust->source = DSGAS_VARIABLE; break;
+		}
+	}
+}
 
 static bool RangeHighComparator(const DeterministicSpriteGroupRange& range, uint32 value)
 {
 	return range.high < value;
 }
 
-const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
+/**
+ * Evaluate the adjusts of the group for a variable of the given size.
+ * U is the unsigned type and S is the signed type to use.
+ * @param object The resolver object.
+ * @param scope The scope to read the variables of.
+ * @param[out] result The value of the last adjust.
+ * @return False if a variable was not available.
+ */
+template <typename U, typename S>
+bool DeterministicSpriteGroup::EvalAdjusts(ResolverObject &object, ScopeResolver *scope, uint32 *result) const
 {
 	uint32 last_value = 0;
 	uint32 value = 0;
-	uint i;
-
-	ScopeResolver *scope = object.GetScope(this->var_scope);
 
-	for (i = 0; i < this->num_adjusts; i++) {
-		DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
+	for (uint i = 0; i < this->num_adjusts; i++) {
+		const DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
 
 		/* Try to get the variable. We shall assume it is available, unless told otherwise. */
 		bool available = true;
-		if (adjust->variable == 0x7E) {
-			const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust->subroutine, object, false);
-			if (subgroup == NULL) {
-				value = CALLBACK_FAILED;
-			} else {
-				value = subgroup->GetCallbackResult();
+		switch (adjust->source) {
+			case DSGAS_CONSTANT:
+				/* The operand was evaluated when the group was loaded. */
+				value = EvalAdjustOperationT<U, S>(adjust, scope, last_value, adjust->and_mask);
+				last_value = value;
+				continue;
+
+			case DSGAS_CALLBACK:        value = object.callback; break;
+			case DSGAS_CALLBACK_PARAM1: value = object.callback_param1; break;
+			case DSGAS_CALLBACK_PARAM2: value = object.callback_param2; break;
+			case DSGAS_LAST_VALUE:      value = object.last_value; break;
+			case DSGAS_TEMP_STORE:      value = _temp_store.GetValue(adjust->parameter); break;
+
+			case DSGAS_SUBROUTINE: {
+				const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust->subroutine, object, false);
+				if (subgroup == NULL) {
+					value = CALLBACK_FAILED;
+				} else {
+					value = subgroup->GetCallbackResult();
+				}
+
+				/* Note: 'last_value' and 'reseed' are shared between the main chain and the procedure */
+				break;
 			}
 
-			/* Note: 'last_value' and 'reseed' are shared between the main chain and the procedure */
-		} else if (adjust->variable == 0x7B) {
-			value = GetVariable(object, scope, adjust->parameter, last_value, &available);
-		} else {
-			value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
-		}
+			case DSGAS_INDIRECT:
+				value = GetVariable(object, scope, adjust->parameter, last_value, &available);
+				break;
 
-		if (!available) {
-			/* Unsupported variable: skip further processing and return either
-			 * the group from the first range or the default group. */
-			return SpriteGroup::Resolve(this->error_group, object, false);
+			default:
+				value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
+				break;
 		}
 
-		switch (this->size) {
-			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value); break;
-			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value); break;
-			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value); break;
-			default: NOT_REACHED();
-		}
+		/* Unsupported variable: skip further processing. */
+		if (!available) return false;
+
+		value = EvalAdjustT<U, S>(adjust, scope, last_value, value);
 		last_value = value;
 	}
 
-	object.last_value = last_value;
+	*result = value;
+	return true;
+}
+
+const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
+{
+	uint32 value;
+	uint i;
+
+	ScopeResolver *scope = object.GetScope(this->var_scope);
+
+	bool available;
+	switch (this->size) {
+		case DSG_SIZE_BYTE:  available = this->EvalAdjusts<uint8,  int8> (object, scope, &value); break;
+		case DSG_SIZE_WORD:  available = this->EvalAdjusts<uint16, int16>(object, scope, &value); break;
+		case DSG_SIZE_DWORD: available = this->EvalAdjusts<uint32, int32>(object, scope, &value); break;
+		default: NOT_REACHED();
+	}
+
+	if (!available) {
+		/* Unsupported variable: return either the group from the first range or the default group. */
+		return SpriteGroup::Resolve(this->error_group, object, false);
+	}
+
+	object.last_value = value;
 
 	if (this->calculated_result) {
 		/* nvar == 0 is a special case -- we turn our value into a callback result */
@@ -271,6 +459,7 @@ const SpriteGroup *RandomizedSpriteGroup::Resolve(ResolverObject &object) const
 		byte match = this->triggers & object.waiting_triggers;
 		bool res = (this->cmp_mode == RSG_CMP_ANY) ? (match != 0) : (match == this->triggers);
 
+		object.dependencies |= RD_VOLATILE;
 		if (res) {
 			object.used_triggers |= match;
 			object.reseed[this->var_scope] |= (this->num_groups - 1) << this->lowest_randbit;
@@ -48,6 +48,7 @@ enum SpriteGroupType {
 struct SpriteGroup;
 typedef uint32 SpriteGroupID;
 struct ResolverObject;
+struct ScopeResolver;
 
 /* SPRITE_WIDTH is 24. ECS has roughly 30 sprite groups per real sprite.
  * Adding an 'extra' margin would be assuming 64 sprite groups per real
@@ -147,6 +148,19 @@ enum DeterministicSpriteGroupAdjustOperation {
 	DSGA_OP_SAR,  ///< (signed) a >> b
 };
 
+/** Where the operand of an adjust comes from; determined when the group is loaded. */
+enum DeterministicSpriteGroupAdjustSource {
+	DSGAS_VARIABLE,        ///< Any other variable, read through the scope.
+	DSGAS_CONSTANT,        ///< A constant (variable 1A), already shifted, masked and divided; kept in \c and_mask.
+	DSGAS_CALLBACK,        ///< Variable 0C, the callback.
+	DSGAS_CALLBACK_PARAM1, ///< Variable 10, the first callback parameter.
+	DSGAS_CALLBACK_PARAM2, ///< Variable 18, the second callback parameter.
+	DSGAS_LAST_VALUE,      ///< Variable 1C, the last computed value of the resolver.
+	DSGAS_TEMP_STORE,      ///< Variable 7D, a temporary register.
+	DSGAS_SUBROUTINE,      ///< Variable 7E, the callback result of a procedure.
+	DSGAS_INDIRECT,        ///< Variable 7B, a variable with the last value as parameter.
+};
+typedef SimpleTinyEnumT<DeterministicSpriteGroupAdjustSource, byte> DeterministicSpriteGroupAdjustSourceByte;
 
 struct DeterministicSpriteGroupAdjust {
 	DeterministicSpriteGroupAdjustOperation operation;
@@ -154,6 +168,7 @@ struct DeterministicSpriteGroupAdjust {
 	byte variable;
 	byte parameter; ///< Used for variables between 0x60 and 0x7F inclusive.
 	byte shift_num;
+	DeterministicSpriteGroupAdjustSourceByte source; ///< Where the operand comes from.
 	uint32 and_mask;
 	uint32 add_val;
 	uint32 divmod_val;
@@ -185,8 +200,14 @@ struct DeterministicSpriteGroup : SpriteGroup {
 
 	const SpriteGroup *error_group; // was first range, before sorting ranges
 
+	void CompileAdjusts();
+
 protected:
 	const SpriteGroup *Resolve(ResolverObject &object) const;
+
+private:
+	void FoldConstantAdjusts();
+	template <typename U, typename S> bool EvalAdjusts(ResolverObject &object, ScopeResolver *scope, uint32 *result) const;
 };
 
 enum RandomizedSpriteGroupCompareMode {
@@ -288,6 +309,17 @@ struct IndustryProductionSpriteGroup : SpriteGroup {
 
 };
 
+/**
+ * Inputs of a resolved #SpriteGroup-chain, besides the state of the resolved object itself.
+ * These are collected while resolving, so the result can be cached until one of the inputs changes.
+ */
+enum ResolverDependencies {
+	RD_NONE     = 0,      ///< Only depends on the resolved object and the callback parameters.
+	RD_DATE     = 1 << 0, ///< Depends on the current date.
+	RD_VOLATILE = 1 << 1, ///< Depends on state that is not tracked, or has side effects; can not be cached.
+};
+DECLARE_ENUM_AS_BIT_SET(ResolverDependencies)
+
 /**
  * Interface to query and set values specific to a single #VarSpriteGroupScope (action 2 scope).
  *
@@ -336,6 +368,7 @@ struct ResolverObject {
 	uint32 callback_param2;     ///< Second parameter (var 18) of the callback.
 
 	uint32 last_value;          ///< Result of most recent DeterministicSpriteGroup (including procedure calls)
+	ResolverDependencies dependencies; ///< Inputs read while resolving, see #ResolverDependencies.
 
 	uint32 waiting_triggers;    ///< Waiting triggers to be used by any rerandomisation. (scope independent)
 	uint32 used_triggers;       ///< Subset of cur_triggers, which actually triggered some rerandomisation. (scope independent)
@@ -396,6 +429,7 @@ struct ResolverObject {
 	void ResetState()
 	{
 		this->last_value = 0;
+		this->dependencies = RD_NONE;
 		this->waiting_triggers = 0;
 		this->used_triggers = 0;
 		memset(this->reseed, 0, sizeof(this->reseed));
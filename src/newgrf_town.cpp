@@ -50,7 +50,7 @@
 		case 0x81: return GB(this->t->xy, 8, 8);
 		case 0x82: return ClampToU16(this->t->cache.population);
 		case 0x83: return GB(ClampToU16(this->t->cache.population), 8, 8);
-		case 0x8A: return this->t->grow_counter / TOWN_GROWTH_TICKS;
+		case 0x8A: return this->t->GetGrowCounter() / TOWN_GROWTH_TICKS;
 		case 0x92: return this->t->flags;  // In original game, 0x92 and 0x93 are really one word. Since flags is a byte, this is to adjust
 		case 0x93: return 0;
 		case 0x94: return ClampToU16(this->t->cache.squared_town_zone_radius[0]);
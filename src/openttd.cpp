@@ -779,6 +779,9 @@ int openttd_main(int argc, char *argv[])
 	DriverFactoryBase::SelectDriver(videodriver, Driver::DT_VIDEO);
 	free(videodriver);
 
+	/* Without a screen, or a blitter that draws on it, there is nothing to mark dirty or redraw. */
+	_headless = !VideoDriver::GetInstance()->HasGUI() && BlitterFactory::GetCurrentBlitter()->GetScreenDepth() == 0;
+
 	InitializeSpriteSorter();
 
 	/* Initialize the zoom level of the screen to normal */
@@ -1326,6 +1329,7 @@ static void CheckCaches()
 	/* Check whether the caches are still valid */
 	FOR_ALL_VEHICLES(v) {
 		byte buff[sizeof(VehicleCargoList)];
+		v->cargo.ApplyPendingAge();
 		memcpy(buff, &v->cargo, sizeof(VehicleCargoList));
 		v->cargo.InvalidateCache();
 		assert(memcmp(&v->cargo, buff, sizeof(VehicleCargoList)) == 0);
@@ -1349,6 +1353,9 @@ static void CheckCaches()
  */
 void StateGameLoop()
 {
+	/* Game scripts also run, and collect garbage, while the game is paused. */
+	PerformanceAccumulator::Reset(PFE_GL_SCRIPT_GC);
+
 	/* don't execute the state loop during pause */
 	if (_pause_mode != PM_UNPAUSED) {
 		PerformanceMeasurer::Paused(PFE_GAMELOOP);
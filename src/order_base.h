@@ -15,6 +15,7 @@
 #include "order_type.h"
 #include "core/pool_type.hpp"
 #include "core/bitmath_func.hpp"
+#include "core/smallvec_type.hpp"
 #include "cargo_type.h"
 #include "depot_type.h"
 #include "station_type.h"
@@ -245,6 +246,18 @@ public:
 void InsertOrder(Vehicle *v, Order *new_o, VehicleOrderID sel_ord);
 void DeleteOrder(Vehicle *v, VehicleOrderID sel_ord);
 
+/** Kinds of orders tracked by the reverse index of order destinations. */
+enum OrderDestinationKind {
+	ODK_STATION,       ///< #OT_GOTO_STATION or #OT_GOTO_WAYPOINT order.
+	ODK_IMPLICIT,      ///< #OT_IMPLICIT order.
+	ODK_DEPOT,         ///< #OT_GOTO_DEPOT order to a specific depot (or hangar).
+	ODK_NEAREST_DEPOT, ///< #OT_GOTO_DEPOT order to the nearest depot.
+	ODK_END,           ///< End marker.
+};
+
+void RebuildOrderDestinationIndex();
+void FindVehiclesWithOrderDestination(uint kinds, DestinationID destination, SmallVector<const Vehicle *, 32> *vehicles);
+
 /**
  * Shared order list linking together the linked list of orders and the list
  *  of vehicles sharing this order list.
@@ -278,8 +291,7 @@ public:
 	 */
 	OrderList(Order *chain, Vehicle *v) { this->Initialize(chain, v); }
 
-	/** Destructor. Invalidates OrderList for re-usage by the pool. */
-	~OrderList() {}
+	~OrderList();
 
 	void Initialize(Order *chain, Vehicle *v);
 
@@ -29,6 +29,10 @@
 #include "company_base.h"
 #include "order_backup.h"
 #include "cheat_type.h"
+#include "core/sort_func.hpp"
+
+#include <map>
+#include <set>
 
 #include "table/strings.h"
 
@@ -45,6 +49,124 @@ INSTANTIATE_POOL_METHODS(Order)
 OrderListPool _orderlist_pool("OrderList");
 INSTANTIATE_POOL_METHODS(OrderList)
 
+/** Number of orders of each order list that go to a single destination. */
+typedef std::map<OrderListID, uint> OrderListDestinationCount;
+/** Reverse index from (kind, destination) keys to the order lists going there. */
+typedef std::map<uint32, OrderListDestinationCount> OrderDestinationIndex;
+
+/** Reverse index of order destinations, see #GetOrderDestinationKey. */
+static OrderDestinationIndex _order_destination_index;
+
+/**
+ * Get the key of an order in the order destination index.
+ * @param o The order to get the key for.
+ * @return The key of the order, or UINT32_MAX if the order is not indexed.
+ */
+static uint32 GetOrderDestinationKey(const Order *o)
+{
+	OrderDestinationKind kind;
+	switch (o->GetType()) {
+		case OT_GOTO_STATION:
+		case OT_GOTO_WAYPOINT: kind = ODK_STATION; break;
+		case OT_IMPLICIT:      kind = ODK_IMPLICIT; break;
+		case OT_GOTO_DEPOT:    kind = (o->GetDepotActionType() & ODATFB_NEAREST_DEPOT) ? ODK_NEAREST_DEPOT : ODK_DEPOT; break;
+		default: return UINT32_MAX;
+	}
+	return kind << 16 | o->GetDestination();
+}
+
+/**
+ * Add an order of an order list to the order destination index.
+ * @param list The order list the order is part of.
+ * @param o The order to add.
+ */
+static void RegisterOrderDestination(const OrderList *list, const Order *o)
+{
+	uint32 key = GetOrderDestinationKey(o);
+	if (key == UINT32_MAX) return;
+	_order_destination_index[key][list->index]++;
+}
+
+/**
+ * Remove an order of an order list from the order destination index.
+ * @param list The order list the order is part of.
+ * @param o The order to remove.
+ */
+static void UnregisterOrderDestination(const OrderList *list, const Order *o)
+{
+	uint32 key = GetOrderDestinationKey(o);
+	if (key == UINT32_MAX) return;
+
+	/* While loading a savegame order lists are not yet registered; the index is rebuilt afterwards. */
+	OrderDestinationIndex::iterator it = _order_destination_index.find(key);
+	if (it == _order_destination_index.end()) return;
+	OrderListDestinationCount::iterator count = it->second.find(list->index);
+	if (count == it->second.end()) return;
+
+	if (--count->second == 0) {
+		it->second.erase(count);
+		if (it->second.empty()) _order_destination_index.erase(it);
+	}
+}
+
+/**
+ * Rebuild the order destination index from all order lists.
+ * Must be called after loading a savegame.
+ */
+void RebuildOrderDestinationIndex()
+{
+	_order_destination_index.clear();
+
+	const OrderList *list;
+	FOR_ALL_ORDER_LISTS(list) {
+		for (const Order *o = list->GetFirstOrder(); o != NULL; o = o->next) {
+			RegisterOrderDestination(list, o);
+		}
+	}
+}
+
+/**
+ * Sort vehicles by their index.
+ * @param ap First vehicle pointer.
+ * @param bp Second vehicle pointer.
+ * @return Comparison value.
+ */
+static int CDECL VehicleIndexSorter(const Vehicle * const *ap, const Vehicle * const *bp)
+{
+	return (int)(*ap)->index - (int)(*bp)->index;
+}
+
+/**
+ * Get all primary vehicles which have an order to the given destination in their order list.
+ * This only visits the order lists going to the destination, instead of all vehicles and orders.
+ * @param kinds Bitmask of #OrderDestinationKind to consider.
+ * @param destination The destination to look for.
+ * @param[out] vehicles The vehicles are appended to this list, sorted by vehicle index.
+ */
+void FindVehiclesWithOrderDestination(uint kinds, DestinationID destination, SmallVector<const Vehicle *, 32> *vehicles)
+{
+	uint first = vehicles->Length();
+
+	std::set<OrderListID> seen;
+	for (uint kind = 0; kind < ODK_END; kind++) {
+		if (!HasBit(kinds, kind)) continue;
+
+		OrderDestinationIndex::const_iterator it = _order_destination_index.find(kind << 16 | destination);
+		if (it == _order_destination_index.end()) continue;
+
+		for (OrderListDestinationCount::const_iterator count = it->second.begin(); count != it->second.end(); ++count) {
+			if (!seen.insert(count->first).second) continue;
+
+			for (const Vehicle *v = OrderList::Get(count->first)->GetFirstSharedVehicle(); v != NULL; v = v->NextShared()) {
+				*vehicles->Append() = v;
+			}
+		}
+	}
+
+	/* Keep the order of a walk over all vehicles. */
+	QSortT(vehicles->Begin() + first, vehicles->Length() - first, &VehicleIndexSorter);
+}
+
 /** Clean everything up. */
 Order::~Order()
 {
@@ -306,6 +428,7 @@ void OrderList::Initialize(Order *chain, Vehicle *v)
 		if (!o->IsType(OT_IMPLICIT)) ++this->num_manual_orders;
 		this->timetable_duration += o->GetTimetabledWait() + o->GetTimetabledTravel();
 		this->total_duration += o->GetWaitTime() + o->GetTravelTime();
+		RegisterOrderDestination(this, o);
 	}
 
 	for (Vehicle *u = this->first_shared->PreviousShared(); u != NULL; u = u->PreviousShared()) {
@@ -316,6 +439,13 @@ void OrderList::Initialize(Order *chain, Vehicle *v)
 	for (const Vehicle *u = v->NextShared(); u != NULL; u = u->NextShared()) ++this->num_vehicles;
 }
 
+/** Destructor. Invalidates OrderList for re-usage by the pool. */
+OrderList::~OrderList()
+{
+	/* All order lists are thrown away, so nothing is left to index. */
+	if (CleaningPool()) _order_destination_index.clear();
+}
+
 /**
  * Free a complete order chain.
  * @param keep_orderlist If this is true only delete the orders, otherwise also delete the OrderList.
@@ -326,6 +456,7 @@ void OrderList::FreeChain(bool keep_orderlist)
 	Order *next;
 	for (Order *o = this->first; o != NULL; o = next) {
 		next = o->next;
+		UnregisterOrderDestination(this, o);
 		delete o;
 	}
 
@@ -482,6 +613,7 @@ void OrderList::InsertOrderAt(Order *new_order, int index)
 	if (!new_order->IsType(OT_IMPLICIT)) ++this->num_manual_orders;
 	this->timetable_duration += new_order->GetTimetabledWait() + new_order->GetTimetabledTravel();
 	this->total_duration += new_order->GetWaitTime() + new_order->GetTravelTime();
+	RegisterOrderDestination(this, new_order);
 
 	/* We can visit oil rigs and buoys that are not our own. They will be shown in
 	 * the list of stations. So, we need to invalidate that window if needed. */
@@ -515,6 +647,7 @@ void OrderList::DeleteOrderAt(int index)
 	if (!to_remove->IsType(OT_IMPLICIT)) --this->num_manual_orders;
 	this->timetable_duration -= (to_remove->GetTimetabledWait() + to_remove->GetTimetabledTravel());
 	this->total_duration -= (to_remove->GetWaitTime() + to_remove->GetTravelTime());
+	UnregisterOrderDestination(this, to_remove);
 	delete to_remove;
 }
 
@@ -610,6 +743,7 @@ void OrderList::DebugCheckSanity() const
 	uint check_num_vehicles = 0;
 	Ticks check_timetable_duration = 0;
 	Ticks check_total_duration = 0;
+	std::map<uint32, uint> check_destinations;
 
 	DEBUG(misc, 6, "Checking OrderList %hu for sanity...", this->index);
 
@@ -618,6 +752,19 @@ void OrderList::DebugCheckSanity() const
 		if (!o->IsType(OT_IMPLICIT)) ++check_num_manual_orders;
 		check_timetable_duration += o->GetTimetabledWait() + o->GetTimetabledTravel();
 		check_total_duration += o->GetWaitTime() + o->GetTravelTime();
+		uint32 key = GetOrderDestinationKey(o);
+		if (key != UINT32_MAX) check_destinations[key]++;
+	}
+	/* Every destination of the orders is in the index with the right count, and the index has no other destinations for this list. */
+	for (std::map<uint32, uint>::const_iterator it = check_destinations.begin(); it != check_destinations.end(); ++it) {
+		OrderDestinationIndex::const_iterator dest = _order_destination_index.find(it->first);
+		assert(dest != _order_destination_index.end());
+		OrderListDestinationCount::const_iterator count = dest->second.find(this->index);
+		assert(count != dest->second.end() && count->second == it->second);
+	}
+	for (OrderDestinationIndex::const_iterator dest = _order_destination_index.begin(); dest != _order_destination_index.end(); ++dest) {
+		if (dest->second.find(this->index) == dest->second.end()) continue;
+		assert(check_destinations.find(dest->first) != check_destinations.end());
 	}
 	assert(this->num_orders == check_num_orders);
 	assert(this->num_manual_orders == check_num_manual_orders);
@@ -1884,6 +2031,7 @@ restart:
 
 				/* Clear order, preserving travel time */
 				bool travel_timetabled = order->IsTravelTimetabled();
+				UnregisterOrderDestination(v->orders.list, order);
 				order->MakeDummy();
 				order->SetTravelTimetabled(travel_timetabled);
 
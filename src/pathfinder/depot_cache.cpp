@@ -0,0 +1,72 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file depot_cache.cpp Cache of the results of nearest depot searches.
+ *
+ * Vehicles looking for a depot to service at mostly search from the same
+ * few tiles, and the outcome only changes when the map changes. The cache
+ * only holds results that a new search would return as well, i.e. results
+ * that didn't depend on the state of other vehicles, so it doesn't need to
+ * be saved and clients joining a game don't get out of sync. The whole
+ * cache is flushed whenever the landscape or the settings change.
+ */
+
+#include "../stdafx.h"
+#include "depot_cache.h"
+
+#include <map>
+
+#include "../safeguards.h"
+
+static const size_t NEAREST_DEPOT_CACHE_MAX_SIZE = 1 << 16; ///< Number of entries after which the cache is flushed.
+
+typedef std::map<NearestDepotCacheKey, FindDepotData> NearestDepotCache;
+static NearestDepotCache _nearest_depot_cache; ///< The cached search results.
+
+bool NearestDepotCacheKey::operator<(const NearestDepotCacheKey &other) const
+{
+	if (this->tile != other.tile) return this->tile < other.tile;
+	if (this->trackdir != other.trackdir) return this->trackdir < other.trackdir;
+	if (this->owner != other.owner) return this->owner < other.owner;
+	if (this->type != other.type) return this->type < other.type;
+	if (this->subtype != other.subtype) return this->subtype < other.subtype;
+	if (this->max_speed != other.max_speed) return this->max_speed < other.max_speed;
+	return this->max_distance < other.max_distance;
+}
+
+/**
+ * Get the result of an earlier nearest depot search.
+ * @param key Parameters of the search.
+ * @param[out] result The result of the search, if it was cached.
+ * @return True if the result was cached.
+ */
+bool FindCachedNearestDepot(const NearestDepotCacheKey &key, FindDepotData *result)
+{
+	NearestDepotCache::const_iterator it = _nearest_depot_cache.find(key);
+	if (it == _nearest_depot_cache.end()) return false;
+	*result = it->second;
+	return true;
+}
+
+/**
+ * Remember the result of a nearest depot search.
+ * @param key Parameters of the search.
+ * @param result The result; it may not depend on anything but \a key, the map and the settings.
+ */
+void CacheNearestDepot(const NearestDepotCacheKey &key, const FindDepotData &result)
+{
+	if (_nearest_depot_cache.size() >= NEAREST_DEPOT_CACHE_MAX_SIZE) _nearest_depot_cache.clear();
+	_nearest_depot_cache[key] = result;
+}
+
+/** Forget all cached searches, e.g. because depots or roads were built or removed. */
+void InvalidateNearestDepotCache()
+{
+	_nearest_depot_cache.clear();
+}
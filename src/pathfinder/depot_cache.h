@@ -0,0 +1,45 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file depot_cache.h Cache of the results of nearest depot searches. */
+
+#ifndef DEPOT_CACHE_H
+#define DEPOT_CACHE_H
+
+#include "../track_type.h"
+#include "../company_type.h"
+#include "../vehicle_type.h"
+#include "pathfinder_type.h"
+
+/**
+ * Everything the result of a nearest depot search depends on,
+ * besides the map itself and the game settings.
+ */
+struct NearestDepotCacheKey {
+	TileIndex tile;    ///< Tile the search starts at.
+	Trackdir trackdir; ///< Trackdir the search starts with, or INVALID_TRACKDIR when it doesn't matter.
+	Owner owner;       ///< Owner of the vehicle.
+	VehicleType type;  ///< Type of the vehicle.
+	uint16 subtype;    ///< Type specific properties of the vehicle, e.g. its compatible road types.
+	uint16 max_speed;  ///< Maximum speed of the vehicle, if speed limits add to the costs of the search; otherwise 0.
+	int max_distance;  ///< Maximum distance (penalty) to search for, 0 for unlimited.
+
+	NearestDepotCacheKey(TileIndex tile, Trackdir trackdir, Owner owner, VehicleType type, uint16 subtype, uint16 max_speed, int max_distance) :
+		tile(tile), trackdir(trackdir), owner(owner), type(type), subtype(subtype), max_speed(max_speed), max_distance(max_distance)
+	{
+	}
+
+	bool operator<(const NearestDepotCacheKey &other) const;
+};
+
+bool FindCachedNearestDepot(const NearestDepotCacheKey &key, FindDepotData *result);
+void CacheNearestDepot(const NearestDepotCacheKey &key, const FindDepotData &result);
+void InvalidateNearestDepotCache();
+
+#endif /* DEPOT_CACHE_H */
@@ -0,0 +1,363 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.cpp Handling of the water regions used for the high level ship pathfinding. */
+
+#include "../stdafx.h"
+#include "../map_func.h"
+#include "../tile_cmd.h"
+#include "../track_func.h"
+#include "../tunnelbridge_map.h"
+#include "../settings_type.h"
+#include "water_regions.h"
+
+#include <map>
+#include <queue>
+#include <algorithm>
+
+#include "../safeguards.h"
+
+static const uint WATER_REGION_NUMBER_OF_TILES = WATER_REGION_EDGE_LENGTH * WATER_REGION_EDGE_LENGTH; ///< Number of tiles in a water region.
+
+/** Aqueduct leading from a tile in a water region to a tile that is possibly in another region. */
+struct WaterRegionAqueduct {
+	uint16 local;        ///< Index of the aqueduct head within the region.
+	TileIndex other_end; ///< Tile at the other end of the aqueduct.
+};
+
+/**
+ * Connectivity information of the water tiles within a square part of the map.
+ * Tiles that ships can travel between without leaving the region share a
+ * patch label; tiles ships can't use have label 0.
+ */
+struct WaterRegion {
+	bool initialized;                                 ///< Whether the information below matches the map.
+	byte number_of_patches;                           ///< Number of separate water patches in the region.
+	byte labels[WATER_REGION_NUMBER_OF_TILES];        ///< Patch label of each tile of the region.
+	uint16 edges[DIAGDIR_END];                        ///< Per side of the region the tiles along that side ships can leave the region through.
+	std::vector<WaterRegionAqueduct> aqueducts;       ///< Aqueduct heads within the region.
+
+	WaterRegion() : initialized(false), number_of_patches(0) {}
+};
+
+static std::vector<WaterRegion> _water_regions; ///< The water regions of the map, row by row.
+static uint _water_regions_x;                   ///< Number of water regions along the x axis of the map.
+
+/**
+ * Get the index of the water region a tile belongs to.
+ * @param tile The tile.
+ * @return Index of the region.
+ */
+static inline uint GetWaterRegionIndex(TileIndex tile)
+{
+	return (TileY(tile) / WATER_REGION_EDGE_LENGTH) * _water_regions_x + TileX(tile) / WATER_REGION_EDGE_LENGTH;
+}
+
+/**
+ * Get the index of a tile within its water region.
+ * @param tile The tile.
+ * @return Index of the tile within the region.
+ */
+static inline uint GetWaterRegionLocalIndex(TileIndex tile)
+{
+	return (TileY(tile) % WATER_REGION_EDGE_LENGTH) * WATER_REGION_EDGE_LENGTH + TileX(tile) % WATER_REGION_EDGE_LENGTH;
+}
+
+/**
+ * Get the index within a water region of a tile along one of its sides.
+ * @param side Side of the region.
+ * @param pos Position of the tile along the side.
+ * @return Index of the tile within the region.
+ */
+static inline uint GetWaterRegionEdgeIndex(DiagDirection side, uint pos)
+{
+	switch (side) {
+		case DIAGDIR_NE: return pos * WATER_REGION_EDGE_LENGTH;
+		case DIAGDIR_SE: return (WATER_REGION_EDGE_LENGTH - 1) * WATER_REGION_EDGE_LENGTH + pos;
+		case DIAGDIR_SW: return pos * WATER_REGION_EDGE_LENGTH + WATER_REGION_EDGE_LENGTH - 1;
+		case DIAGDIR_NW: return pos;
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Get the sides of a tile through which a ship can move to the neighbouring tile.
+ * @param tile The tile.
+ * @return Bitmask of DiagDirections.
+ */
+static uint GetWaterTileExits(TileIndex tile)
+{
+	TrackBits tracks = TrackStatusToTrackBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0));
+	if (tracks == TRACK_BIT_NONE) return 0;
+
+	uint exits = 0;
+	for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+		if ((tracks & DiagdirReachesTracks(ReverseDiagDir(side))) != TRACK_BIT_NONE) SetBit(exits, side);
+	}
+	/* Ships leave an aqueduct head at the other end of the aqueduct. */
+	if (IsBridgeTile(tile) && GetTunnelBridgeTransportType(tile) == TRANSPORT_WATER) ClrBit(exits, GetTunnelBridgeDirection(tile));
+	return exits;
+}
+
+/**
+ * Recompute the connectivity information of a water region from the map.
+ * @param index Index of the region.
+ */
+static void UpdateWaterRegion(uint index)
+{
+	WaterRegion &region = _water_regions[index];
+	TileIndex north = TileXY((index % _water_regions_x) * WATER_REGION_EDGE_LENGTH, (index / _water_regions_x) * WATER_REGION_EDGE_LENGTH);
+
+	byte exits[WATER_REGION_NUMBER_OF_TILES];
+	region.aqueducts.clear();
+	for (uint local = 0; local < WATER_REGION_NUMBER_OF_TILES; local++) {
+		TileIndex tile = north + TileDiffXY(local % WATER_REGION_EDGE_LENGTH, local / WATER_REGION_EDGE_LENGTH);
+		exits[local] = GetWaterTileExits(tile);
+		if (exits[local] != 0 && IsBridgeTile(tile) && GetTunnelBridgeTransportType(tile) == TRANSPORT_WATER) {
+			WaterRegionAqueduct aqueduct = { (uint16)local, GetOtherTunnelBridgeEnd(tile) };
+			region.aqueducts.push_back(aqueduct);
+		}
+	}
+
+	/* Flood fill the patches; tiles are connected when both have a track leading to the other. */
+	memset(region.labels, 0, sizeof(region.labels));
+	region.number_of_patches = 0;
+	uint16 stack[WATER_REGION_NUMBER_OF_TILES];
+	for (uint start = 0; start < WATER_REGION_NUMBER_OF_TILES; start++) {
+		if (exits[start] == 0 || region.labels[start] != 0) continue;
+
+		byte label = ++region.number_of_patches;
+		uint stack_size = 0;
+		region.labels[start] = label;
+		stack[stack_size++] = start;
+		while (stack_size > 0) {
+			uint local = stack[--stack_size];
+			uint x = local % WATER_REGION_EDGE_LENGTH;
+			uint y = local / WATER_REGION_EDGE_LENGTH;
+			for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+				if (!HasBit(exits[local], side)) continue;
+
+				TileIndexDiffC diff = TileIndexDiffCByDiagDir(side);
+				uint nx = x + diff.x;
+				uint ny = y + diff.y;
+				if (nx >= WATER_REGION_EDGE_LENGTH || ny >= WATER_REGION_EDGE_LENGTH) continue;
+
+				uint neighbour = ny * WATER_REGION_EDGE_LENGTH + nx;
+				if (region.labels[neighbour] != 0 || !HasBit(exits[neighbour], ReverseDiagDir(side))) continue;
+				region.labels[neighbour] = label;
+				stack[stack_size++] = neighbour;
+			}
+		}
+	}
+
+	for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+		region.edges[side] = 0;
+		for (uint pos = 0; pos < WATER_REGION_EDGE_LENGTH; pos++) {
+			if (HasBit(exits[GetWaterRegionEdgeIndex(side, pos)], side)) SetBit(region.edges[side], pos);
+		}
+	}
+
+	region.initialized = true;
+}
+
+/**
+ * Get a water region, updating its information when the map changed.
+ * @param index Index of the region.
+ * @return The region.
+ */
+static const WaterRegion &GetUpdatedWaterRegion(uint index)
+{
+	if (!_water_regions[index].initialized) UpdateWaterRegion(index);
+	return _water_regions[index];
+}
+
+/**
+ * Get the patch label of a tile.
+ * @param tile The tile.
+ * @return The label, 0 when ships can't use the tile.
+ */
+static inline byte GetWaterPatchLabel(TileIndex tile)
+{
+	return GetUpdatedWaterRegion(GetWaterRegionIndex(tile)).labels[GetWaterRegionLocalIndex(tile)];
+}
+
+/** (Re)allocate the water regions for the current map size. */
+void AllocateWaterRegions()
+{
+	_water_regions_x = MapSizeX() / WATER_REGION_EDGE_LENGTH;
+	_water_regions.clear();
+	_water_regions.resize(_water_regions_x * (MapSizeY() / WATER_REGION_EDGE_LENGTH));
+}
+
+/**
+ * Mark the water region of a tile for recomputation, as the tile changed.
+ * @param tile The changed tile.
+ */
+void InvalidateWaterRegion(TileIndex tile)
+{
+	if (_water_regions.empty()) return;
+	_water_regions[GetWaterRegionIndex(tile)].initialized = false;
+}
+
+/**
+ * Mark the water regions of all tiles having the northern corner of a tile as one of their corners
+ * for recomputation, as the height of that corner changed.
+ * @param tile The tile whose northern corner changed.
+ */
+void InvalidateWaterRegionsAroundCorner(TileIndex tile)
+{
+	InvalidateWaterRegion(tile);
+	if (TileX(tile) > 0) InvalidateWaterRegion(tile - TileDiffXY(1, 0));
+	if (TileY(tile) > 0) InvalidateWaterRegion(tile - TileDiffXY(0, 1));
+	if (TileX(tile) > 0 && TileY(tile) > 0) InvalidateWaterRegion(tile - TileDiffXY(1, 1));
+}
+
+/**
+ * Check whether a tile is within one of the regions of the corridor.
+ * @param tile The tile.
+ * @return True if ships may use the tile.
+ */
+bool WaterRegionCorridor::Contains(TileIndex tile) const
+{
+	return std::binary_search(this->regions.begin(), this->regions.end(), GetWaterRegionIndex(tile));
+}
+
+/** Key of a node of the high level search: a water patch within a region. */
+typedef uint32 WaterRegionPatchKey;
+
+static inline WaterRegionPatchKey MakeWaterRegionPatchKey(uint region, byte label) { return region << 8 | label; }
+static inline uint GetWaterRegionPatchRegion(WaterRegionPatchKey key) { return key >> 8; }
+static inline byte GetWaterRegionPatchLabel(WaterRegionPatchKey key) { return GB(key, 0, 8); }
+
+/**
+ * Estimate the number of regions between two regions.
+ * @param a First region.
+ * @param b Second region.
+ * @return Manhattan distance in regions.
+ */
+static inline uint WaterRegionDistance(uint a, uint b)
+{
+	return Delta(a % _water_regions_x, b % _water_regions_x) + Delta(a / _water_regions_x, b / _water_regions_x);
+}
+
+/**
+ * Get the water patches a ship can reach directly from a patch.
+ * @param key The patch to start from.
+ * @param[out] neighbours Keys of the reachable patches.
+ */
+static void GetWaterRegionPatchNeighbours(WaterRegionPatchKey key, std::vector<WaterRegionPatchKey> &neighbours)
+{
+	neighbours.clear();
+	uint index = GetWaterRegionPatchRegion(key);
+	byte label = GetWaterRegionPatchLabel(key);
+	const WaterRegion &region = GetUpdatedWaterRegion(index);
+	uint x = index % _water_regions_x;
+	uint y = index / _water_regions_x;
+
+	for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+		if (region.edges[side] == 0) continue;
+
+		TileIndexDiffC diff = TileIndexDiffCByDiagDir(side);
+		uint nx = x + diff.x;
+		uint ny = y + diff.y;
+		if (nx >= _water_regions_x || ny >= _water_regions.size() / _water_regions_x) continue;
+
+		uint neighbour_index = ny * _water_regions_x + nx;
+		const WaterRegion &neighbour = GetUpdatedWaterRegion(neighbour_index);
+		DiagDirection opposite = ReverseDiagDir(side);
+		uint16 edge = region.edges[side] & neighbour.edges[opposite];
+		for (uint pos = 0; edge != 0; pos++, edge >>= 1) {
+			if (!HasBit(edge, 0) || region.labels[GetWaterRegionEdgeIndex(side, pos)] != label) continue;
+			neighbours.push_back(MakeWaterRegionPatchKey(neighbour_index, neighbour.labels[GetWaterRegionEdgeIndex(opposite, pos)]));
+		}
+	}
+
+	for (std::vector<WaterRegionAqueduct>::const_iterator it = region.aqueducts.begin(); it != region.aqueducts.end(); ++it) {
+		if (region.labels[it->local] != label) continue;
+		byte other_label = GetWaterPatchLabel(it->other_end);
+		if (other_label != 0) neighbours.push_back(MakeWaterRegionPatchKey(GetWaterRegionIndex(it->other_end), other_label));
+	}
+}
+
+/**
+ * Find the water regions a ship has to pass on its way to its destination.
+ * The corridor consists of the regions on the shortest route counted in
+ * regions, widened by one region on all sides, so the tile based pathfinder
+ * only needs to search within it.
+ * @param start Tile the ship starts from.
+ * @param dest Destination tile of the ship.
+ * @param[out] corridor The found corridor.
+ * @return True if a corridor was found, false if the destination looks
+ *         unreachable or the search gave up.
+ */
+bool FindWaterRegionCorridor(TileIndex start, TileIndex dest, WaterRegionCorridor &corridor)
+{
+	corridor.regions.clear();
+	if (_water_regions.empty()) return false;
+
+	byte start_label = GetWaterPatchLabel(start);
+	byte dest_label = GetWaterPatchLabel(dest);
+	if (start_label == 0 || dest_label == 0) return false;
+
+	uint dest_region = GetWaterRegionIndex(dest);
+	WaterRegionPatchKey start_key = MakeWaterRegionPatchKey(GetWaterRegionIndex(start), start_label);
+	WaterRegionPatchKey dest_key = MakeWaterRegionPatchKey(dest_region, dest_label);
+
+	/* A* over the water patches; each step into the next region costs one. */
+	typedef std::pair<uint, WaterRegionPatchKey> OpenItem; ///< Estimated total cost and patch.
+	typedef std::pair<uint, WaterRegionPatchKey> NodeInfo; ///< Cost so far and parent patch.
+	std::priority_queue<OpenItem, std::vector<OpenItem>, std::greater<OpenItem> > open;
+	std::map<WaterRegionPatchKey, NodeInfo> nodes;
+	std::vector<WaterRegionPatchKey> neighbours;
+
+	nodes[start_key] = NodeInfo(0, start_key);
+	open.push(OpenItem(WaterRegionDistance(GetWaterRegionIndex(start), dest_region), start_key));
+
+	uint max_nodes = _settings_game.pf.yapf.max_search_nodes;
+	bool found = false;
+	while (!open.empty() && max_nodes-- > 0) {
+		OpenItem item = open.top();
+		open.pop();
+
+		WaterRegionPatchKey key = item.second;
+		if (key == dest_key) {
+			found = true;
+			break;
+		}
+
+		uint cost = nodes[key].first;
+		if (item.first > cost + WaterRegionDistance(GetWaterRegionPatchRegion(key), dest_region)) continue; // Outdated entry.
+
+		GetWaterRegionPatchNeighbours(key, neighbours);
+		for (std::vector<WaterRegionPatchKey>::const_iterator it = neighbours.begin(); it != neighbours.end(); ++it) {
+			std::map<WaterRegionPatchKey, NodeInfo>::iterator node = nodes.find(*it);
+			if (node != nodes.end() && node->second.first <= cost + 1) continue;
+
+			nodes[*it] = NodeInfo(cost + 1, key);
+			open.push(OpenItem(cost + 1 + WaterRegionDistance(GetWaterRegionPatchRegion(*it), dest_region), *it));
+		}
+	}
+	if (!found) return false;
+
+	uint regions_y = (uint)_water_regions.size() / _water_regions_x;
+	for (WaterRegionPatchKey key = dest_key;; key = nodes[key].second) {
+		uint index = GetWaterRegionPatchRegion(key);
+		uint x = index % _water_regions_x;
+		uint y = index / _water_regions_x;
+		for (uint ny = max(y, 1U) - 1; ny <= min(y + 1, regions_y - 1); ny++) {
+			for (uint nx = max(x, 1U) - 1; nx <= min(x + 1, _water_regions_x - 1); nx++) {
+				corridor.regions.push_back(ny * _water_regions_x + nx);
+			}
+		}
+		if (key == start_key) break;
+	}
+	std::sort(corridor.regions.begin(), corridor.regions.end());
+	corridor.regions.erase(std::unique(corridor.regions.begin(), corridor.regions.end()), corridor.regions.end());
+	return true;
+}
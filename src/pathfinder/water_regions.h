@@ -0,0 +1,38 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.h Handling of the water regions used for the high level ship pathfinding. */
+
+#ifndef WATER_REGIONS_H
+#define WATER_REGIONS_H
+
+#include "../tile_type.h"
+#include <vector>
+
+static const uint WATER_REGION_EDGE_LENGTH = 16; ///< Number of tiles along an edge of a water region.
+
+/**
+ * Set of water regions a ship may use on its way to the destination,
+ * as determined by the high level pathfinder.
+ */
+class WaterRegionCorridor {
+	std::vector<uint> regions; ///< Sorted indices of the regions in the corridor.
+
+	friend bool FindWaterRegionCorridor(TileIndex start, TileIndex dest, WaterRegionCorridor &corridor);
+
+public:
+	bool Contains(TileIndex tile) const;
+};
+
+void AllocateWaterRegions();
+void InvalidateWaterRegion(TileIndex tile);
+void InvalidateWaterRegionsAroundCorner(TileIndex tile);
+bool FindWaterRegionCorridor(TileIndex start, TileIndex dest, WaterRegionCorridor &corridor);
+
+#endif /* WATER_REGIONS_H */
@@ -19,12 +19,19 @@ struct CYapfRoadNodeT : CYapfNodeT<Tkey_, CYapfRoadNodeT<Tkey_> > {
 
 	TileIndex m_segment_last_tile;
 	Trackdir  m_segment_last_td;
+	bool      m_is_choice;
 
 	void Set(CYapfRoadNodeT *parent, TileIndex tile, Trackdir td, bool is_choice)
 	{
 		base::Set(parent, tile, td, is_choice);
 		m_segment_last_tile = tile;
 		m_segment_last_td = td;
+		m_is_choice = is_choice;
+	}
+
+	inline bool GetIsChoice() const
+	{
+		return m_is_choice;
 	}
 };
 
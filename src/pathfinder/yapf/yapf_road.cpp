@@ -13,6 +13,7 @@
 #include "yapf.hpp"
 #include "yapf_node_road.hpp"
 #include "../../roadstop_base.h"
+#include "../depot_cache.h"
 
 #include "../../safeguards.h"
 
@@ -28,8 +29,9 @@ public:
 
 protected:
 	int m_max_cost;
+	bool m_dynamic_cost; ///< Whether the occupation of road stops was part of any cost.
 
-	CYapfCostRoadT() : m_max_cost(0) {};
+	CYapfCostRoadT() : m_max_cost(0), m_dynamic_cost(false) {};
 
 	/** to access inherited path finder */
 	Tpf& Yapf()
@@ -82,10 +84,12 @@ protected:
 							 * cost based on the fill percentage of the whole queue. */
 							const RoadStop::Entry *entry = rs->GetEntry(dir);
 							cost += entry->GetOccupied() * Yapf().PfGetSettings().road_stop_occupied_penalty / entry->GetLength();
+							if (Yapf().PfGetSettings().road_stop_occupied_penalty != 0) m_dynamic_cost = true;
 						}
 					} else {
 						/* Increase cost for filled road stops */
 						cost += Yapf().PfGetSettings().road_stop_bay_occupied_penalty * (!rs->IsFreeBay(0) + !rs->IsFreeBay(1)) / 2;
+						if (Yapf().PfGetSettings().road_stop_bay_occupied_penalty != 0) m_dynamic_cost = true;
 					}
 					break;
 				}
@@ -106,6 +110,15 @@ public:
 		m_max_cost = max_cost;
 	}
 
+	/**
+	 * Check whether the costs depended on the position of other vehicles.
+	 * @return True if the result of the search may change without the map changing.
+	 */
+	inline bool HasDynamicCost() const
+	{
+		return m_dynamic_cost;
+	}
+
 	/**
 	 * Called by YAPF to calculate the cost from the origin to the given node.
 	 *  Calculates only the cost of given node, adds it to the parent node cost
@@ -253,6 +266,15 @@ public:
 		}
 	}
 
+	/**
+	 * Get the station the vehicle is heading for.
+	 * @return The destination station or NULL if the destination isn't a station.
+	 */
+	const Station *GetDestinationStation() const
+	{
+		return m_dest_station != INVALID_STATION ? Station::GetIfValid(m_dest_station) : NULL;
+	}
+
 protected:
 	/** to access inherited path finder */
 	Tpf& Yapf()
@@ -348,13 +370,13 @@ public:
 		return 'r';
 	}
 
-	static Trackdir stChooseRoadTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, bool &path_found)
+	static Trackdir stChooseRoadTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, bool &path_found, RoadVehPathCache &path_cache)
 	{
 		Tpf pf;
-		return pf.ChooseRoadTrack(v, tile, enterdir, path_found);
+		return pf.ChooseRoadTrack(v, tile, enterdir, path_found, path_cache);
 	}
 
-	inline Trackdir ChooseRoadTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, bool &path_found)
+	inline Trackdir ChooseRoadTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, bool &path_found, RoadVehPathCache &path_cache)
 	{
 		/* Handle special case - when next tile is destination tile.
 		 * However, when going to a station the (initial) destination
@@ -382,15 +404,40 @@ public:
 		Trackdir next_trackdir = INVALID_TRACKDIR;
 		Node *pNode = Yapf().GetBestNode();
 		if (pNode != NULL) {
+			uint steps = 0;
+			for (Node *n = pNode; n->m_parent != NULL; n = n->m_parent) steps++;
+
 			/* path was found or at least suggested
-			 * walk through the path back to its origin */
+			 * walk through the path back to its origin and cache the
+			 * choices made at the first junctions */
 			while (pNode->m_parent != NULL) {
+				steps--;
+				if (pNode->GetIsChoice() && steps < YAPF_ROADVEH_PATH_CACHE_SEGMENTS) {
+					TrackdirByte td;
+					td = pNode->GetTrackdir();
+					path_cache.td.push_front(td);
+					path_cache.tile.push_front(pNode->GetTile());
+				}
 				pNode = pNode->m_parent;
 			}
 			/* return trackdir from the best origin node (one of start nodes) */
 			Node &best_next_node = *pNode;
 			assert(best_next_node.GetTile() == tile);
 			next_trackdir = best_next_node.GetTrackdir();
+
+			/* Don't cache the choices close to a destination station with
+			 * several stops, so the vehicle can still pick a free one. */
+			const Station *st = Yapf().GetDestinationStation();
+			if (st != NULL) {
+				const RoadStop *stop = st->GetPrimaryRoadStop(v);
+				if (stop != NULL && (IsDriveThroughStopTile(stop->xy) || stop->GetNextRoadStop(v) != NULL)) {
+					TileArea non_cached_area = v->IsBus() ? st->bus_station : st->truck_station;
+					non_cached_area.Expand(YAPF_ROADVEH_PATH_CACHE_DESTINATION_LIMIT);
+					while (!path_cache.empty() && non_cached_area.Contains(path_cache.tile.back())) {
+						path_cache.pop_back();
+					}
+				}
+			}
 		}
 		return next_trackdir;
 	}
@@ -445,10 +492,12 @@ public:
 		return true;
 	}
 
-	static FindDepotData stFindNearestDepot(const RoadVehicle *v, TileIndex tile, Trackdir td, int max_distance)
+	static FindDepotData stFindNearestDepot(const RoadVehicle *v, TileIndex tile, Trackdir td, int max_distance, bool *cacheable)
 	{
 		Tpf pf;
-		return pf.FindNearestDepot(v, tile, td, max_distance);
+		FindDepotData result = pf.FindNearestDepot(v, tile, td, max_distance);
+		*cacheable = !pf.HasDynamicCost();
+		return result;
 	}
 
 	/**
@@ -497,10 +546,10 @@ struct CYapfRoadAnyDepot1 : CYapfT<CYapfRoad_TypesT<CYapfRoadAnyDepot1, CRoadNod
 struct CYapfRoadAnyDepot2 : CYapfT<CYapfRoad_TypesT<CYapfRoadAnyDepot2, CRoadNodeListExitDir , CYapfDestinationAnyDepotRoadT> > {};
 
 
-Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, bool &path_found)
+Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, bool &path_found, RoadVehPathCache &path_cache)
 {
 	/* default is YAPF type 2 */
-	typedef Trackdir (*PfnChooseRoadTrack)(const RoadVehicle*, TileIndex, DiagDirection, bool &path_found);
+	typedef Trackdir (*PfnChooseRoadTrack)(const RoadVehicle*, TileIndex, DiagDirection, bool &path_found, RoadVehPathCache &path_cache);
 	PfnChooseRoadTrack pfnChooseRoadTrack = &CYapfRoad2::stChooseRoadTrack; // default: ExitDir, allow 90-deg
 
 	/* check if non-default YAPF type should be used */
@@ -508,7 +557,7 @@ Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDi
 		pfnChooseRoadTrack = &CYapfRoad1::stChooseRoadTrack; // Trackdir, allow 90-deg
 	}
 
-	Trackdir td_ret = pfnChooseRoadTrack(v, tile, enterdir, path_found);
+	Trackdir td_ret = pfnChooseRoadTrack(v, tile, enterdir, path_found, path_cache);
 	return (td_ret != INVALID_TRACKDIR) ? td_ret : (Trackdir)FindFirstBit2x64(trackdirs);
 }
 
@@ -521,7 +570,7 @@ FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_dist
 	}
 
 	/* default is YAPF type 2 */
-	typedef FindDepotData (*PfnFindNearestDepot)(const RoadVehicle*, TileIndex, Trackdir, int);
+	typedef FindDepotData (*PfnFindNearestDepot)(const RoadVehicle*, TileIndex, Trackdir, int, bool *);
 	PfnFindNearestDepot pfnFindNearestDepot = &CYapfRoadAnyDepot2::stFindNearestDepot;
 
 	/* check if non-default YAPF type should be used */
@@ -529,5 +578,22 @@ FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_dist
 		pfnFindNearestDepot = &CYapfRoadAnyDepot1::stFindNearestDepot; // Trackdir, allow 90-deg
 	}
 
-	return pfnFindNearestDepot(v, tile, trackdir, max_distance);
+	/* Searches that didn't pass any road stops give the same result until the map changes,
+	 * for vehicles of the same maximum speed as the speed limits are part of the costs. */
+	NearestDepotCacheKey key(tile, trackdir, v->owner, VEH_ROAD, v->compatible_roadtypes, v->GetDisplayMaxSpeed(), max_distance);
+	FindDepotData result;
+	bool cacheable;
+	if (FindCachedNearestDepot(key, &result)) {
+		if (_debug_desync_level >= 2) {
+			FindDepotData result2 = pfnFindNearestDepot(v, tile, trackdir, max_distance, &cacheable);
+			if (result.tile != result2.tile || result.best_length != result2.best_length) {
+				DEBUG(desync, 2, "CACHE ERROR: YapfRoadVehicleFindNearestDepot() = [%d, %d]", result.tile, result2.tile);
+			}
+		}
+		return result;
+	}
+
+	result = pfnFindNearestDepot(v, tile, trackdir, max_distance, &cacheable);
+	if (cacheable) CacheNearestDepot(key, result);
+	return result;
 }
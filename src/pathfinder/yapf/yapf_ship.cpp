@@ -14,6 +14,7 @@
 
 #include "yapf.hpp"
 #include "yapf_node_ship.hpp"
+#include "../water_regions.h"
 
 #include "../../safeguards.h"
 
@@ -28,6 +29,8 @@ public:
 	typedef typename Node::Key Key;                      ///< key to hash tables
 
 protected:
+	const WaterRegionCorridor *m_corridor; ///< Water regions the search is restricted to, or NULL for an unrestricted search.
+
 	/** to access inherited path finder */
 	inline Tpf& Yapf()
 	{
@@ -35,6 +38,17 @@ protected:
 	}
 
 public:
+	CYapfFollowShipT() : m_corridor(NULL) {}
+
+	/**
+	 * Restrict the search to the tiles within the given water regions.
+	 * @param corridor The regions, or NULL to search everywhere.
+	 */
+	inline void SetCorridor(const WaterRegionCorridor *corridor)
+	{
+		m_corridor = corridor;
+	}
+
 	/**
 	 * Called by YAPF to move from the given node to the next tile. For each
 	 *  reachable trackdir on the new tile creates new node, initializes it
@@ -44,6 +58,7 @@ public:
 	{
 		TrackFollower F(Yapf().GetVehicle());
 		if (F.Follow(old_node.m_key.m_tile, old_node.m_key.m_td)) {
+			if (m_corridor != NULL && !m_corridor->Contains(F.m_new_tile)) return;
 			Yapf().AddMultipleNodes(&old_node, F);
 		}
 	}
@@ -78,8 +93,34 @@ public:
 		/* get available trackdirs on the destination tile */
 		TrackdirBits dest_trackdirs = TrackStatusToTrackdirBits(GetTileTrackStatus(v->dest_tile, TRANSPORT_WATER, 0));
 
+		/* First search within the water regions on the way to the destination only;
+		 * if that fails, the corridor was too narrow, so search everywhere. */
+		WaterRegionCorridor corridor;
+		if (FindWaterRegionCorridor(src_tile, v->dest_tile, corridor)) {
+			Trackdir next_trackdir = FindShipPath(v, tile, src_tile, trackdirs, dest_trackdirs, &corridor, path_found, path_cache);
+			if (path_found) return next_trackdir;
+			path_cache.clear();
+		}
+		return FindShipPath(v, tile, src_tile, trackdirs, dest_trackdirs, NULL, path_found, path_cache);
+	}
+
+	/**
+	 * Search the path of a ship from the tile it is leaving.
+	 * @param v The ship.
+	 * @param tile Tile the ship is about to enter.
+	 * @param src_tile Tile the ship is leaving.
+	 * @param trackdirs Trackdir of the ship on the tile it is leaving.
+	 * @param dest_trackdirs Trackdirs of the destination tile.
+	 * @param corridor Water regions to restrict the search to, or NULL.
+	 * @param[out] path_found Whether the destination was reached.
+	 * @param[out] path_cache Cache to store the following trackdirs of the path in.
+	 * @return Trackdir to take on \a tile, or INVALID_TRACKDIR.
+	 */
+	static Trackdir FindShipPath(const Ship *v, TileIndex tile, TileIndex src_tile, TrackdirBits trackdirs, TrackdirBits dest_trackdirs, const WaterRegionCorridor *corridor, bool &path_found, ShipPathCache &path_cache)
+	{
 		/* create pathfinder instance */
 		Tpf pf;
+		pf.SetCorridor(corridor);
 		/* set origin and destination nodes */
 		pf.SetOrigin(src_tile, trackdirs);
 		pf.SetDestination(v->dest_tile, dest_trackdirs);
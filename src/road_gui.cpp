@@ -970,8 +970,6 @@ struct BuildRoadStationWindow : public PickerWindowBase {
 		this->LowerWidget(_settings_client.gui.station_show_coverage + WID_BROS_LT_OFF);
 
 		this->FinishInitNested(TRANSPORT_ROAD);
-
-		this->window_class = (rs == ROADSTOP_BUS) ? WC_BUS_STATION : WC_TRUCK_STATION;
 	}
 
 	virtual ~BuildRoadStationWindow()
@@ -1099,13 +1097,20 @@ static const NWidgetPart _nested_road_station_picker_widgets[] = {
 	EndContainer(),
 };
 
-static WindowDesc _road_station_picker_desc(
+static WindowDesc _road_bus_station_picker_desc(
 	WDP_AUTO, NULL, 0, 0,
 	WC_BUS_STATION, WC_BUILD_TOOLBAR,
 	WDF_CONSTRUCTION,
 	_nested_road_station_picker_widgets, lengthof(_nested_road_station_picker_widgets)
 );
 
+static WindowDesc _road_truck_station_picker_desc(
+	WDP_AUTO, NULL, 0, 0,
+	WC_TRUCK_STATION, WC_BUILD_TOOLBAR,
+	WDF_CONSTRUCTION,
+	_nested_road_station_picker_widgets, lengthof(_nested_road_station_picker_widgets)
+);
+
 /** Widget definition of the build tram station window */
 static const NWidgetPart _nested_tram_station_picker_widgets[] = {
 	NWidget(NWID_HORIZONTAL),
@@ -1137,16 +1142,30 @@ static const NWidgetPart _nested_tram_station_picker_widgets[] = {
 	EndContainer(),
 };
 
-static WindowDesc _tram_station_picker_desc(
+static WindowDesc _tram_bus_station_picker_desc(
 	WDP_AUTO, NULL, 0, 0,
 	WC_BUS_STATION, WC_BUILD_TOOLBAR,
 	WDF_CONSTRUCTION,
 	_nested_tram_station_picker_widgets, lengthof(_nested_tram_station_picker_widgets)
 );
 
+static WindowDesc _tram_truck_station_picker_desc(
+	WDP_AUTO, NULL, 0, 0,
+	WC_TRUCK_STATION, WC_BUILD_TOOLBAR,
+	WDF_CONSTRUCTION,
+	_nested_tram_station_picker_widgets, lengthof(_nested_tram_station_picker_widgets)
+);
+
 static void ShowRVStationPicker(Window *parent, RoadStopType rs)
 {
-	new BuildRoadStationWindow(_cur_roadtype == ROADTYPE_ROAD ? &_road_station_picker_desc : &_tram_station_picker_desc, parent, rs);
+	/* The bus and truck pickers have their own descriptions, as the class of a window has to be the one of its description. */
+	WindowDesc *desc;
+	if (_cur_roadtype == ROADTYPE_ROAD) {
+		desc = (rs == ROADSTOP_BUS) ? &_road_bus_station_picker_desc : &_road_truck_station_picker_desc;
+	} else {
+		desc = (rs == ROADSTOP_BUS) ? &_tram_bus_station_picker_desc : &_tram_truck_station_picker_desc;
+	}
+	new BuildRoadStationWindow(desc, parent, rs);
 }
 
 void InitializeRoadGui()
@@ -2187,24 +2187,15 @@ bool AfterLoadGame()
 
 	if (IsSavegameVersionBefore(122)) {
 		/* Animated tiles would sometimes not be actually animated or
-		 * in case of old savegames duplicate. */
+		 * in case of old savegames duplicate. Duplicates are already
+		 * removed when the animated tile table is loaded. */
 
 		extern SmallVector<TileIndex, 256> _animated_tiles;
 
-		for (TileIndex *tile = _animated_tiles.Begin(); tile < _animated_tiles.End(); /* Nothing */) {
+		for (uint i = 0; i < _animated_tiles.Length(); i++) {
+			TileIndex tile = _animated_tiles[i];
 			/* Remove if tile is not animated */
-			bool remove = _tile_type_procs[GetTileType(*tile)]->animate_tile_proc == NULL;
-
-			/* and remove if duplicate */
-			for (TileIndex *j = _animated_tiles.Begin(); !remove && j < tile; j++) {
-				remove = *tile == *j;
-			}
-
-			if (remove) {
-				DeleteAnimatedTile(*tile);
-			} else {
-				tile++;
-			}
+			if (tile != INVALID_TILE && _tile_type_procs[GetTileType(tile)]->animate_tile_proc == NULL) DeleteAnimatedTile(tile);
 		}
 	}
 
@@ -3056,6 +3047,9 @@ bool AfterLoadGame()
 	AfterLoadLabelMaps();
 	AfterLoadCompanyStats();
 	AfterLoadStoryBook();
+	RebuildOrderDestinationIndex();
+	RebuildIndustrySchedule();
+	RebuildTownGrowthSchedule();
 
 	GamelogPrintDebug(1);
 
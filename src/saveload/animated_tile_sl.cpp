@@ -19,12 +19,15 @@
 #include "../safeguards.h"
 
 extern SmallVector<TileIndex, 256> _animated_tiles;
+extern void CompactAnimatedTiles();
+extern void RebuildAnimatedTileIndex();
 
 /**
  * Save the ANIT chunk.
  */
 static void Save_ANIT()
 {
+	CompactAnimatedTiles();
 	SlSetLength(_animated_tiles.Length() * sizeof(*_animated_tiles.Begin()));
 	SlArray(_animated_tiles.Begin(), _animated_tiles.Length(), SLE_UINT32);
 }
@@ -44,13 +47,14 @@ static void Load_ANIT()
 			if (anim_list[i] == 0) break;
 			*_animated_tiles.Append() = anim_list[i];
 		}
-		return;
+	} else {
+		uint count = (uint)SlGetFieldLength() / sizeof(*_animated_tiles.Begin());
+		_animated_tiles.Clear();
+		_animated_tiles.Append(count);
+		SlArray(_animated_tiles.Begin(), count, SLE_UINT32);
 	}
 
-	uint count = (uint)SlGetFieldLength() / sizeof(*_animated_tiles.Begin());
-	_animated_tiles.Clear();
-	_animated_tiles.Append(count);
-	SlArray(_animated_tiles.Begin(), count, SLE_UINT32);
+	RebuildAnimatedTileIndex();
 }
 
 /**
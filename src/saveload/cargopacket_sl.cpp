@@ -116,6 +116,10 @@ const SaveLoad *GetCargoPacketDesc()
  */
 static void Save_CAPA()
 {
+	/* Vehicles age their cargo lazily; store the actual days in transit. */
+	Vehicle *v;
+	FOR_ALL_VEHICLES(v) v->cargo.ApplyPendingAge();
+
 	CargoPacket *cp;
 
 	FOR_ALL_CARGOPACKETS(cp) {
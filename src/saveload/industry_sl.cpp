@@ -80,6 +80,9 @@ static void Save_INDY()
 {
 	Industry *ind;
 
+	/* Make the stored counters the actual ones. */
+	RebuildIndustrySchedule();
+
 	/* Write the industries */
 	FOR_ALL_INDUSTRIES(ind) {
 		SlSetArrayIndex(ind->index);
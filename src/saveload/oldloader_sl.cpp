@@ -492,6 +492,7 @@ static inline uint RemapOrderIndex(uint x)
 }
 
 extern SmallVector<TileIndex, 256> _animated_tiles;
+extern void RebuildAnimatedTileIndex();
 extern char *_old_name_array;
 
 static uint32 _old_town_index;
@@ -653,6 +654,7 @@ static bool LoadOldAnimTileList(LoadgameState *ls, int num)
 		if (anim_list[i] == 0) break;
 		*_animated_tiles.Append() = anim_list[i];
 	}
+	RebuildAnimatedTileIndex();
 
 	return true;
 }
@@ -274,8 +274,9 @@
  *  202   #6867   Increase industry cargo slots to 16 in, 16 out
  *  203   #7072   Add path cache for ships
  *  204   #7065   Add extra rotation stages for ships.
+ *  205           Add path cache for road vehicles.
  */
-extern const uint16 SAVEGAME_VERSION = 204; ///< Current savegame version of OpenTTD.
+extern const uint16 SAVEGAME_VERSION = 205; ///< Current savegame version of OpenTTD.
 
 SavegameType _savegame_type; ///< type of savegame we are loading
 FileToSaveLoad _file_to_saveload; ///< File to save or load in the openttd loop.
@@ -311,15 +311,36 @@ static void SwapPackets(GoodsEntry *ge)
 	StationCargoPacketMap &ge_packets = const_cast<StationCargoPacketMap &>(*ge->cargo.Packets());
 
 	if (_packets.empty()) {
-		std::map<StationID, std::list<CargoPacket *> >::iterator it(ge_packets.find(INVALID_STATION));
-		if (it == ge_packets.end()) {
-			return;
-		} else {
-			it->second.swap(_packets);
+		StationCargoPacketMap::Bucket *bucket = ge_packets.Find(INVALID_STATION);
+		if (bucket == NULL) return;
+		while (!bucket->IsEmpty()) {
+			_packets.push_back(bucket->Front());
+			bucket->PopFront();
 		}
+		ge_packets.RemoveIfEmpty(bucket);
 	} else {
-		assert(ge_packets[INVALID_STATION].empty());
-		ge_packets[INVALID_STATION].swap(_packets);
+		StationCargoPacketMap::Bucket &bucket = ge_packets[INVALID_STATION];
+		assert(bucket.IsEmpty());
+		for (std::list<CargoPacket *>::const_iterator it(_packets.begin()); it != _packets.end(); ++it) {
+			bucket.PushBack(*it);
+		}
+		_packets.clear();
+	}
+}
+
+/**
+ * Save, load or fix the references of the packets with one next hop using a
+ * temporary list, as that's what SLE_LST handles.
+ * @param bucket Packets to handle; they are updated with the result.
+ */
+static void SlCargoBucket(StationCargoPacketMap::Bucket *bucket)
+{
+	StationCargoPair pair(bucket->GetKey(), std::list<CargoPacket *>(&(*bucket)[0], &(*bucket)[0] + bucket->Size()));
+	SlObject(&pair, _cargo_list_desc);
+
+	uint i = 0;
+	for (std::list<CargoPacket *>::const_iterator it(pair.second.begin()); it != pair.second.end(); ++it) {
+		(*bucket)[i++] = *it;
 	}
 }
 
@@ -497,8 +518,9 @@ static void RealSave_STNN(BaseStation *bst)
 					SlObject(&flow, _flow_desc);
 				}
 			}
-			for (StationCargoPacketMap::ConstMapIterator it(st->goods[i].cargo.Packets()->begin()); it != st->goods[i].cargo.Packets()->end(); ++it) {
-				SlObject(const_cast<StationCargoPacketMap::value_type *>(&(*it)), _cargo_list_desc);
+			const StationCargoPacketMap::BucketVector &buckets = st->goods[i].cargo.Packets()->Buckets();
+			for (StationCargoPacketMap::BucketVector::const_iterator it(buckets.begin()); it != buckets.end(); ++it) {
+				SlCargoBucket(*it);
 			}
 		}
 	}
@@ -561,8 +583,14 @@ static void Load_STNN()
 					StationCargoPair pair;
 					for (uint j = 0; j < _num_dests; ++j) {
 						SlObject(&pair, _cargo_list_desc);
-						const_cast<StationCargoPacketMap &>(*(st->goods[i].cargo.Packets()))[pair.first].swap(pair.second);
-						assert(pair.second.empty());
+						/* The map never has empty buckets; there is nothing to load for this next hop. */
+						if (pair.second.empty()) continue;
+
+						StationCargoPacketMap::Bucket &bucket = const_cast<StationCargoPacketMap &>(*(st->goods[i].cargo.Packets()))[pair.first];
+						for (std::list<CargoPacket *>::const_iterator it(pair.second.begin()); it != pair.second.end(); ++it) {
+							bucket.PushBack(*it);
+						}
+						pair.second.clear();
 					}
 				}
 			}
@@ -594,8 +622,9 @@ static void Ptrs_STNN()
 				SwapPackets(ge);
 			} else {
 				SlObject(ge, GetGoodsDesc());
-				for (StationCargoPacketMap::ConstMapIterator it = ge->cargo.Packets()->begin(); it != ge->cargo.Packets()->end(); ++it) {
-					SlObject(const_cast<StationCargoPair *>(&(*it)), _cargo_list_desc);
+				const StationCargoPacketMap::BucketVector &buckets = ge->cargo.Packets()->Buckets();
+				for (StationCargoPacketMap::BucketVector::const_iterator it(buckets.begin()); it != buckets.end(); ++it) {
+					SlCargoBucket(*it);
 				}
 			}
 		}
@@ -267,6 +267,9 @@ static void Save_TOWN()
 	Town *t;
 
 	FOR_ALL_TOWNS(t) {
+		/* Store the actual counter of growing towns. */
+		t->grow_counter = t->GetGrowCounter();
+
 		SlSetArrayIndex(t->index);
 		SlAutolength((AutolengthProc*)RealSave_Town, t);
 	}
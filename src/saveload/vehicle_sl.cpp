@@ -748,6 +748,8 @@ const SaveLoad *GetVehicleDescription(VehicleType vt)
 		     SLE_VAR(RoadVehicle, overtaking_ctr,       SLE_UINT8),
 		     SLE_VAR(RoadVehicle, crashed_ctr,          SLE_UINT16),
 		     SLE_VAR(RoadVehicle, reverse_ctr,          SLE_UINT8),
+		SLE_CONDDEQUE(RoadVehicle, path.td,             SLE_UINT8,                  205, SL_MAX_VERSION),
+		SLE_CONDDEQUE(RoadVehicle, path.tile,           SLE_UINT32,                 205, SL_MAX_VERSION),
 
 		SLE_CONDNULL(2,                                                               6,  68),
 		 SLE_CONDVAR(RoadVehicle, gv_flags,             SLE_UINT16,                 139, SL_MAX_VERSION),
@@ -756,6 +756,13 @@ static bool MakeLargeWorldScreenshot(ScreenshotType t)
 	ViewPort vp;
 	SetupScreenshotViewport(t, &vp);
 
+	/* Without a screen the signs are not measured, but they are drawn in the screenshot. */
+	if (_headless) {
+		_headless = false;
+		UpdateAllVirtCoords();
+		_headless = true;
+	}
+
 	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
 	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), LargeWorldCallback, &vp, vp.width, vp.height,
 			BlitterFactory::GetCurrentBlitter()->GetScreenDepth(), _cur_palette.palette);
@@ -20,6 +20,7 @@
  * 1.9.0 is not yet released. The following changes are not set in stone yet.
  * API additions:
  * \li AIAirport::GetMonthlyMaintenanceCost
+ * \li AITileList::ValuateTiles
  *
  * \b 1.8.0
  *
@@ -14,406 +14,321 @@
 #include "script_controller.hpp"
 #include "../../debug.h"
 #include "../../script/squirrel.hpp"
+#include <algorithm>
+#include <queue>
 
 #include "../../safeguards.h"
 
+/** An item of a list together with its value, ordered by value first and item second. */
+typedef std::pair<int64, int64> ScriptListValueItem;
+
 /**
- * Base class for any ScriptList sorter.
+ * Sorter for iterating a ScriptList. When the iteration is started the items
+ * of the list are sorted once; the iteration then walks that order. Like when
+ * walking the list itself, items that are removed before they are reached are
+ * skipped, and items that are added, or get a new value, after the position of
+ * the iteration are still reached.
  */
 class ScriptListSorter {
-protected:
-	ScriptList *list;       ///< The list that's being sorted.
-	bool has_no_more_items; ///< Whether we have more items to iterate over.
-	int64 item_next;        ///< The next item we will show.
-
-public:
-	/**
-	 * Virtual dtor, needed to mute warnings.
-	 */
-	virtual ~ScriptListSorter() { }
-
-	/**
-	 * Get the first item of the sorter.
-	 */
-	virtual int64 Begin() = 0;
+private:
+	/** Comparator for the order of the iteration, which puts the items that come first at the top of a heap. */
+	struct ComesAfter {
+		bool ascending; ///< Whether to iterate ascending or descending.
+		ComesAfter(bool ascending) : ascending(ascending) {}
+		bool operator()(const ScriptListValueItem &a, const ScriptListValueItem &b) const { return this->ascending ? b < a : a < b; }
+	};
+
+	/** Heap of the items that were added or changed while iterating, with the item that comes first at the top. */
+	typedef std::priority_queue<ScriptListValueItem, std::vector<ScriptListValueItem>, ComesAfter> ChangedItems;
+
+	ScriptList *list;                     ///< The list that's being sorted.
+	ScriptList::SorterType sorter_type;   ///< The order to iterate the items in.
+	bool ascending;                       ///< Whether to iterate ascending or descending.
+	std::vector<ScriptListValueItem> order; ///< The sort keys of the items of the list when the iteration started, in the order of iteration.
+	size_t pos;                           ///< Position of the key after #key_next in #order.
+	ChangedItems changed;                 ///< The sort keys of the items that were added or got a new value after #key_next.
+	bool has_no_more_items;               ///< Whether we have more items to iterate over.
+	bool has_item_next;                   ///< Whether #item_next is valid.
+	ScriptListValueItem key_next;         ///< The sort key of the next item we will show.
+	int64 item_next;                      ///< The next item we will show.
 
 	/**
-	 * Stop iterating a sorter.
+	 * Get the key to sort an item on.
+	 * @param item The item.
+	 * @param value The value of the item.
+	 * @return The sort key.
 	 */
-	virtual void End() = 0;
-
-	/**
-	 * Get the next item of the sorter.
-	 */
-	virtual int64 Next() = 0;
-
-	/**
-	 * See if the sorter has reached the end.
-	 */
-	bool IsEnd()
+	ScriptListValueItem GetKey(int64 item, int64 value) const
 	{
-		return this->list->buckets.empty() || this->has_no_more_items;
+		return ScriptListValueItem(this->sorter_type == ScriptList::SORT_BY_VALUE ? value : 0, item);
 	}
 
 	/**
-	 * Callback from the list if an item gets removed.
+	 * Check whether a sort key still belongs to an item in the list.
+	 * @param key The sort key.
+	 * @return True iff the item is in the list, with the value of the key.
 	 */
-	virtual void Remove(int item) = 0;
-
-	/**
-	 * Attach the sorter to a new list. This assumes the content of the old list has been moved to
-	 * the new list, too, so that we don't have to invalidate any iterators. Note that std::swap
-	 * doesn't invalidate iterators on lists and maps, so that should be safe.
-	 * @param target New list to attach to.
-	 */
-	virtual void Retarget(ScriptList *new_list)
+	bool IsInList(const ScriptListValueItem &key) const
 	{
-		this->list = new_list;
+		const int64 *value = this->list->FindValue(key.second);
+		return value != NULL && this->GetKey(key.second, *value) == key;
 	}
-};
 
-/**
- * Sort by value, ascending.
- */
-class ScriptListSorterValueAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
-
-public:
 	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
+	 * Check whether a sort key comes after the next item, and still belongs to an item in the list.
+	 * @param key The sort key.
+	 * @return True iff the key can be the one of the item after the next item.
 	 */
-	ScriptListSorterValueAscending(ScriptList *list)
+	bool IsCandidate(const ScriptListValueItem &key) const
 	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->bucket_iter = this->list->buckets.begin();
-		this->bucket_list = &(*this->bucket_iter).second;
-		this->bucket_list_iter = this->bucket_list->begin();
-		this->item_next = *this->bucket_list_iter;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
-
-	void End()
-	{
-		this->bucket_list = NULL;
-		this->has_no_more_items = true;
-		this->item_next = 0;
+		return ComesAfter(this->ascending)(key, this->key_next) && this->IsInList(key);
 	}
 
 	/**
-	 * Find the next item, and store that information.
+	 * Find the next item that is still in the list, and store that information.
 	 */
 	void FindNext()
 	{
-		if (this->bucket_list == NULL) {
-			this->has_no_more_items = true;
-			return;
-		}
-
-		this->bucket_list_iter++;
-		if (this->bucket_list_iter == this->bucket_list->end()) {
-			this->bucket_iter++;
-			if (this->bucket_iter == this->list->buckets.end()) {
-				this->bucket_list = NULL;
-				return;
-			}
-			this->bucket_list = &(*this->bucket_iter).second;
-			this->bucket_list_iter = this->bucket_list->begin();
+		while (this->pos < this->order.size() && !this->IsCandidate(this->order[this->pos])) {
+			/* Like when walking the list itself, the last skipped item is kept when the end is reached. */
+			this->item_next = this->order[this->pos++].second;
 		}
-		this->item_next = *this->bucket_list_iter;
-	}
+		while (!this->changed.empty() && !this->IsCandidate(this->changed.top())) this->changed.pop();
 
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
-
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
+		if (this->pos < this->order.size() && (this->changed.empty() || !ComesAfter(this->ascending)(this->order[this->pos], this->changed.top()))) {
+			this->key_next = this->order[this->pos++];
+		} else if (!this->changed.empty()) {
+			this->key_next = this->changed.top();
+			this->changed.pop();
+		} else {
+			this->has_item_next = false;
 			return;
 		}
+		this->item_next = this->key_next.second;
 	}
-};
-
-/**
- * Sort by value, descending.
- */
-class ScriptListSorterValueDescending : public ScriptListSorter {
-private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
 
 public:
 	/**
 	 * Create a new sorter.
 	 * @param list The list to sort.
+	 * @param sorter_type The order to iterate the items in.
+	 * @param ascending Whether to iterate ascending or descending.
 	 */
-	ScriptListSorterValueDescending(ScriptList *list)
+	ScriptListSorter(ScriptList *list, ScriptList::SorterType sorter_type, bool ascending) :
+		list(list), sorter_type(sorter_type), ascending(ascending), changed(ComesAfter(ascending))
 	{
-		this->list = list;
 		this->End();
 	}
 
+	/**
+	 * Get the first item of the sorter.
+	 */
 	int64 Begin()
 	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
-
-		/* Go to the end of the bucket-list */
-		this->bucket_iter = this->list->buckets.end();
-		--this->bucket_iter;
-		this->bucket_list = &(*this->bucket_iter).second;
+		this->End();
+		this->list->Compact();
+		if (this->list->items.empty()) return 0;
 
-		/* Go to the end of the items in the bucket */
-		this->bucket_list_iter = this->bucket_list->end();
-		--this->bucket_list_iter;
-		this->item_next = *this->bucket_list_iter;
+		this->order.reserve(this->list->items.size());
+		for (size_t i = 0; i < this->list->items.size(); i++) {
+			this->order.push_back(this->GetKey(this->list->items[i], this->list->values[i]));
+		}
+		if (this->sorter_type == ScriptList::SORT_BY_VALUE) std::sort(this->order.begin(), this->order.end());
+		if (!this->ascending) std::reverse(this->order.begin(), this->order.end());
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		this->has_no_more_items = false;
+		this->has_item_next = true;
+		this->key_next = this->order[0];
+		this->item_next = this->key_next.second;
+		this->pos = 1;
+		return this->Next();
 	}
 
+	/**
+	 * Stop iterating a sorter.
+	 */
 	void End()
 	{
-		this->bucket_list = NULL;
+		this->order.clear();
+		this->pos = 0;
+		this->changed = ChangedItems(ComesAfter(this->ascending));
 		this->has_no_more_items = true;
+		this->has_item_next = false;
 		this->item_next = 0;
 	}
 
 	/**
-	 * Find the next item, and store that information.
+	 * Get the next item of the sorter.
 	 */
-	void FindNext()
-	{
-		if (this->bucket_list == NULL) {
-			this->has_no_more_items = true;
-			return;
-		}
-
-		if (this->bucket_list_iter == this->bucket_list->begin()) {
-			if (this->bucket_iter == this->list->buckets.begin()) {
-				this->bucket_list = NULL;
-				return;
-			}
-			this->bucket_iter--;
-			this->bucket_list = &(*this->bucket_iter).second;
-			/* Go to the end of the items in the bucket */
-			this->bucket_list_iter = this->bucket_list->end();
-			--this->bucket_list_iter;
-		} else {
-			this->bucket_list_iter--;
-		}
-		this->item_next = *this->bucket_list_iter;
-	}
-
 	int64 Next()
 	{
 		if (this->IsEnd()) return 0;
 
+		/* The iteration only ends when an item is asked for after the last one has been handed out. */
+		if (!this->has_item_next) {
+			this->has_no_more_items = true;
+			return this->item_next;
+		}
+
 		int64 item_current = this->item_next;
-		FindNext();
+		this->FindNext();
 		return item_current;
 	}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
-	}
-};
-
-/**
- * Sort by item, ascending.
- */
-class ScriptListSorterItemAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
-
-public:
 	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
+	 * See if the sorter has reached the end.
 	 */
-	ScriptListSorterItemAscending(ScriptList *list)
+	bool IsEnd()
 	{
-		this->list = list;
-		this->End();
+		return this->list->IsEmpty() || this->has_no_more_items;
 	}
 
-	int64 Begin()
+	/**
+	 * Callback from the list if items got removed or got a new value.
+	 */
+	void Remove()
 	{
-		if (this->list->items.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->item_iter = this->list->items.begin();
-		this->item_next = (*this->item_iter).first;
+		if (this->has_no_more_items || !this->has_item_next) return;
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
-
-	void End()
-	{
-		this->has_no_more_items = true;
+		/* If we removed the 'next' item, skip to the next */
+		if (!this->IsInList(this->key_next)) this->FindNext();
 	}
 
 	/**
-	 * Find the next item, and store that information.
+	 * Callback from the list if an item got added or got a new value.
+	 * @param item The item.
+	 * @param value The (new) value of the item.
 	 */
-	void FindNext()
+	void Add(int64 item, int64 value)
 	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		this->item_iter++;
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
-	}
+		if (this->has_no_more_items || !this->has_item_next) return;
 
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		/* Items that come after the 'next' item are still to be shown. */
+		ScriptListValueItem key = this->GetKey(item, value);
+		if (ComesAfter(this->ascending)(key, this->key_next)) this->changed.push(key);
 	}
 
-	void Remove(int item)
+	/**
+	 * Attach the sorter to a new list. This assumes the content of the old list has been moved to
+	 * the new list, too.
+	 * @param new_list New list to attach to.
+	 */
+	void Retarget(ScriptList *new_list)
 	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
+		this->list = new_list;
 	}
 };
 
 /**
- * Sort by item, descending.
+ * Remove all items from a list for which a predicate gives the wanted result,
+ * in a single pass over the list.
+ * @param items The items of the list.
+ * @param values The values of the items.
+ * @param predicate The predicate to test the items and their values with.
+ * @param match The result of the predicate of the items to remove.
+ * @tparam Tpredicate The type of the predicate.
  */
-class ScriptListSorterItemDescending : public ScriptListSorter {
-private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterItemDescending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
+template <class Tpredicate>
+static void RemoveItemsIf(std::vector<int64> &items, std::vector<int64> &values, Tpredicate predicate, bool match)
+{
+	size_t j = 0;
+	for (size_t i = 0; i < items.size(); i++) {
+		if (predicate(items[i], values[i]) == match) continue;
+		items[j] = items[i];
+		values[j] = values[i];
+		j++;
 	}
+	items.resize(j);
+	values.resize(j);
+}
 
-	int64 Begin()
-	{
-		if (this->list->items.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->item_iter = this->list->items.end();
-		--this->item_iter;
-		this->item_next = (*this->item_iter).first;
+/** Predicate for items with a value above a given value. */
+struct ValueAbove {
+	int64 value; ///< The value to compare with.
+	ValueAbove(int64 value) : value(value) {}
+	bool operator()(int64 item, int64 value) const { return value > this->value; }
+};
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
+/** Predicate for items with a value below a given value. */
+struct ValueBelow {
+	int64 value; ///< The value to compare with.
+	ValueBelow(int64 value) : value(value) {}
+	bool operator()(int64 item, int64 value) const { return value < this->value; }
+};
 
-	void End()
-	{
-		this->has_no_more_items = true;
-	}
+/** Predicate for items with a value above start and below end. */
+struct ValueBetween {
+	int64 start; ///< The value the value has to be above.
+	int64 end;   ///< The value the value has to be below.
+	ValueBetween(int64 start, int64 end) : start(start), end(end) {}
+	bool operator()(int64 item, int64 value) const { return value > this->start && value < this->end; }
+};
 
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		if (this->item_iter == this->list->items.begin()) {
-			/* Use 'end' as marker for 'beyond begin' */
-			this->item_iter = this->list->items.end();
-		} else {
-			this->item_iter--;
-		}
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
-	}
+/** Predicate for items with a given value. */
+struct ValueEqual {
+	int64 value; ///< The value to compare with.
+	ValueEqual(int64 value) : value(value) {}
+	bool operator()(int64 item, int64 value) const { return value == this->value; }
+};
 
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
+/** Predicate for items that sort before a given item when sorting by value. */
+struct ValueItemBelow {
+	ScriptListValueItem key; ///< The value and item to compare with.
+	ValueItemBelow(const ScriptListValueItem &key) : key(key) {}
+	bool operator()(int64 item, int64 value) const { return ScriptListValueItem(value, item) < this->key; }
+};
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
+/** Predicate for items that sort after a given item when sorting by value. */
+struct ValueItemAbove {
+	ScriptListValueItem key; ///< The value and item to compare with.
+	ValueItemAbove(const ScriptListValueItem &key) : key(key) {}
+	bool operator()(int64 item, int64 value) const { return this->key < ScriptListValueItem(value, item); }
+};
 
-	void Remove(int item)
+/**
+ * Predicate for items that are in another list. As the items of both lists
+ * are sorted, it must be called for the items in ascending order.
+ */
+struct ItemInList {
+	std::vector<int64>::const_iterator iter; ///< The first item of the other list that is not below the last tested item.
+	std::vector<int64>::const_iterator end;  ///< The end of the items of the other list.
+	ItemInList(const std::vector<int64> &items) : iter(items.begin()), end(items.end()) {}
+	bool operator()(int64 item, int64 value)
 	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
+		while (this->iter != this->end && *this->iter < item) this->iter++;
+		return this->iter != this->end && *this->iter == item;
 	}
 };
 
+/**
+ * Get the item at a position when sorting a list ascending by value.
+ * @param items The items of the list.
+ * @param values The values of the items.
+ * @param n The position of the wanted item.
+ * @pre n < items.size()
+ * @return The value and the item at the position.
+ */
+static ScriptListValueItem GetNthByValue(const std::vector<int64> &items, const std::vector<int64> &values, size_t n)
+{
+	std::vector<ScriptListValueItem> sorted;
+	sorted.reserve(items.size());
+	for (size_t i = 0; i < items.size(); i++) {
+		sorted.push_back(ScriptListValueItem(values[i], items[i]));
+	}
+	std::nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+	return sorted[n];
+}
 
 
 ScriptList::ScriptList()
 {
 	/* Default sorter */
-	this->sorter         = new ScriptListSorterValueDescending(this);
+	this->sorter         = new ScriptListSorter(this, SORT_BY_VALUE, false);
 	this->sorter_type    = SORT_BY_VALUE;
 	this->sort_ascending = false;
 	this->initialized    = false;
 	this->modifications  = 0;
+	this->num_removed    = 0;
 }
 
 ScriptList::~ScriptList()
@@ -421,9 +336,80 @@ ScriptList::~ScriptList()
 	delete this->sorter;
 }
 
+/**
+ * Merge the items that were added out of order into the list, and drop the
+ * removed items, so #items and #values hold exactly the items of the list.
+ */
+void ScriptList::Compact()
+{
+	if (this->num_removed == 0 && this->added_items.empty()) return;
+
+	std::vector<int64> items;
+	std::vector<int64> values;
+	items.reserve(this->items.size() - this->num_removed + this->added_items.size());
+	values.reserve(items.capacity());
+
+	size_t i = 0;
+	size_t j = 0;
+	while (i < this->items.size() || j < this->added_items.size()) {
+		if (i < this->items.size() && this->num_removed != 0 && this->removed[i]) {
+			i++;
+		} else if (j == this->added_items.size() || (i < this->items.size() && this->items[i] < this->added_items[j])) {
+			items.push_back(this->items[i]);
+			values.push_back(this->values[i]);
+			i++;
+		} else {
+			items.push_back(this->added_items[j]);
+			values.push_back(this->added_values[j]);
+			j++;
+		}
+	}
+
+	this->items.swap(items);
+	this->values.swap(values);
+	this->removed.clear();
+	this->num_removed = 0;
+	this->added_items.clear();
+	this->added_values.clear();
+}
+
+/**
+ * Find the value of an item in the list.
+ * @param item The item to look for.
+ * @return The value of the item, or \c NULL when it is not in the list.
+ */
+int64 *ScriptList::FindValue(int64 item)
+{
+	std::vector<int64>::const_iterator iter = std::lower_bound(this->items.begin(), this->items.end(), item);
+	if (iter != this->items.end() && *iter == item) {
+		size_t index = iter - this->items.begin();
+		return this->removed.empty() || !this->removed[index] ? &this->values[index] : NULL;
+	}
+
+	iter = std::lower_bound(this->added_items.begin(), this->added_items.end(), item);
+	if (iter != this->added_items.end() && *iter == item) return &this->added_values[iter - this->added_items.begin()];
+	return NULL;
+}
+
+/**
+ * Give all items of the list a new value at once.
+ * @param values The new values, at the same index as the item in #items; gets the old values.
+ * @pre The list is compacted, so #items holds exactly the items of the list.
+ */
+void ScriptList::SwapValues(std::vector<int64> &values)
+{
+	assert(this->num_removed == 0 && this->added_items.empty() && values.size() == this->items.size());
+
+	this->modifications++;
+	this->values.swap(values);
+
+	this->sorter->Remove();
+	for (size_t i = 0; i < this->items.size(); i++) this->sorter->Add(this->items[i], this->values[i]);
+}
+
 bool ScriptList::HasItem(int64 item)
 {
-	return this->items.count(item) == 1;
+	return this->FindValue(item) != NULL;
 }
 
 void ScriptList::Clear()
@@ -431,7 +417,11 @@ void ScriptList::Clear()
 	this->modifications++;
 
 	this->items.clear();
-	this->buckets.clear();
+	this->values.clear();
+	this->removed.clear();
+	this->num_removed = 0;
+	this->added_items.clear();
+	this->added_values.clear();
 	this->sorter->End();
 }
 
@@ -439,27 +429,60 @@ void ScriptList::AddItem(int64 item, int64 value)
 {
 	this->modifications++;
 
-	if (this->HasItem(item)) return;
+	/* Items are usually added in ascending order, so they can be appended. */
+	if (this->items.empty() || item > this->items.back()) {
+		this->items.push_back(item);
+		this->values.push_back(value);
+		if (!this->removed.empty()) this->removed.push_back(false);
+		this->sorter->Add(item, value);
+		return;
+	}
+
+	std::vector<int64>::iterator iter = std::lower_bound(this->items.begin(), this->items.end(), item);
+	if (*iter == item) {
+		/* A removed item is still in its place, so it can be added back there. */
+		size_t index = iter - this->items.begin();
+		if (!this->removed.empty() && this->removed[index]) {
+			this->removed[index] = false;
+			this->num_removed--;
+			this->values[index] = value;
+			this->sorter->Add(item, value);
+		}
+		return;
+	}
+
+	/* Other items are kept aside, and merged into the list once there are too many to keep aside cheaply. */
+	iter = std::lower_bound(this->added_items.begin(), this->added_items.end(), item);
+	if (iter != this->added_items.end() && *iter == item) return;
 
-	this->items[item] = value;
-	this->buckets[value].insert(item);
+	this->added_values.insert(this->added_values.begin() + (iter - this->added_items.begin()), value);
+	this->added_items.insert(iter, item);
+	if (this->added_items.size() > 16 && this->added_items.size() * this->added_items.size() > this->items.size()) this->Compact();
+	this->sorter->Add(item, value);
 }
 
 void ScriptList::RemoveItem(int64 item)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return;
+	std::vector<int64>::iterator iter = std::lower_bound(this->items.begin(), this->items.end(), item);
+	if (iter != this->items.end() && *iter == item) {
+		/* Only mark the item as removed; removed items are dropped all at once when there are many. */
+		size_t index = iter - this->items.begin();
+		if (this->removed.empty()) this->removed.resize(this->items.size(), false);
+		if (this->removed[index]) return;
 
-	int64 value = item_iter->second;
+		this->removed[index] = true;
+		this->num_removed++;
+		if (this->num_removed > this->items.size() / 2) this->Compact();
+	} else {
+		iter = std::lower_bound(this->added_items.begin(), this->added_items.end(), item);
+		if (iter == this->added_items.end() || *iter != item) return;
 
-	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	this->items.erase(item_iter);
+		this->added_values.erase(this->added_values.begin() + (iter - this->added_items.begin()));
+		this->added_items.erase(iter);
+	}
+	this->sorter->Remove();
 }
 
 int64 ScriptList::Begin()
@@ -479,7 +502,7 @@ int64 ScriptList::Next()
 
 bool ScriptList::IsEmpty()
 {
-	return this->items.empty();
+	return this->Count() == 0;
 }
 
 bool ScriptList::IsEnd()
@@ -493,33 +516,26 @@ bool ScriptList::IsEnd()
 
 int32 ScriptList::Count()
 {
-	return (int32)this->items.size();
+	return (int32)(this->items.size() - this->num_removed + this->added_items.size());
 }
 
 int64 ScriptList::GetValue(int64 item)
 {
-	ScriptListMap::const_iterator item_iter = this->items.find(item);
-	return item_iter == this->items.end() ? 0 : item_iter->second;
+	const int64 *value = this->FindValue(item);
+	return value == NULL ? 0 : *value;
 }
 
 bool ScriptList::SetValue(int64 item, int64 value)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return false;
-
-	int64 value_old = item_iter->second;
-	if (value_old == value) return true;
-
-	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value_old);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	item_iter->second = value;
-	this->buckets[value].insert(item);
+	int64 *item_value = this->FindValue(item);
+	if (item_value == NULL) return false;
+	if (*item_value == value) return true;
 
+	*item_value = value;
+	this->sorter->Remove();
+	this->sorter->Add(item, value);
 	return true;
 }
 
@@ -531,25 +547,7 @@ void ScriptList::Sort(SorterType sorter, bool ascending)
 	if (sorter == this->sorter_type && ascending == this->sort_ascending) return;
 
 	delete this->sorter;
-	switch (sorter) {
-		case SORT_BY_ITEM:
-			if (ascending) {
-				this->sorter = new ScriptListSorterItemAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterItemDescending(this);
-			}
-			break;
-
-		case SORT_BY_VALUE:
-			if (ascending) {
-				this->sorter = new ScriptListSorterValueAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterValueDescending(this);
-			}
-			break;
-
-		default: NOT_REACHED();
-	}
+	this->sorter         = new ScriptListSorter(this, sorter, ascending);
 	this->sorter_type    = sorter;
 	this->sort_ascending = ascending;
 	this->initialized    = false;
@@ -559,11 +557,37 @@ void ScriptList::AddList(ScriptList *list)
 {
 	if (list == this) return;
 
-	ScriptListMap *list_items = &list->items;
-	for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-		this->AddItem((*iter).first);
-		this->SetValue((*iter).first, (*iter).second);
+	this->modifications++;
+
+	this->Compact();
+	list->Compact();
+
+	/* Merge both lists; items that are in both get the value of the other list. */
+	std::vector<int64> items;
+	std::vector<int64> values;
+	items.reserve(this->items.size() + list->items.size());
+	values.reserve(this->items.size() + list->items.size());
+
+	size_t i = 0;
+	size_t j = 0;
+	while (i < this->items.size() || j < list->items.size()) {
+		if (j == list->items.size() || (i < this->items.size() && this->items[i] < list->items[j])) {
+			items.push_back(this->items[i]);
+			values.push_back(this->values[i]);
+			i++;
+		} else {
+			if (i < this->items.size() && this->items[i] == list->items[j]) i++;
+			items.push_back(list->items[j]);
+			values.push_back(list->values[j]);
+			j++;
+		}
 	}
+
+	this->items.swap(items);
+	this->values.swap(values);
+
+	this->sorter->Remove();
+	for (size_t i = 0; i < list->items.size(); i++) this->sorter->Add(list->items[i], list->values[i]);
 }
 
 void ScriptList::SwapList(ScriptList *list)
@@ -571,7 +595,11 @@ void ScriptList::SwapList(ScriptList *list)
 	if (list == this) return;
 
 	this->items.swap(list->items);
-	this->buckets.swap(list->buckets);
+	this->values.swap(list->values);
+	this->removed.swap(list->removed);
+	Swap(this->num_removed, list->num_removed);
+	this->added_items.swap(list->added_items);
+	this->added_values.swap(list->added_values);
 	Swap(this->sorter, list->sorter);
 	Swap(this->sorter_type, list->sorter_type);
 	Swap(this->sort_ascending, list->sort_ascending);
@@ -585,40 +613,36 @@ void ScriptList::RemoveAboveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > value) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueAbove(value), true);
+	this->sorter->Remove();
 }
 
 void ScriptList::RemoveBelowValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second < value) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueBelow(value), true);
+	this->sorter->Remove();
 }
 
 void ScriptList::RemoveBetweenValue(int64 start, int64 end)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > start && (*iter).second < end) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueBetween(start, end), true);
+	this->sorter->Remove();
 }
 
 void ScriptList::RemoveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second == value) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueEqual(value), true);
+	this->sorter->Remove();
 }
 
 void ScriptList::RemoveTop(int32 count)
@@ -632,30 +656,26 @@ void ScriptList::RemoveTop(int32 count)
 		return;
 	}
 
+	if (count <= 0) return;
+
+	this->Compact();
+	if ((size_t)count >= this->items.size()) {
+		this->Clear();
+		return;
+	}
+
 	switch (this->sorter_type) {
 		default: NOT_REACHED();
 		case SORT_BY_VALUE:
-			for (ScriptListBucket::iterator iter = this->buckets.begin(); iter != this->buckets.end(); iter = this->buckets.begin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::iterator iter = items->begin(); iter != items->end(); iter = items->begin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
-			}
+			RemoveItemsIf(this->items, this->values, ValueItemBelow(GetNthByValue(this->items, this->values, count)), true);
 			break;
 
 		case SORT_BY_ITEM:
-			for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter = this->items.begin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
-			}
+			this->items.erase(this->items.begin(), this->items.begin() + count);
+			this->values.erase(this->values.begin(), this->values.begin() + count);
 			break;
 	}
+	this->sorter->Remove();
 }
 
 void ScriptList::RemoveBottom(int32 count)
@@ -669,30 +689,26 @@ void ScriptList::RemoveBottom(int32 count)
 		return;
 	}
 
+	if (count <= 0) return;
+
+	this->Compact();
+	if ((size_t)count >= this->items.size()) {
+		this->Clear();
+		return;
+	}
+
 	switch (this->sorter_type) {
 		default: NOT_REACHED();
 		case SORT_BY_VALUE:
-			for (ScriptListBucket::reverse_iterator iter = this->buckets.rbegin(); iter != this->buckets.rend(); iter = this->buckets.rbegin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::reverse_iterator iter = items->rbegin(); iter != items->rend(); iter = items->rbegin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
-			}
+			RemoveItemsIf(this->items, this->values, ValueItemAbove(GetNthByValue(this->items, this->values, this->items.size() - count - 1)), true);
 			break;
 
 		case SORT_BY_ITEM:
-			for (ScriptListMap::reverse_iterator iter = this->items.rbegin(); iter != this->items.rend(); iter = this->items.rbegin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
-			}
+			this->items.resize(this->items.size() - count);
+			this->values.resize(this->values.size() - count);
 			break;
 	}
+	this->sorter->Remove();
 }
 
 void ScriptList::RemoveList(ScriptList *list)
@@ -702,10 +718,10 @@ void ScriptList::RemoveList(ScriptList *list)
 	if (list == this) {
 		Clear();
 	} else {
-		ScriptListMap *list_items = &list->items;
-		for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-			this->RemoveItem((*iter).first);
-		}
+		this->Compact();
+		list->Compact();
+		RemoveItemsIf(this->items, this->values, ItemInList(list->items), true);
+		this->sorter->Remove();
 	}
 }
 
@@ -713,40 +729,36 @@ void ScriptList::KeepAboveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= value) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueAbove(value), false);
+	this->sorter->Remove();
 }
 
 void ScriptList::KeepBelowValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second >= value) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueBelow(value), false);
+	this->sorter->Remove();
 }
 
 void ScriptList::KeepBetweenValue(int64 start, int64 end)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= start || (*iter).second >= end) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueBetween(start, end), false);
+	this->sorter->Remove();
 }
 
 void ScriptList::KeepValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second != value) this->RemoveItem((*iter).first);
-	}
+	this->Compact();
+	RemoveItemsIf(this->items, this->values, ValueEqual(value), false);
+	this->sorter->Remove();
 }
 
 void ScriptList::KeepTop(int32 count)
@@ -769,10 +781,10 @@ void ScriptList::KeepList(ScriptList *list)
 
 	this->modifications++;
 
-	ScriptList tmp;
-	tmp.AddList(this);
-	tmp.RemoveList(list);
-	this->RemoveList(&tmp);
+	this->Compact();
+	list->Compact();
+	RemoveItemsIf(this->items, this->values, ItemInList(list->items), false);
+	this->sorter->Remove();
 }
 
 SQInteger ScriptList::_get(HSQUIRRELVM vm)
@@ -782,10 +794,10 @@ SQInteger ScriptList::_get(HSQUIRRELVM vm)
 	SQInteger idx;
 	sq_getinteger(vm, 2, &idx);
 
-	ScriptListMap::const_iterator item_iter = this->items.find(idx);
-	if (item_iter == this->items.end()) return SQ_ERROR;
+	const int64 *value = this->FindValue(idx);
+	if (value == NULL) return SQ_ERROR;
 
-	sq_pushinteger(vm, item_iter->second);
+	sq_pushinteger(vm, *value);
 	return 1;
 }
 
@@ -864,16 +876,17 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 	/* Push the function to call */
 	sq_push(vm, 2);
 
-	for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter++) {
+	this->Compact();
+	for (size_t i = 0; i < this->items.size(); i++) {
 		/* Check for changing of items. */
 		int previous_modification_count = this->modifications;
 
 		/* Push the root table as instance object, this is what squirrel does for meta-functions. */
 		sq_pushroottable(vm);
 		/* Push all arguments for the valuator function. */
-		sq_pushinteger(vm, (*iter).first);
-		for (int i = 0; i < nparam - 1; i++) {
-			sq_push(vm, i + 3);
+		sq_pushinteger(vm, this->items[i]);
+		for (int j = 0; j < nparam - 1; j++) {
+			sq_push(vm, j + 3);
 		}
 
 		/* Call the function. Squirrel pops all parameters and pushes the return value. */
@@ -925,7 +938,12 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 			return sq_throwerror(vm, "modifying valuated list outside of valuator function");
 		}
 
-		this->SetValue((*iter).first, value);
+		/* The list did not change, so the item is still at the same position. */
+		if (this->values[i] != value) {
+			this->values[i] = value;
+			this->sorter->Remove();
+			this->sorter->Add(this->items[i], value);
+		}
 
 		/* Pop the return value. */
 		sq_poptop(vm);
@@ -14,8 +14,7 @@
 #define SCRIPT_LIST_HPP
 
 #include "script_object.hpp"
-#include <map>
-#include <set>
+#include <vector>
 
 class ScriptListSorter;
 
@@ -41,16 +40,23 @@ private:
 	SorterType sorter_type;       ///< Sorting type
 	bool sort_ascending;          ///< Whether to sort ascending or descending
 	bool initialized;             ///< Whether an iteration has been started
-	int modifications;            ///< Number of modification that has been done. To prevent changing data while valuating.
 
-public:
-	typedef std::set<int64> ScriptItemList;                   ///< The list of items inside the bucket
-	typedef std::map<int64, ScriptItemList> ScriptListBucket; ///< The bucket list per value
-	typedef std::map<int64, int64> ScriptListMap;             ///< List per item
+	friend class ScriptListSorter;
 
-	ScriptListMap items;           ///< The items in the list
-	ScriptListBucket buckets;      ///< The items in the list, sorted by value
+protected:
+	int modifications;            ///< Number of modification that has been done. To prevent changing data while valuating.
+	std::vector<int64> items;        ///< The items in the list, sorted ascending; also the removed ones in #removed, but not those in #added_items.
+	std::vector<int64> values;       ///< The values of the items, at the same index as the item in #items.
+	std::vector<bool> removed;       ///< Whether the item at the same index in #items has been removed from the list; empty when none has.
+	size_t num_removed;              ///< Number of removed items in #items.
+	std::vector<int64> added_items;  ///< Items added out of order, sorted ascending, until they are merged into #items.
+	std::vector<int64> added_values; ///< The values of the items, at the same index as the item in #added_items.
 
+	void Compact();
+	int64 *FindValue(int64 item);
+	void SwapValues(std::vector<int64> &values);
+
+public:
 	ScriptList();
 	~ScriptList();
 
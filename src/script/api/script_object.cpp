@@ -22,6 +22,7 @@
 #include "../script_storage.hpp"
 #include "../script_instance.hpp"
 #include "../script_fatalerror.hpp"
+#include "../script_thread.hpp"
 #include "script_error.hpp"
 
 #include "../../safeguards.h"
@@ -36,7 +37,7 @@ static ScriptStorage *GetStorage()
 }
 
 
-/* static */ ScriptInstance *ScriptObject::ActiveInstance::active = NULL;
+/* static */ thread_local ScriptInstance *ScriptObject::ActiveInstance::active = NULL;
 
 ScriptObject::ActiveInstance::ActiveInstance(ScriptInstance *instance)
 {
@@ -278,6 +279,11 @@ ScriptObject::ActiveInstance::~ActiveInstance()
 	return GetStorage()->callback_value[index];
 }
 
+/* static */ void ScriptObject::DecreaseOps(int amount)
+{
+	Squirrel::DecreaseOps(GetActiveInstance()->engine->GetVM(), amount);
+}
+
 /* static */ bool ScriptObject::DoCommand(TileIndex tile, uint32 p1, uint32 p2, uint cmd, const char *text, Script_SuspendCallbackProc *callback)
 {
 	if (!ScriptObject::CanSuspend()) {
@@ -306,6 +312,9 @@ ScriptObject::ActiveInstance::~ActiveInstance()
 	if (GetCommandFlags(cmd) & CMD_CLIENT_ID && p2 == 0) p2 = UINT32_MAX;
 #endif
 
+	/* When running concurrently with other scripts, wait till it is our turn to change the game. */
+	if (!estimate_only) ScriptThread::WaitForCommandTurn();
+
 	/* Try to perform the command. */
 	CommandCost res = ::DoCommandPInternal(tile, p1, p2, cmd, (_networking && !_generating_world) ? ScriptObject::GetActiveInstance()->GetDoCommandCallback() : NULL, text, false, estimate_only);
 
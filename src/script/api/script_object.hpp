@@ -49,7 +49,7 @@ protected:
 	private:
 		ScriptInstance *last_active;    ///< The active instance before we go instantiated.
 
-		static ScriptInstance *active;  ///< The global current active instance.
+		static thread_local ScriptInstance *active; ///< The current active instance of this thread.
 	};
 
 public:
@@ -71,6 +71,12 @@ protected:
 	 */
 	static bool DoCommand(TileIndex tile, uint32 p1, uint32 p2, uint cmd, const char *text = NULL, Script_SuspendCallbackProc *callback = NULL);
 
+	/**
+	 * Charge the script for work done on its behalf by the API.
+	 * @param amount The number of opcodes to charge.
+	 */
+	static void DecreaseOps(int amount);
+
 	/**
 	 * Sets the DoCommand costs counter to a value.
 	 */
@@ -12,8 +12,10 @@
 #include "../../stdafx.h"
 #include "script_tilelist.hpp"
 #include "script_industry.hpp"
+#include "script_tile.hpp"
 #include "../../industry.h"
 #include "../../station_base.h"
+#include "../../thread/thread.h"
 
 #include "../../safeguards.h"
 
@@ -49,6 +51,87 @@ void ScriptTileList::RemoveTile(TileIndex tile)
 	this->RemoveItem(tile);
 }
 
+/** Number of tiles from which on ValuateTiles divides the work over multiple threads. */
+static const uint VALUATE_TILES_THREAD_THRESHOLD = 16384;
+
+/** The tiles of a ValuateTiles call. */
+struct ValuateTilesJob {
+	ScriptTileList::TileValuator valuator; ///< The valuator to use.
+	int32 param;                           ///< The parameter of the valuator.
+	const TileIndex *tiles;                ///< The tiles to valuate.
+	int64 *values;                         ///< Where to store the values of the tiles.
+};
+
+/**
+ * Get the value of a tile for ValuateTiles.
+ * This only reads the map, so it can be called from any thread.
+ * @param valuator The valuator to use.
+ * @param tile The tile to valuate.
+ * @param param The parameter of the valuator.
+ * @return The value of the tile.
+ */
+static int64 GetTileValuatorValue(ScriptTileList::TileValuator valuator, TileIndex tile, int32 param)
+{
+	switch (valuator) {
+		case ScriptTileList::TV_IS_BUILDABLE:                   return ScriptTile::IsBuildable(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_WATER_TILE:                  return ScriptTile::IsWaterTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_COAST_TILE:                  return ScriptTile::IsCoastTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_STATION_TILE:                return ScriptTile::IsStationTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_HAS_TREE_ON_TILE:               return ScriptTile::HasTreeOnTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_FARM_TILE:                   return ScriptTile::IsFarmTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_ROCK_TILE:                   return ScriptTile::IsRockTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_ROUGH_TILE:                  return ScriptTile::IsRoughTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_SNOW_TILE:                   return ScriptTile::IsSnowTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_IS_DESERT_TILE:                 return ScriptTile::IsDesertTile(tile) ? 1 : 0;
+		case ScriptTileList::TV_GET_TERRAIN_TYPE:               return ScriptTile::GetTerrainType(tile);
+		case ScriptTileList::TV_GET_SLOPE:                      return ScriptTile::GetSlope(tile);
+		case ScriptTileList::TV_GET_MIN_HEIGHT:                 return ScriptTile::GetMinHeight(tile);
+		case ScriptTileList::TV_GET_MAX_HEIGHT:                 return ScriptTile::GetMaxHeight(tile);
+		case ScriptTileList::TV_GET_OWNER:                      return ScriptTile::GetOwner(tile);
+		case ScriptTileList::TV_HAS_TRANSPORT_TYPE:             return ScriptTile::HasTransportType(tile, (ScriptTile::TransportType)param) ? 1 : 0;
+		case ScriptTileList::TV_GET_DISTANCE_MANHATTAN_TO_TILE: return ScriptTile::GetDistanceManhattanToTile(tile, (TileIndex)param);
+		case ScriptTileList::TV_GET_DISTANCE_SQUARE_TO_TILE:    return ScriptTile::GetDistanceSquareToTile(tile, (TileIndex)param);
+		case ScriptTileList::TV_IS_WITHIN_TOWN_INFLUENCE:       return ScriptTile::IsWithinTownInfluence(tile, (TownID)param) ? 1 : 0;
+		case ScriptTileList::TV_GET_TOWN_AUTHORITY:             return ScriptTile::GetTownAuthority(tile);
+		case ScriptTileList::TV_GET_CLOSEST_TOWN:               return ScriptTile::GetClosestTown(tile);
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Valuate a part of the tiles of a job.
+ * @param part Unused.
+ * @param begin The index of the first tile to valuate.
+ * @param end The index after the one of the last tile to valuate.
+ * @param data The ValuateTilesJob.
+ */
+static void ValuateTilesThread(uint part, uint begin, uint end, void *data)
+{
+	ValuateTilesJob *job = (ValuateTilesJob *)data;
+	for (uint i = begin; i < end; i++) {
+		job->values[i] = GetTileValuatorValue(job->valuator, job->tiles[i], job->param);
+	}
+}
+
+void ScriptTileList::ValuateTiles(TileValuator valuator, int32 param)
+{
+	if (valuator < TV_IS_BUILDABLE || valuator > TV_GET_CLOSEST_TOWN) return;
+	this->Compact();
+	if (this->items.empty()) return;
+
+	std::vector<TileIndex> tiles(this->items.begin(), this->items.end());
+	std::vector<int64> values(tiles.size());
+
+	/* The map is not changed while valuating, so large lists can be valuated by multiple threads. */
+	uint num_threads = tiles.size() < VALUATE_TILES_THREAD_THRESHOLD ? 1 : GetCPUCoreCount();
+	ValuateTilesJob job = { valuator, param, &tiles[0], &values[0] };
+	RunParallel(&ValuateTilesThread, &job, (uint)tiles.size(), num_threads, "ottd:valuate");
+
+	this->SwapValues(values);
+
+	ScriptObject::DecreaseOps((int)tiles.size());
+}
+
 ScriptTileList_IndustryAccepting::ScriptTileList_IndustryAccepting(IndustryID industry_id, int radius)
 {
 	if (!ScriptIndustry::IsValidIndustry(industry_id) || radius <= 0) return;
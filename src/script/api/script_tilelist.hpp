@@ -22,6 +22,33 @@
  */
 class ScriptTileList : public ScriptList {
 public:
+	/**
+	 * The valuators that can be used with ValuateTiles.
+	 */
+	enum TileValuator {
+		TV_IS_BUILDABLE,                   ///< ScriptTile::IsBuildable(tile).
+		TV_IS_WATER_TILE,                  ///< ScriptTile::IsWaterTile(tile).
+		TV_IS_COAST_TILE,                  ///< ScriptTile::IsCoastTile(tile).
+		TV_IS_STATION_TILE,                ///< ScriptTile::IsStationTile(tile).
+		TV_HAS_TREE_ON_TILE,               ///< ScriptTile::HasTreeOnTile(tile).
+		TV_IS_FARM_TILE,                   ///< ScriptTile::IsFarmTile(tile).
+		TV_IS_ROCK_TILE,                   ///< ScriptTile::IsRockTile(tile).
+		TV_IS_ROUGH_TILE,                  ///< ScriptTile::IsRoughTile(tile).
+		TV_IS_SNOW_TILE,                   ///< ScriptTile::IsSnowTile(tile).
+		TV_IS_DESERT_TILE,                 ///< ScriptTile::IsDesertTile(tile).
+		TV_GET_TERRAIN_TYPE,               ///< ScriptTile::GetTerrainType(tile).
+		TV_GET_SLOPE,                      ///< ScriptTile::GetSlope(tile).
+		TV_GET_MIN_HEIGHT,                 ///< ScriptTile::GetMinHeight(tile).
+		TV_GET_MAX_HEIGHT,                 ///< ScriptTile::GetMaxHeight(tile).
+		TV_GET_OWNER,                      ///< ScriptTile::GetOwner(tile).
+		TV_HAS_TRANSPORT_TYPE,             ///< ScriptTile::HasTransportType(tile, param).
+		TV_GET_DISTANCE_MANHATTAN_TO_TILE, ///< ScriptTile::GetDistanceManhattanToTile(tile, param).
+		TV_GET_DISTANCE_SQUARE_TO_TILE,    ///< ScriptTile::GetDistanceSquareToTile(tile, param).
+		TV_IS_WITHIN_TOWN_INFLUENCE,       ///< ScriptTile::IsWithinTownInfluence(tile, param).
+		TV_GET_TOWN_AUTHORITY,             ///< ScriptTile::GetTownAuthority(tile).
+		TV_GET_CLOSEST_TOWN,               ///< ScriptTile::GetClosestTown(tile).
+	};
+
 	/**
 	 * Adds the rectangle between tile_from and tile_to to the to-be-evaluated tiles.
 	 * @param tile_from One corner of the tiles to add.
@@ -53,6 +80,21 @@ public:
 	 * @pre ScriptMap::IsValidTile(tile).
 	 */
 	void RemoveTile(TileIndex tile);
+
+	/**
+	 * Give all tiles in the list a value defined by one of the built-in
+	 *  valuators. The values are the same as Valuate() with the corresponding
+	 *  ScriptTile function gives, but without calling a function for every
+	 *  tile, which makes this a lot faster for large lists.
+	 * @param valuator The valuator to use.
+	 * @param param The second parameter of the corresponding ScriptTile
+	 *  function, if it has one. Otherwise it is ignored.
+	 * @note Valuating costs one opcode per tile.
+	 * @note Example:
+	 *  list.ValuateTiles(ScriptTileList.TV_IS_BUILDABLE, 0);
+	 *  list.ValuateTiles(ScriptTileList.TV_GET_DISTANCE_MANHATTAN_TO_TILE, home_tile);
+	 */
+	void ValuateTiles(TileValuator valuator, int32 param);
 };
 
 /**
@@ -31,18 +31,10 @@ ScriptVehicleList_Station::ScriptVehicleList_Station(StationID station_id)
 {
 	if (!ScriptBaseStation::IsValidBaseStation(station_id)) return;
 
-	const Vehicle *v;
-	FOR_ALL_VEHICLES(v) {
-		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle()) {
-			const Order *order;
-
-			FOR_VEHICLE_ORDERS(v, order) {
-				if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT)) && order->GetDestination() == station_id) {
-					this->AddItem(v->index);
-					break;
-				}
-			}
-		}
+	SmallVector<const Vehicle *, 32> vehicles;
+	FindVehiclesWithOrderDestination(1 << ODK_STATION, station_id, &vehicles);
+	for (const Vehicle * const *it = vehicles.Begin(); it != vehicles.End(); it++) {
+		if ((*it)->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) this->AddItem((*it)->index);
 	}
 }
 
@@ -82,18 +74,10 @@ ScriptVehicleList_Depot::ScriptVehicleList_Depot(TileIndex tile)
 			return;
 	}
 
-	const Vehicle *v;
-	FOR_ALL_VEHICLES(v) {
-		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle() && v->type == type) {
-			const Order *order;
-
-			FOR_VEHICLE_ORDERS(v, order) {
-				if (order->IsType(OT_GOTO_DEPOT) && order->GetDestination() == dest) {
-					this->AddItem(v->index);
-					break;
-				}
-			}
-		}
+	SmallVector<const Vehicle *, 32> vehicles;
+	FindVehiclesWithOrderDestination(1 << ODK_DEPOT | 1 << ODK_NEAREST_DEPOT, dest, &vehicles);
+	for (const Vehicle * const *it = vehicles.Begin(); it != vehicles.End(); it++) {
+		if (((*it)->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && (*it)->type == type) this->AddItem((*it)->index);
 	}
 }
 
@@ -19,6 +19,7 @@
 #include "script_storage.hpp"
 #include "script_info.hpp"
 #include "script_instance.hpp"
+#include "script_profiler.hpp"
 
 #include "api/script_controller.hpp"
 #include "api/script_error.hpp"
@@ -28,6 +29,7 @@
 #include "../company_base.h"
 #include "../company_func.h"
 #include "../fileio_func.h"
+#include "../framerate_type.h"
 
 #include "../safeguards.h"
 
@@ -60,7 +62,9 @@ ScriptInstance::ScriptInstance(const char *APIName) :
 	is_save_data_on_stack(false),
 	suspend(0),
 	is_paused(false),
-	callback(NULL)
+	in_garbage_collection(false),
+	callback(NULL),
+	profiler(NULL)
 {
 	this->storage = new ScriptStorage();
 	this->engine  = new Squirrel(APIName);
@@ -139,6 +143,7 @@ ScriptInstance::~ScriptInstance()
 	if (engine != NULL) delete this->engine;
 	delete this->storage;
 	delete this->controller;
+	delete this->profiler;
 	free(this->instance);
 }
 
@@ -248,9 +253,25 @@ void ScriptInstance::GameLoop()
 	}
 }
 
-void ScriptInstance::CollectGarbage() const
+/**
+ * The number of references the garbage collector marks per step. About a
+ * million references take up to a few milliseconds, so this keeps each step
+ * well below a millisecond while a collection of even a large script is done
+ * within a few dozen ticks.
+ */
+static const int SCRIPT_GC_WORK_PER_STEP = 1 << 16;
+
+void ScriptInstance::CollectGarbage()
+{
+	if (!this->is_started || this->IsDead()) return;
+
+	PerformanceAccumulator framerate(PFE_GL_SCRIPT_GC);
+	this->in_garbage_collection = !this->engine->CollectGarbageStep(SCRIPT_GC_WORK_PER_STEP);
+}
+
+void ScriptInstance::ContinueGarbageCollection()
 {
-	if (this->is_started && !this->IsDead()) this->engine->CollectGarbage();
+	if (this->in_garbage_collection) this->CollectGarbage();
 }
 
 /* static */ void ScriptInstance::DoCommandReturn(ScriptInstance *instance)
@@ -551,6 +572,17 @@ bool ScriptInstance::IsPaused()
 	return this->is_paused;
 }
 
+void ScriptInstance::StartProfiling()
+{
+	if (this->profiler == NULL) this->profiler = new ScriptProfiler();
+	if (this->engine != NULL) this->engine->SetProfiler(this->profiler);
+}
+
+void ScriptInstance::StopProfiling()
+{
+	if (this->engine != NULL) this->engine->SetProfiler(NULL);
+}
+
 /* static */ bool ScriptInstance::LoadObjects(HSQUIRRELVM vm)
 {
 	SlObject(NULL, _script_byte);
@@ -68,9 +68,17 @@ public:
 	void GameLoop();
 
 	/**
-	 * Let the VM collect any garbage.
+	 * Let the VM collect any garbage. The garbage is collected in small
+	 *  steps, the first of which is done now; the rest of the steps are
+	 *  done by ContinueGarbageCollection.
 	 */
-	void CollectGarbage() const;
+	void CollectGarbage();
+
+	/**
+	 * Do the next step of a garbage collection started by CollectGarbage,
+	 *  if one is in progress.
+	 */
+	void ContinueGarbageCollection();
 
 	/**
 	 * Get the storage of this script.
@@ -169,6 +177,23 @@ public:
 	 */
 	void Unpause();
 
+	/**
+	 * Start measuring where the script spends its time and operations.
+	 * What was measured before is kept.
+	 */
+	void StartProfiling();
+
+	/**
+	 * Stop measuring where the script spends its time and operations.
+	 */
+	void StopProfiling();
+
+	/**
+	 * Get the profile of the script.
+	 * @return The profiler, or \c NULL when the script was never profiled.
+	 */
+	class ScriptProfiler *GetProfiler() { return this->profiler; }
+
 	/**
 	 * Get the number of operations the script can execute before being suspended.
 	 * This function is safe to call from within a function called by the script.
@@ -240,7 +265,9 @@ private:
 	bool is_save_data_on_stack;           ///< Is the save data still on the squirrel stack?
 	int suspend;                          ///< The amount of ticks to suspend this script before it's allowed to continue.
 	bool is_paused;                       ///< Is the script paused? (a paused script will not be executed until unpaused)
+	bool in_garbage_collection;           ///< Is an incremental garbage collection of the script in progress?
 	Script_SuspendCallbackProc *callback; ///< Callback that should be called in the next tick the script runs.
+	class ScriptProfiler *profiler;       ///< Profiler of the script, if it was ever profiled.
 
 	/**
 	 * Call the script Load function if it exists and data was loaded
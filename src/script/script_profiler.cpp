@@ -0,0 +1,269 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_profiler.cpp Implementation of the profiler of scripts. */
+
+#include "../stdafx.h"
+#include "../console_func.h"
+#include "script_profiler.hpp"
+#include <squirrel.h>
+#include <../squirrel/sqpcheader.h>
+#include <../squirrel/sqvm.h>
+#include <../squirrel/sqfuncproto.h>
+#include <../squirrel/sqclosure.h>
+#include <../squirrel/sqstring.h>
+#include <algorithm>
+#include <chrono>
+
+#include "../safeguards.h"
+
+/**
+ * Get a timestamp in nanoseconds, to measure intervals with.
+ * @return The timestamp.
+ */
+static uint64 GetProfilerTime()
+{
+	using namespace std::chrono;
+	return (uint64)time_point_cast<nanoseconds>(high_resolution_clock::now()).time_since_epoch().count();
+}
+
+/**
+ * Get the function a closure in a call stack is of. All closures of the same
+ * Squirrel function share the same function prototype.
+ * @param closure The closure.
+ * @return The identification of the function.
+ */
+static const void *GetFunctionKey(const SQObjectPtr &closure)
+{
+	if (type(closure) == OT_CLOSURE) return _funcproto(_closure(closure)->_function);
+	return closure._unVal.pRefCounted;
+}
+
+/**
+ * Get the name of the function of a closure, to show in the profile.
+ * @param closure The closure.
+ * @return The name of the function, with the file it is in for Squirrel functions.
+ */
+static std::string GetFunctionName(const SQObjectPtr &closure)
+{
+	switch (type(closure)) {
+		case OT_CLOSURE: {
+			SQFunctionProto *func = _funcproto(_closure(closure)->_function);
+			std::string name = type(func->_name) == OT_STRING ? _stringval(func->_name) : "unnamed";
+			if (type(func->_sourcename) == OT_STRING) {
+				const char *source = _stringval(func->_sourcename);
+				const char *file = strrchr(source, PATHSEPCHAR);
+				name += "@";
+				name += file != NULL ? file + 1 : source;
+			}
+			return name;
+		}
+
+		case OT_NATIVECLOSURE: {
+			SQNativeClosure *func = _nativeclosure(closure);
+			std::string name = type(func->_name) == OT_STRING ? _stringval(func->_name) : "unnamed";
+			return name + " [api]";
+		}
+
+		default:
+			return "unknown";
+	}
+}
+
+ScriptProfiler::ScriptProfiler() : last_time(0), running(0)
+{
+	this->Reset();
+}
+
+/**
+ * Forget everything measured so far.
+ */
+void ScriptProfiler::Reset()
+{
+	this->nodes.clear();
+	this->stack.clear();
+	this->keys.clear();
+
+	Node root;
+	root.key = NULL;
+	root.parent = 0;
+	root.calls = 0;
+	root.ops = 0;
+	root.time = 0;
+	this->nodes.push_back(root);
+
+	this->last_time = GetProfilerTime();
+}
+
+/**
+ * Start measuring the time, as the script is going to be executed.
+ */
+void ScriptProfiler::Start()
+{
+	if (this->running++ == 0) this->last_time = GetProfilerTime();
+}
+
+/**
+ * Stop measuring the time, as the script is done executing.
+ */
+void ScriptProfiler::Stop()
+{
+	assert(this->running > 0);
+	if (this->running == 1) this->Charge();
+	this->running--;
+}
+
+/**
+ * Attribute the time since the last measurement to the function on top of the call stack.
+ */
+void ScriptProfiler::Charge()
+{
+	if (this->running == 0) return;
+
+	uint64 now = GetProfilerTime();
+	this->nodes[this->stack.empty() ? 0 : this->stack.back()].time += now - this->last_time;
+	this->last_time = now;
+}
+
+/**
+ * Get the node of a function called from another node, creating it when
+ * the function has not been called from there before.
+ * @param node The node of the calling function.
+ * @param key The function that is called.
+ * @param closure The closure of the function that is called.
+ * @return The node of the called function.
+ */
+uint ScriptProfiler::GetCallee(uint node, const void *key, const SQObjectPtr &closure)
+{
+	std::map<const void *, uint>::const_iterator it = this->nodes[node].callees.find(key);
+	if (it != this->nodes[node].callees.end()) return it->second;
+
+	Node callee;
+	callee.key = key;
+	callee.name = GetFunctionName(closure);
+	callee.parent = node;
+	callee.calls = 0;
+	callee.ops = 0;
+	callee.time = 0;
+
+	uint index = (uint)this->nodes.size();
+	this->nodes.push_back(callee);
+	this->nodes[node].callees[key] = index;
+	return index;
+}
+
+/**
+ * Make the call stack of the profiler match the call stack of the script.
+ * The time since the last measurement is attributed to the function that
+ * was on top of the call stack before it changed.
+ * @param vm The virtual machine of the script.
+ */
+void ScriptProfiler::Sync(SQVM *vm)
+{
+	size_t depth = (size_t)vm->_callsstacksize;
+	const void *top = depth == 0 ? NULL : GetFunctionKey(vm->ci->_closure);
+	if (this->stack.size() == depth && (depth == 0 || this->keys.back() == top)) return;
+
+	this->Charge();
+
+	if (this->stack.size() > depth) {
+		this->stack.resize(depth);
+		this->keys.resize(depth);
+	}
+	/* The function on top was replaced, e.g. by a tail call. */
+	if (this->stack.size() == depth && depth != 0 && this->keys.back() != top) {
+		this->stack.pop_back();
+		this->keys.pop_back();
+	}
+
+	while (this->stack.size() < depth) {
+		const SQObjectPtr &closure = vm->_callsstack[this->stack.size()]._closure;
+		const void *key = GetFunctionKey(closure);
+		uint node = this->GetCallee(this->stack.empty() ? 0 : this->stack.back(), key, closure);
+		this->nodes[node].calls++;
+		this->stack.push_back(node);
+		this->keys.push_back(key);
+	}
+}
+
+/**
+ * Count an operation executed by the script.
+ * @param vm The virtual machine of the script.
+ */
+void ScriptProfiler::CountOp(SQVM *vm)
+{
+	this->Sync(vm);
+	if (!this->stack.empty()) this->nodes[this->stack.back()].ops++;
+}
+
+/**
+ * Get the call stack of a node in the collapsed format.
+ * @param node The node.
+ * @return The names of the functions in the call stack, separated by semicolons.
+ */
+std::string ScriptProfiler::GetStack(uint node) const
+{
+	if (this->nodes[node].parent == 0) return this->nodes[node].name;
+	return this->GetStack(this->nodes[node].parent) + ";" + this->nodes[node].name;
+}
+
+/** Totals of a function over all call stacks. */
+struct ScriptProfilerTotals {
+	const char *name; ///< The name of the function.
+	uint64 calls;     ///< Number of times the function was called.
+	uint64 ops;       ///< Number of operations executed by the function itself.
+	uint64 time;      ///< Time spent in the function itself, in nanoseconds.
+
+	/** Order the functions with the most time spent first. */
+	bool operator<(const ScriptProfilerTotals &other) const
+	{
+		return this->time > other.time || (this->time == other.time && this->ops > other.ops);
+	}
+};
+
+/**
+ * Print the profile to the console.
+ * @param format The format to print the profile in.
+ */
+void ScriptProfiler::Print(Format format) const
+{
+	if (format != SPF_FLAT) {
+		for (uint i = 1; i < this->nodes.size(); i++) {
+			const Node &node = this->nodes[i];
+			uint64 weight = format == SPF_COLLAPSED_OPS ? node.ops : node.time / 1000;
+			if (weight == 0) continue;
+			IConsolePrintF(CC_DEFAULT, "%s " OTTD_PRINTF64, this->GetStack(i).c_str(), (int64)weight);
+		}
+		return;
+	}
+
+	std::map<const void *, ScriptProfilerTotals> functions;
+	for (uint i = 1; i < this->nodes.size(); i++) {
+		const Node &node = this->nodes[i];
+		std::map<const void *, ScriptProfilerTotals>::iterator it = functions.find(node.key);
+		if (it == functions.end()) {
+			ScriptProfilerTotals totals = { node.name.c_str(), 0, 0, 0 };
+			it = functions.insert(std::make_pair(node.key, totals)).first;
+		}
+		it->second.calls += node.calls;
+		it->second.ops   += node.ops;
+		it->second.time  += node.time;
+	}
+
+	std::vector<ScriptProfilerTotals> sorted;
+	for (std::map<const void *, ScriptProfilerTotals>::const_iterator it = functions.begin(); it != functions.end(); it++) {
+		sorted.push_back(it->second);
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	for (std::vector<ScriptProfilerTotals>::const_iterator it = sorted.begin(); it != sorted.end(); it++) {
+		IConsolePrintF(CC_DEFAULT, "%s: self time " OTTD_PRINTF64 ".%02d ms, ops " OTTD_PRINTF64 ", calls " OTTD_PRINTF64,
+				it->name, (int64)(it->time / 1000000), (int)(it->time / 10000 % 100), (int64)it->ops, (int64)it->calls);
+	}
+}
@@ -0,0 +1,87 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_profiler.hpp Profiler of the time and operations spent in the functions of a script. */
+
+#ifndef SCRIPT_PROFILER_HPP
+#define SCRIPT_PROFILER_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct SQVM;
+
+/**
+ * Profiler of a script. It attributes the operations the script executes,
+ * and the time spent executing them, to the call stack of the script at
+ * that moment. Both Squirrel functions and calls to the API are part of
+ * the call stack; the time of an API call is the time spent by OpenTTD
+ * executing it.
+ */
+class ScriptProfiler {
+public:
+	/** Format to print the profile in. */
+	enum Format {
+		SPF_FLAT,           ///< One line per function, with the totals of that function over all call stacks.
+		SPF_COLLAPSED_OPS,  ///< One line per call stack with the functions separated by semicolons, followed by the number of operations.
+		SPF_COLLAPSED_TIME, ///< One line per call stack with the functions separated by semicolons, followed by the time in microseconds.
+	};
+
+	ScriptProfiler();
+
+	void Reset();
+	void Start();
+	void Stop();
+	void CountOp(SQVM *vm);
+	void Sync(SQVM *vm);
+	void Print(Format format) const;
+
+	/**
+	 * Measure the time of the script for the lifetime of this object, i.e.
+	 * while the script is executed.
+	 */
+	class Run {
+		ScriptProfiler *profiler; ///< The profiler to measure with, or \c NULL.
+	public:
+		inline Run(ScriptProfiler *profiler) : profiler(profiler)
+		{
+			if (this->profiler != NULL) this->profiler->Start();
+		}
+
+		inline ~Run()
+		{
+			if (this->profiler != NULL) this->profiler->Stop();
+		}
+	};
+
+private:
+	/** A function in a call stack of the script. */
+	struct Node {
+		const void *key;                      ///< The function this node is of.
+		std::string name;                     ///< The name of the function.
+		uint parent;                          ///< The node of the caller of the function.
+		uint64 calls;                         ///< Number of times the function was called from this call stack.
+		uint64 ops;                           ///< Number of operations executed by the function itself.
+		uint64 time;                          ///< Time spent in the function itself, in nanoseconds.
+		std::map<const void *, uint> callees; ///< Nodes of the functions called by this function.
+	};
+
+	std::vector<Node> nodes;        ///< All call stacks seen so far; the first node is the root of the call stacks.
+	std::vector<uint> stack;        ///< The nodes of the current call stack of the script.
+	std::vector<const void *> keys; ///< The functions of the current call stack of the script.
+	uint64 last_time;               ///< Time the last measurement ended.
+	int running;                    ///< Number of nested runs of the script; time is only measured while it is running.
+
+	void Charge();
+	uint GetCallee(uint node, const void *key, const struct SQObjectPtr &closure);
+	std::string GetStack(uint node) const;
+};
+
+#endif /* SCRIPT_PROFILER_HPP */
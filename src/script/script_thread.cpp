@@ -0,0 +1,247 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_thread.cpp Implementation of running the scripts of several companies on worker threads. */
+
+#include "../stdafx.h"
+#include "../company_func.h"
+#include "../thread/thread.h"
+#include "script_thread.hpp"
+#include "script_instance.hpp"
+
+#include "../safeguards.h"
+
+/* static */ thread_local ScriptThread *ScriptThread::current = NULL;
+
+static ThreadMutex *_script_game_state_mutex = NULL; ///< Lock of the game state while the scripts run concurrently.
+static ThreadMutex *_script_state_mutex      = NULL; ///< Guards the states of the scripts, and signals the main thread when they change.
+
+/**
+ * A thread that runs the game loops of scripts. The workers are kept between
+ * game loops, so no threads have to be started for every game loop.
+ */
+struct ScriptWorker {
+	ThreadObject *thread; ///< The thread.
+	ThreadMutex *mutex;   ///< Guards #script and #stop, and signals the worker when they change; also used as the turn mutex of the script.
+	ScriptThread *script; ///< The script to run next, or \c NULL when there is none.
+	bool stop;            ///< Whether the thread should end.
+
+	ScriptWorker() : thread(NULL), mutex(ThreadMutex::New()), script(NULL), stop(false) {}
+	~ScriptWorker() { delete this->mutex; }
+};
+
+static std::vector<ScriptWorker *> _script_workers; ///< The worker threads that have been started.
+
+/**
+ * Create the worker thread state of a script.
+ * @param instance The script to run the game loop of.
+ * @param company The company the script belongs to.
+ */
+ScriptThread::ScriptThread(ScriptInstance *instance, CompanyID company) :
+	instance(instance), company(company), thread(NULL), turn_mutex(NULL), state(STS_RUNNING), has_turn(false), has_lock(false)
+{
+}
+
+/**
+ * Take the game state lock, and restore the state of the script in the game.
+ */
+void ScriptThread::Lock()
+{
+	assert(!this->has_lock);
+	_script_game_state_mutex->BeginCritical();
+	this->has_lock = true;
+	_current_company = this->company;
+}
+
+/**
+ * Remember the state of the script in the game, and release the game state lock.
+ */
+void ScriptThread::Unlock()
+{
+	assert(this->has_lock);
+	this->company = _current_company;
+	this->has_lock = false;
+	_script_game_state_mutex->EndCritical();
+}
+
+/**
+ * Change the state of the script, and let the main thread know.
+ * @param state The new state.
+ */
+void ScriptThread::SetState(State state)
+{
+	_script_state_mutex->BeginCritical();
+	this->state = state;
+	_script_state_mutex->SendSignal();
+	_script_state_mutex->EndCritical();
+}
+
+/**
+ * Let a waiting script continue, allowing it to execute commands.
+ */
+void ScriptThread::GiveTurn()
+{
+	this->turn_mutex->BeginCritical();
+	this->has_turn = true;
+	this->turn_mutex->SendSignal();
+	this->turn_mutex->EndCritical();
+}
+
+/**
+ * Run the game loop of a script.
+ * @param arg The ScriptThread of the script.
+ */
+/* static */ void ScriptThread::ThreadProc(void *arg)
+{
+	ScriptThread *st = (ScriptThread *)arg;
+
+	ScriptThread::current = st;
+	st->Lock();
+	st->instance->GameLoop();
+	st->Unlock();
+	ScriptThread::current = NULL;
+
+	st->SetState(STS_DONE);
+}
+
+/**
+ * Wait until the script running on the current thread may execute commands.
+ * This does nothing when the script does not run on a worker thread, or
+ * already has its turn.
+ */
+/* static */ void ScriptThread::WaitForCommandTurn()
+{
+	ScriptThread *st = ScriptThread::current;
+	if (st == NULL || st->has_turn) return;
+
+	GameStateUnlock unlock;
+	st->SetState(STS_WAITING);
+
+	st->turn_mutex->BeginCritical();
+	while (!st->has_turn) st->turn_mutex->WaitForSignal();
+	st->turn_mutex->EndCritical();
+}
+
+/**
+ * Run the game loops of the scripts given to a worker, until it is stopped.
+ * @param arg The ScriptWorker.
+ */
+/* static */ void ScriptThread::WorkerProc(void *arg)
+{
+	ScriptWorker *w = (ScriptWorker *)arg;
+
+	w->mutex->BeginCritical();
+	for (;;) {
+		while (w->script == NULL && !w->stop) w->mutex->WaitForSignal();
+		if (w->script == NULL) break;
+
+		/* Take the script before running it; the next one may be given as soon as this one is done. */
+		ScriptThread *st = w->script;
+		w->script = NULL;
+		w->mutex->EndCritical();
+		ScriptThread::ThreadProc(st);
+		w->mutex->BeginCritical();
+	}
+	w->mutex->EndCritical();
+}
+
+/**
+ * Get a worker thread that is not running a script, starting one when needed.
+ * @param index The index of the worker; workers before it are in use.
+ * @return The worker, or \c NULL when no thread could be started.
+ */
+static ScriptWorker *GetScriptWorker(uint index)
+{
+	if (index < _script_workers.size()) return _script_workers[index];
+
+	ScriptWorker *w = new ScriptWorker();
+	if (!ThreadObject::New(&ScriptThread::WorkerProc, w, &w->thread, "ottd:script")) {
+		delete w;
+		return NULL;
+	}
+	_script_workers.push_back(w);
+	return w;
+}
+
+/**
+ * Run the game loops of the scripts of several companies. The scripts run
+ * concurrently until they want to execute a command; after that they are
+ * continued one after another in the given order.
+ * @param scripts The scripts to run, in the order their commands are executed.
+ */
+/* static */ void ScriptThread::RunGameLoops(std::vector<ScriptThread> &scripts)
+{
+	if (_script_state_mutex == NULL) {
+		_script_game_state_mutex = ThreadMutex::New();
+		_script_state_mutex = ThreadMutex::New();
+	}
+
+	for (std::vector<ScriptThread>::iterator it = scripts.begin(); it != scripts.end(); ++it) {
+		ScriptWorker *w = GetScriptWorker(it - scripts.begin());
+		if (w == NULL) continue;
+
+		it->thread = w->thread;
+		it->turn_mutex = w->mutex;
+
+		w->mutex->BeginCritical();
+		w->script = &*it;
+		w->mutex->SendSignal();
+		w->mutex->EndCritical();
+	}
+
+	/* Wait till all scripts are done or want to execute a command. */
+	_script_state_mutex->BeginCritical();
+	for (std::vector<ScriptThread>::iterator it = scripts.begin(); it != scripts.end(); ++it) {
+		while (it->thread != NULL && it->state == STS_RUNNING) _script_state_mutex->WaitForSignal();
+	}
+	_script_state_mutex->EndCritical();
+
+	/* Now let the waiting scripts continue one by one, so their commands are executed in a fixed order. */
+	for (std::vector<ScriptThread>::iterator it = scripts.begin(); it != scripts.end(); ++it) {
+		if (it->thread == NULL) {
+			/* No thread could be started, so run the script here. */
+			it->has_turn = true;
+			ScriptThread::ThreadProc(&*it);
+		} else {
+			_script_state_mutex->BeginCritical();
+			if (it->state == STS_WAITING) {
+				it->state = STS_RUNNING;
+				it->GiveTurn();
+			}
+			while (it->state != STS_DONE) _script_state_mutex->WaitForSignal();
+			_script_state_mutex->EndCritical();
+		}
+	}
+}
+
+/**
+ * End the worker threads, e.g. because no scripts are running anymore.
+ * They are started again when scripts are run on them.
+ */
+/* static */ void ScriptThread::StopWorkers()
+{
+	for (std::vector<ScriptWorker *>::iterator it = _script_workers.begin(); it != _script_workers.end(); ++it) {
+		ScriptWorker *w = *it;
+
+		w->mutex->BeginCritical();
+		w->stop = true;
+		w->mutex->SendSignal();
+		w->mutex->EndCritical();
+
+		w->thread->Join();
+		delete w->thread;
+		delete w;
+	}
+	_script_workers.clear();
+
+	delete _script_state_mutex;
+	delete _script_game_state_mutex;
+	_script_state_mutex = NULL;
+	_script_game_state_mutex = NULL;
+}
@@ -0,0 +1,106 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_thread.hpp Running the scripts of several companies on worker threads. */
+
+#ifndef SCRIPT_THREAD_HPP
+#define SCRIPT_THREAD_HPP
+
+#include "../company_type.h"
+#include <vector>
+
+class ScriptInstance;
+class ThreadObject;
+class ThreadMutex;
+
+/**
+ * The game loop of a script that runs on a worker thread, concurrently
+ * with the game loops of the scripts of other companies.
+ *
+ * Only the Squirrel code of the scripts runs concurrently. The game state
+ * is guarded by a lock that is held whenever a worker thread is not executing
+ * Squirrel code, i.e. during all calls to the API and the rest of OpenTTD.
+ * Commands are not executed while the scripts run concurrently; a script that
+ * wants to execute a command waits until all scripts are done or waiting,
+ * after which the waiting scripts continue one by one in company order. So
+ * the game state does not change while the scripts run concurrently, and the
+ * outcome does not depend on the timing of the threads.
+ */
+class ScriptThread {
+public:
+	/** State of a script running on a worker thread. */
+	enum State {
+		STS_RUNNING, ///< The script is running.
+		STS_WAITING, ///< The script waits for its turn to execute a command.
+		STS_DONE,    ///< The game loop of the script is finished.
+	};
+
+	ScriptThread(ScriptInstance *instance, CompanyID company);
+
+	static void RunGameLoops(std::vector<ScriptThread> &scripts);
+	static void StopWorkers();
+	static void WaitForCommandTurn();
+	static void WorkerProc(void *arg);
+
+	/**
+	 * Take the game state lock for the lifetime of this object, if the
+	 * current thread is a worker thread that does not hold it yet.
+	 */
+	class GameStateLock {
+		ScriptThread *thread; ///< The thread that took the lock, or \c NULL.
+	public:
+		inline GameStateLock() : thread(ScriptThread::current != NULL && !ScriptThread::current->has_lock ? ScriptThread::current : NULL)
+		{
+			if (this->thread != NULL) this->thread->Lock();
+		}
+
+		inline ~GameStateLock()
+		{
+			if (this->thread != NULL) this->thread->Unlock();
+		}
+	};
+
+	/**
+	 * Release the game state lock for the lifetime of this object, if the
+	 * current thread is a worker thread that holds it.
+	 */
+	class GameStateUnlock {
+		ScriptThread *thread; ///< The thread that released the lock, or \c NULL.
+	public:
+		inline GameStateUnlock() : thread(ScriptThread::current != NULL && ScriptThread::current->has_lock ? ScriptThread::current : NULL)
+		{
+			if (this->thread != NULL) this->thread->Unlock();
+		}
+
+		inline ~GameStateUnlock()
+		{
+			if (this->thread != NULL) this->thread->Lock();
+		}
+	};
+
+private:
+	ScriptInstance *instance; ///< The script to run the game loop of.
+	CompanyID company;        ///< The current company of the script while it does not hold the game state lock.
+	ThreadObject *thread;     ///< The worker thread running the script, or \c NULL when none could be started.
+	ThreadMutex *turn_mutex;  ///< Mutex to signal the script that it may execute commands; owned by the worker.
+	State state;              ///< State of the script; guarded by the state mutex.
+	bool has_turn;            ///< Whether the script may execute commands; guarded by #turn_mutex.
+	bool has_lock;            ///< Whether the thread holds the game state lock.
+
+	static thread_local ScriptThread *current; ///< The script that runs on the current thread, if any.
+
+	void Lock();
+	void Unlock();
+	void SetState(State state);
+	void GiveTurn();
+
+	static void ThreadProc(void *arg);
+};
+
+#endif /* SCRIPT_THREAD_HPP */
@@ -214,6 +214,11 @@ void Squirrel::CollectGarbage()
 	sq_collectgarbage(this->vm);
 }
 
+bool Squirrel::CollectGarbageStep(int work)
+{
+	return sq_collectgarbagestep(this->vm, work) >= 0;
+}
+
 bool Squirrel::CallMethod(HSQOBJECT instance, const char *method_name, HSQOBJECT *ret, int suspend)
 {
 	assert(!this->crashed);
@@ -583,6 +588,11 @@ void Squirrel::InsertResult(int result)
 	vm->DecreaseOps(ops);
 }
 
+void Squirrel::SetProfiler(ScriptProfiler *profiler)
+{
+	this->vm->_profiler = profiler;
+}
+
 bool Squirrel::IsSuspended()
 {
 	return this->vm->_suspended != 0;
@@ -146,6 +146,14 @@ public:
 	 */
 	void CollectGarbage();
 
+	/**
+	 * Tell the VM to do a step of an incremental garbage collection run,
+	 *  starting a new run if none is in progress.
+	 * @param work The amount of work to do in this step.
+	 * @return True if the garbage collection run is finished.
+	 */
+	bool CollectGarbageStep(int work);
+
 	void InsertResult(bool result);
 	void InsertResult(int result);
 	void InsertResult(uint result) { this->InsertResult((int)result); }
@@ -242,6 +250,12 @@ public:
 	 */
 	static void DecreaseOps(HSQUIRRELVM vm, int amount);
 
+	/**
+	 * Set the profiler to measure the script with.
+	 * @param profiler The profiler, or \c NULL to stop measuring.
+	 */
+	void SetProfiler(class ScriptProfiler *profiler);
+
 	/**
 	 * Did the squirrel code suspend or return normally.
 	 * @return True if the function suspended.
@@ -17,6 +17,7 @@
 #include "../economy_type.h"
 #include "../string_func.h"
 #include "squirrel_helper_type.hpp"
+#include "script_thread.hpp"
 
 template <class CL, ScriptType ST> const char *GetClassName();
 
@@ -862,6 +863,7 @@ namespace SQConvert {
 	static SQInteger DefSQDestructorCallback(SQUserPointer p, SQInteger size)
 	{
 		/* Remove the real instance too */
+		ScriptThread::GameStateLock lock;
 		if (p != NULL) ((Tcls *)p)->Release();
 		return 0;
 	}
@@ -67,6 +67,7 @@
 
 #include "void_map.h"
 #include "station_base.h"
+#include "newgrf_engine.h"
 
 #include "table/strings.h"
 #include "table/settings.h"
@@ -1321,6 +1322,13 @@ static bool InvalidateShipPathCache(int32 p1)
 	return true;
 }
 
+/** Forget the cached NewGRF results, so no results from before the cache was disabled are used when it is enabled again. */
+static bool InvalidateVehicleResolveCache(int32 p1)
+{
+	ClearVehicleResolveCache();
+	return true;
+}
+
 
 #ifdef ENABLE_NETWORK
 
@@ -112,6 +112,9 @@ struct GUISettings {
 	bool   disable_unsuitable_building;      ///< disable infrastructure building when no suitable vehicles are available
 	byte   autosave;                         ///< how often should we do autosaves?
 	bool   threaded_saves;                   ///< should we do threaded saves?
+	bool   threaded_ai;                      ///< should we run the AIs of different companies concurrently?
+	bool   newgrf_resolve_cache;             ///< cache results of NewGRF vehicle sprite and callback resolution?
+	bool   preload_sprites;                  ///< load and encode 32bpp sprites in advance using multiple threads?
 	bool   keep_all_autosave;                ///< name the autosave in a different way
 	bool   autosave_on_exit;                 ///< save an autosave when you quit the game, but do not ask "Do you really want to quit?"
 	bool   autosave_on_network_disconnect;   ///< save an autosave when you get disconnected from a network game with an error?
@@ -303,6 +306,7 @@ struct GameCreationSettings {
 	byte   min_river_length;                 ///< the minimum river length
 	byte   river_route_random;               ///< the amount of randomicity for the route finding
 	byte   amount_of_rivers;                 ///< the amount of rivers
+	bool   settle_landscape;                 ///< settle the generated landscape directly, instead of running the tile loop
 };
 
 /** Settings related to construction in-game */
@@ -30,6 +30,7 @@
 #include "ai/ai.hpp"
 #include "game/game.hpp"
 #include "pathfinder/opf/opf_ship.h"
+#include "pathfinder/depot_cache.h"
 #include "engine_base.h"
 #include "company_base.h"
 #include "tunnelbridge_map.h"
@@ -144,6 +145,11 @@ void Ship::GetImage(Direction direction, EngineImageType image_type, VehicleSpri
 
 static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 {
+	/* The closest depot only changes when depots are built or removed. */
+	NearestDepotCacheKey key(v->tile, INVALID_TRACKDIR, v->owner, VEH_SHIP, 0, 0, max_distance);
+	FindDepotData cached;
+	if (FindCachedNearestDepot(key, &cached)) return cached.tile == INVALID_TILE ? NULL : Depot::GetByTile(cached.tile);
+
 	/* Find the closest depot */
 	const Depot *depot;
 	const Depot *best_depot = NULL;
@@ -165,6 +171,7 @@ static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 		}
 	}
 
+	CacheNearestDepot(key, best_depot == NULL ? FindDepotData() : FindDepotData(best_depot->xy, best_dist));
 	return best_depot;
 }
 
@@ -19,6 +19,8 @@
 #include "blitter/factory.hpp"
 #include "core/math_func.hpp"
 #include "core/mem_func.hpp"
+#include "core/smallvec_type.hpp"
+#include "thread/thread.h"
 
 #include "table/sprites.h"
 #include "table/strings.h"
@@ -39,6 +41,7 @@ struct SpriteCache {
 	int16 lru;
 	SpriteTypeByte type; ///< In some cases a single sprite is misused by two NewGRFs. Once as real sprite and once as recolour sprite. If the recolour sprite gets into the cache it might be drawn as real sprite which causes enormous trouble.
 	bool warned;         ///< True iff the user has been warned about incorrect use of this sprite
+	bool preloaded;      ///< True iff the sprite was loaded by #PreloadSprites and has not been requested since.
 	byte container_ver;  ///< Container version of the GRF the sprite is from.
 };
 
@@ -391,6 +394,31 @@ static void *ReadRecolourSprite(uint16 file_slot, uint num)
 	return dest;
 }
 
+/**
+ * Create the missing zoom levels of a loaded sprite and encode it for the current blitter.
+ * @param sprite      The loaded sprite for all zoom levels.
+ * @param sprite_avail Bit mask of the zoom levels that were loaded.
+ * @param file_slot   GRF the sprite was loaded from.
+ * @param file_id     Sprite number in the GRF.
+ * @param allocator   Allocator function to use.
+ * @return Encoded sprite, or NULL if the missing zoom levels could not be created.
+ */
+static Sprite *EncodeSprite(SpriteLoader::Sprite *sprite, uint8 sprite_avail, uint32 file_slot, uint32 file_id, AllocatorProc *allocator)
+{
+	if (!ResizeSprites(sprite, sprite_avail, file_slot, file_id)) return NULL;
+
+	if (sprite->type == ST_FONT && ZOOM_LVL_GUI != ZOOM_LVL_NORMAL) {
+		/* Make ZOOM_LVL_GUI be ZOOM_LVL_NORMAL */
+		sprite[ZOOM_LVL_NORMAL].width  = sprite[ZOOM_LVL_GUI].width;
+		sprite[ZOOM_LVL_NORMAL].height = sprite[ZOOM_LVL_GUI].height;
+		sprite[ZOOM_LVL_NORMAL].x_offs = sprite[ZOOM_LVL_GUI].x_offs;
+		sprite[ZOOM_LVL_NORMAL].y_offs = sprite[ZOOM_LVL_GUI].y_offs;
+		sprite[ZOOM_LVL_NORMAL].data   = sprite[ZOOM_LVL_GUI].data;
+	}
+
+	return BlitterFactory::GetCurrentBlitter()->Encode(sprite, allocator);
+}
+
 /**
  * Read a sprite from disk.
  * @param sc          Location of sprite.
@@ -457,21 +485,13 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 		return s;
 	}
 
-	if (!ResizeSprites(sprite, sprite_avail, file_slot, sc->id)) {
+	Sprite *s = EncodeSprite(sprite, sprite_avail, file_slot, sc->id, allocator);
+	if (s == NULL) {
 		if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't resize the fallback sprite. What should I do?");
 		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
 	}
 
-	if (sprite->type == ST_FONT && ZOOM_LVL_GUI != ZOOM_LVL_NORMAL) {
-		/* Make ZOOM_LVL_GUI be ZOOM_LVL_NORMAL */
-		sprite[ZOOM_LVL_NORMAL].width  = sprite[ZOOM_LVL_GUI].width;
-		sprite[ZOOM_LVL_NORMAL].height = sprite[ZOOM_LVL_GUI].height;
-		sprite[ZOOM_LVL_NORMAL].x_offs = sprite[ZOOM_LVL_GUI].x_offs;
-		sprite[ZOOM_LVL_NORMAL].y_offs = sprite[ZOOM_LVL_GUI].y_offs;
-		sprite[ZOOM_LVL_NORMAL].data   = sprite[ZOOM_LVL_GUI].data;
-	}
-
-	return BlitterFactory::GetCurrentBlitter()->Encode(sprite, allocator);
+	return s;
 }
 
 
@@ -582,6 +602,7 @@ bool LoadNextSprite(int load_index, byte file_slot, uint file_sprite_id, byte co
 	sc->id = file_sprite_id;
 	sc->type = type;
 	sc->warned = false;
+	sc->preloaded = false;
 	sc->container_ver = container_version;
 
 	return true;
@@ -599,6 +620,7 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 	scnew->id = scold->id;
 	scnew->type = scold->type;
 	scnew->warned = false;
+	scnew->preloaded = false;
 	scnew->container_ver = scold->container_ver;
 }
 
@@ -807,6 +829,8 @@ static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, S
 
 	SpriteType available = sc->type;
 	if (requested == ST_FONT && available == ST_NORMAL) {
+		/* Glyphs are encoded differently, so drop the sprite if it was only preloaded as normal sprite. */
+		if (sc->ptr != NULL && sc->preloaded) DeleteEntryFromSpriteCache(sprite);
 		if (sc->ptr == NULL) sc->type = ST_FONT;
 		return GetRawSprite(sprite, sc->type, allocator);
 	}
@@ -861,6 +885,7 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 
 		/* Update LRU */
 		sc->lru = ++_sprite_lru_counter;
+		sc->preloaded = false;
 
 		/* Load the sprite, if it is not loaded, yet */
 		if (sc->ptr == NULL) sc->ptr = ReadSprite(sc, sprite, type, AllocSprite);
@@ -947,6 +972,193 @@ void GfxClearSpriteCache()
 		SpriteCache *sc = GetSpriteCache(i);
 		if (sc->type != ST_RECOLOUR && sc->ptr != NULL) DeleteEntryFromSpriteCache(i);
 	}
+
+	PreloadSprites();
+}
+
+/** Number of sprites that are read from disk and then decoded at once while preloading. */
+static const uint PRELOAD_BATCH_SIZE = 256;
+/** Size of the memory blocks of a #PreloadArena. */
+static const size_t PRELOAD_ARENA_BLOCK_SIZE = 1024 * 1024;
+
+/** Memory for the sprites encoded by a preload thread, until they are copied into the sprite cache. */
+struct PreloadArena {
+	AutoFreeSmallVector<byte *, 16> blocks; ///< The allocated blocks; the last one is being filled.
+	size_t used;                            ///< Number of used bytes in the last block.
+	size_t last_size;                       ///< Size of the last allocation.
+
+	PreloadArena() : used(PRELOAD_ARENA_BLOCK_SIZE), last_size(0) {}
+
+	/**
+	 * Allocate memory in the arena.
+	 * @param size The number of bytes to allocate.
+	 * @return The allocated memory.
+	 */
+	void *Allocate(size_t size)
+	{
+		this->last_size = size;
+		size = Align(size, S_FREE_MASK + 1);
+
+		if (size > PRELOAD_ARENA_BLOCK_SIZE) {
+			/* Huge sprites get a block of their own. */
+			*this->blocks.Append() = MallocT<byte>(size);
+			this->used = PRELOAD_ARENA_BLOCK_SIZE;
+			return this->blocks[this->blocks.Length() - 1];
+		}
+
+		if (this->used + size > PRELOAD_ARENA_BLOCK_SIZE) {
+			*this->blocks.Append() = MallocT<byte>(PRELOAD_ARENA_BLOCK_SIZE);
+			this->used = 0;
+		}
+
+		byte *ptr = this->blocks[this->blocks.Length() - 1] + this->used;
+		this->used += size;
+		return ptr;
+	}
+
+	/** Free all memory of the arena. */
+	void Clear()
+	{
+		this->blocks.Clear();
+		this->used = PRELOAD_ARENA_BLOCK_SIZE;
+	}
+};
+
+/** A sprite that is being preloaded. */
+struct PreloadSprite {
+	SpriteID id;         ///< The sprite.
+	byte *data;          ///< Data of the sprite as read from the GRF.
+	size_t size;         ///< Size of #data.
+	Sprite *encoded;     ///< The encoded sprite, or NULL if it is left to be loaded on demand.
+	size_t encoded_size; ///< Size of #encoded.
+};
+
+/** A batch of sprites that is decoded and encoded by multiple threads. */
+struct PreloadBatch {
+	PreloadSprite *sprites; ///< The sprites of the batch.
+	PreloadArena *arenas;   ///< Memory for the encoded sprites, one arena for each thread.
+};
+
+/** The arena the encoded sprites of the current thread are stored in. */
+static thread_local PreloadArena *_preload_arena = NULL;
+
+/**
+ * Allocate memory for an encoded sprite in the arena of the current preload thread.
+ * @param size The number of bytes to allocate.
+ * @return The allocated memory.
+ */
+static void *PreloadAllocate(size_t size)
+{
+	return _preload_arena->Allocate(size);
+}
+
+/**
+ * Decode and encode a part of the sprites of a batch.
+ * This does not access any files nor the sprite cache memory, so it can run on any thread.
+ * @param part The number of the thread, which determines the arena to use.
+ * @param begin The first sprite of the batch to handle.
+ * @param end The sprite after the last one to handle.
+ * @param data The #PreloadBatch.
+ */
+static void PreloadSpritesThread(uint part, uint begin, uint end, void *data)
+{
+	PreloadBatch *batch = (PreloadBatch *)data;
+	PreloadArena *arena = &batch->arenas[part];
+	_preload_arena = arena;
+
+	for (uint i = begin; i < end; i++) {
+		PreloadSprite *ps = &batch->sprites[i];
+		const SpriteCache *sc = GetSpriteCache(ps->id);
+
+		SpriteLoader::Sprite sprite[ZOOM_LVL_COUNT];
+		sprite[ZOOM_LVL_NORMAL].type = ST_NORMAL;
+
+		/* Try for 32bpp sprites first. */
+		SpriteLoaderGrf sprite_loader(sc->container_ver);
+		bool fallback = false;
+		uint8 sprite_avail = sprite_loader.DecodeRawSprite(sprite, ps->data, ps->size, sc->file_slot, sc->file_pos, ST_NORMAL, true, &fallback);
+		if (sprite_avail == 0 && !fallback) {
+			sprite_avail = sprite_loader.DecodeRawSprite(sprite, ps->data, ps->size, sc->file_slot, sc->file_pos, ST_NORMAL, false, &fallback);
+		}
+
+		/* Missing and broken sprites are loaded on demand, which handles reporting them and using the fallback sprite. */
+		if (sprite_avail == 0 || fallback) continue;
+
+		ps->encoded = EncodeSprite(sprite, sprite_avail, sc->file_slot, sc->id, PreloadAllocate);
+		ps->encoded_size = arena->last_size;
+	}
+
+	_preload_arena = NULL;
+}
+
+/**
+ * Load the sprites into the sprite cache in advance, instead of on demand while drawing.
+ * The sprites are read from disk by the main thread in batches, which are then decoded
+ * and encoded by multiple threads before they are put into the sprite cache.
+ * Only sprites from container version 2 GRFs are preloaded, and only as long as they fit
+ * in the sprite cache without evicting other sprites; the other sprites are still loaded
+ * on demand.
+ */
+void PreloadSprites()
+{
+	if (!_settings_client.gui.preload_sprites) return;
+
+	/* Only 32bpp sprites take long enough to load to be worth it. The encoders of
+	 * the 8bpp blitters may also use shared buffers, so they can't run in parallel. */
+	if (BlitterFactory::GetCurrentBlitter()->GetScreenDepth() != 32) return;
+
+	uint num_threads = Clamp(GetCPUCoreCount(), 1U, MAX_PARALLEL_THREADS);
+	PreloadArena *arenas = new PreloadArena[num_threads];
+	PreloadSprite sprites[PRELOAD_BATCH_SIZE];
+	PreloadBatch batch = { sprites, arenas };
+
+	/* Leave some room in the sprite cache, so the sprites needed right away do not evict other sprites. */
+	size_t budget = _allocated_sprite_cache_size / 4 * 3;
+	size_t used = GetSpriteCacheUsage();
+	uint preloaded = 0;
+
+	SpriteID next = 0;
+	while (used < budget && next < _spritecache_items) {
+		/* Read the next batch of sprites; only the main thread may access the files. */
+		uint count = 0;
+		for (; next < _spritecache_items && count < PRELOAD_BATCH_SIZE; next++) {
+			const SpriteCache *sc = GetSpriteCache(next);
+			if (sc->type != ST_NORMAL || sc->ptr != NULL) continue;
+
+			PreloadSprite *ps = &sprites[count];
+			SpriteLoaderGrf sprite_loader(sc->container_ver);
+			ps->data = sprite_loader.ReadRawSprite(sc->file_slot, sc->file_pos, &ps->size);
+			if (ps->data == NULL) continue;
+
+			ps->id = next;
+			ps->encoded = NULL;
+			count++;
+		}
+
+		/* Decode and encode the batch. */
+		RunParallel(&PreloadSpritesThread, &batch, count, num_threads, "ottd:sprites");
+
+		/* Copy the encoded sprites into the sprite cache. */
+		for (uint i = 0; i < count; i++) {
+			PreloadSprite *ps = &sprites[i];
+			free(ps->data);
+
+			if (ps->encoded == NULL || used >= budget) continue;
+
+			used += Align(ps->encoded_size + sizeof(MemBlock), S_FREE_MASK + 1);
+			SpriteCache *sc = GetSpriteCache(ps->id);
+			sc->ptr = AllocSprite(ps->encoded_size);
+			sc->preloaded = true;
+			memcpy(sc->ptr, ps->encoded, ps->encoded_size);
+			preloaded++;
+		}
+
+		for (uint i = 0; i < num_threads; i++) arenas[i].Clear();
+	}
+
+	delete[] arenas;
+
+	DEBUG(sprite, 2, "Preloaded %u sprites using %u threads", preloaded, num_threads);
 }
 
-/* static */ ReusableBuffer<SpriteLoader::CommonPixel> SpriteLoader::Sprite::buffer[ZOOM_LVL_COUNT];
+/* static */ thread_local ReusableBuffer<SpriteLoader::CommonPixel> SpriteLoader::Sprite::buffer[ZOOM_LVL_COUNT];
@@ -50,6 +50,7 @@ static inline const byte *GetNonSprite(SpriteID sprite, SpriteType type)
 
 void GfxInitSpriteMem();
 void GfxClearSpriteCache();
+void PreloadSprites();
 void IncreaseSpriteLRU();
 
 void ReadGRFSpriteOffsets(byte container_version);
@@ -54,8 +54,97 @@ static bool WarnCorruptSprite(uint8 file_slot, size_t file_pos, int line)
 	return false;
 }
 
+/** Reads the sprite data directly from the file that is currently opened by the FIO. */
+struct FioSpriteReader {
+	byte ReadByte() { return FioReadByte(); }
+	uint16 ReadWord() { return FioReadWord(); }
+	uint32 ReadDword() { return FioReadDword(); }
+	void SkipBytes(int64 num) { FioSkipBytes(num); }
+	size_t GetPos() const { return FioGetPos(); }
+
+	/**
+	 * Check whether problems with the sprite may be reported to the user.
+	 * @return Always true.
+	 */
+	bool CanReport() { return true; }
+};
+
+/**
+ * Reads the sprite data from a block that was read from the file earlier on.
+ * It does not access any global state, so multiple readers can be used at the same time.
+ */
+struct MemorySpriteReader {
+	const byte *begin; ///< Start of the data.
+	const byte *pos;   ///< Current read position.
+	const byte *end;   ///< End of the data.
+	size_t file_pos;   ///< Position of the start of the data in the file.
+	bool fallback;     ///< Whether the sprite has to be loaded from the file instead, e.g. to report problems.
+
+	MemorySpriteReader(const byte *data, size_t size, size_t file_pos) : begin(data), pos(data), end(data + size), file_pos(file_pos), fallback(false) {}
+
+	byte ReadByte()
+	{
+		if (this->pos >= this->end) {
+			this->fallback = true;
+			return 0;
+		}
+		return *this->pos++;
+	}
+
+	uint16 ReadWord()
+	{
+		byte b = this->ReadByte();
+		return (this->ReadByte() << 8) | b;
+	}
+
+	uint32 ReadDword()
+	{
+		uint b = this->ReadWord();
+		return (this->ReadWord() << 16) | b;
+	}
+
+	void SkipBytes(int64 num)
+	{
+		if (num < 0 || num > this->end - this->pos) {
+			this->fallback = true;
+			this->pos = this->end;
+			return;
+		}
+		this->pos += num;
+	}
+
+	size_t GetPos() const { return this->file_pos + (this->pos - this->begin); }
+
+	/**
+	 * Check whether problems with the sprite may be reported to the user.
+	 * Reporting is left to the main thread, which has to load the sprite from the file instead.
+	 * @return Always false.
+	 */
+	bool CanReport()
+	{
+		this->fallback = true;
+		return false;
+	}
+};
+
+/**
+ * We found a corrupted sprite; warn about it when the reader allows so.
+ * @param reader The reader of the sprite data.
+ * @param file_slot the file the errored sprite is in
+ * @param file_pos the location in the file of the errored sprite
+ * @param line the line where the error occurs.
+ * @return always false (to tell loading the sprite failed)
+ */
+template <class Reader>
+static bool WarnCorruptSprite(Reader &reader, uint8 file_slot, size_t file_pos, int line)
+{
+	if (!reader.CanReport()) return false;
+	return WarnCorruptSprite(file_slot, file_pos, line);
+}
+
 /**
  * Decode the image data of a single sprite.
+ * @param reader The reader of the sprite data.
  * @param[in,out] sprite Filled with the sprite image data.
  * @param file_slot File slot.
  * @param file_pos File position.
@@ -67,7 +156,8 @@ static bool WarnCorruptSprite(uint8 file_slot, size_t file_pos, int line)
  * @param container_format Container format of the GRF this sprite is in.
  * @return True if the sprite was successfully loaded.
  */
-bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, int64 num, byte type, ZoomLevel zoom_lvl, byte colour_fmt, byte container_format)
+template <class Reader>
+static bool DecodeSingleSprite(Reader &reader, SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, int64 num, byte type, ZoomLevel zoom_lvl, byte colour_fmt, byte container_format)
 {
 	AutoFreePtr<byte> dest_orig(MallocT<byte>(num));
 	byte *dest = dest_orig;
@@ -75,24 +165,24 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t fi
 
 	/* Read the file, which has some kind of compression */
 	while (num > 0) {
-		int8 code = FioReadByte();
+		int8 code = reader.ReadByte();
 
 		if (code >= 0) {
 			/* Plain bytes to read */
 			int size = (code == 0) ? 0x80 : code;
 			num -= size;
-			if (num < 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+			if (num < 0) return WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 			for (; size > 0; size--) {
-				*dest = FioReadByte();
+				*dest = reader.ReadByte();
 				dest++;
 			}
 		} else {
 			/* Copy bytes from earlier in the sprite */
-			const uint data_offset = ((code & 7) << 8) | FioReadByte();
-			if (dest - data_offset < dest_orig) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+			const uint data_offset = ((code & 7) << 8) | reader.ReadByte();
+			if (dest - data_offset < dest_orig) return WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 			int size = -(code >> 3);
 			num -= size;
-			if (num < 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+			if (num < 0) return WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 			for (; size > 0; size--) {
 				*dest = *(dest - data_offset);
 				dest++;
@@ -100,7 +190,7 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t fi
 		}
 	}
 
-	if (num != 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+	if (num != 0) return WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 
 	sprite->AllocateData(zoom_lvl, sprite->width * sprite->height);
 
@@ -127,7 +217,7 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t fi
 
 			do {
 				if (dest + (container_format >= 2 && sprite->width > 256 ? 4 : 2) > dest_orig + dest_size) {
-					return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+					return WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 				}
 
 				SpriteLoader::CommonPixel *data;
@@ -153,7 +243,7 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t fi
 				data = &sprite->data[y * sprite->width + skip];
 
 				if (skip + length > sprite->width || dest + length * bpp > dest_orig + dest_size) {
-					return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+					return WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 				}
 
 				for (int x = 0; x < length; x++) {
@@ -179,10 +269,10 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t fi
 		}
 	} else {
 		if (dest_size < sprite->width * sprite->height * bpp) {
-			return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+			return WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 		}
 
-		if (dest_size > sprite->width * sprite->height * bpp) {
+		if (dest_size > sprite->width * sprite->height * bpp && reader.CanReport()) {
 			static byte warning_level = 0;
 			DEBUG(sprite, warning_level, "Ignoring " OTTD_PRINTF64 " unused extra bytes from the sprite from %s at position %i", dest_size - sprite->width * sprite->height * bpp, FioGetFilename(file_slot), (int)file_pos);
 			warning_level = 6;
@@ -222,6 +312,7 @@ uint8 LoadSpriteV1(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_po
 
 	/* Open the right file and go to the correct position */
 	FioSeekToFile(file_slot, file_pos);
+	FioSpriteReader reader;
 
 	/* Read the size and type */
 	int num = FioReadWord();
@@ -238,7 +329,7 @@ uint8 LoadSpriteV1(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_po
 	sprite[zoom_lvl].y_offs = FioReadWord();
 
 	if (sprite[zoom_lvl].width > INT16_MAX) {
-		WarnCorruptSprite(file_slot, file_pos, __LINE__);
+		WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 		return 0;
 	}
 
@@ -246,52 +337,47 @@ uint8 LoadSpriteV1(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_po
 	 * In case it is uncompressed, the size is 'num' - 8 (header-size). */
 	num = (type & 0x02) ? sprite[zoom_lvl].width * sprite[zoom_lvl].height : num - 8;
 
-	if (DecodeSingleSprite(&sprite[zoom_lvl], file_slot, file_pos, sprite_type, num, type, zoom_lvl, SCC_PAL, 1)) return 1 << zoom_lvl;
+	if (DecodeSingleSprite(reader, &sprite[zoom_lvl], file_slot, file_pos, sprite_type, num, type, zoom_lvl, SCC_PAL, 1)) return 1 << zoom_lvl;
 
 	return 0;
 }
 
-uint8 LoadSpriteV2(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, bool load_32bpp)
+template <class Reader>
+static uint8 LoadSpriteV2(Reader &reader, SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, bool load_32bpp)
 {
 	static const ZoomLevel zoom_lvl_map[6] = {ZOOM_LVL_OUT_4X, ZOOM_LVL_NORMAL, ZOOM_LVL_OUT_2X, ZOOM_LVL_OUT_8X, ZOOM_LVL_OUT_16X, ZOOM_LVL_OUT_32X};
 
-	/* Is the sprite not present/stripped in the GRF? */
-	if (file_pos == SIZE_MAX) return 0;
-
-	/* Open the right file and go to the correct position */
-	FioSeekToFile(file_slot, file_pos);
-
-	uint32 id = FioReadDword();
+	uint32 id = reader.ReadDword();
 
 	uint8 loaded_sprites = 0;
 	do {
-		int64 num = FioReadDword();
-		size_t start_pos = FioGetPos();
-		byte type = FioReadByte();
+		int64 num = reader.ReadDword();
+		size_t start_pos = reader.GetPos();
+		byte type = reader.ReadByte();
 
 		/* Type 0xFF indicates either a colourmap or some other non-sprite info; we do not handle them here. */
 		if (type == 0xFF) return 0;
 
 		byte colour = type & SCC_MASK;
-		byte zoom = FioReadByte();
+		byte zoom = reader.ReadByte();
 
 		if (colour != 0 && (load_32bpp ? colour != SCC_PAL : colour == SCC_PAL) && (sprite_type != ST_MAPGEN ? zoom < lengthof(zoom_lvl_map) : zoom == 0)) {
 			ZoomLevel zoom_lvl = (sprite_type != ST_MAPGEN) ? zoom_lvl_map[zoom] : ZOOM_LVL_NORMAL;
 
 			if (HasBit(loaded_sprites, zoom_lvl)) {
 				/* We already have this zoom level, skip sprite. */
-				DEBUG(sprite, 1, "Ignoring duplicate zoom level sprite %u from %s", id, FioGetFilename(file_slot));
-				FioSkipBytes(num - 2);
+				if (reader.CanReport()) DEBUG(sprite, 1, "Ignoring duplicate zoom level sprite %u from %s", id, FioGetFilename(file_slot));
+				reader.SkipBytes(num - 2);
 				continue;
 			}
 
-			sprite[zoom_lvl].height = FioReadWord();
-			sprite[zoom_lvl].width  = FioReadWord();
-			sprite[zoom_lvl].x_offs = FioReadWord();
-			sprite[zoom_lvl].y_offs = FioReadWord();
+			sprite[zoom_lvl].height = reader.ReadWord();
+			sprite[zoom_lvl].width  = reader.ReadWord();
+			sprite[zoom_lvl].x_offs = reader.ReadWord();
+			sprite[zoom_lvl].y_offs = reader.ReadWord();
 
 			if (sprite[zoom_lvl].width > INT16_MAX || sprite[zoom_lvl].height > INT16_MAX) {
-				WarnCorruptSprite(file_slot, file_pos, __LINE__);
+				WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 				return 0;
 			}
 
@@ -306,21 +392,21 @@ uint8 LoadSpriteV2(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_po
 
 			/* For chunked encoding we store the decompressed size in the file,
 			 * otherwise we can calculate it from the image dimensions. */
-			uint decomp_size = (type & 0x08) ? FioReadDword() : sprite[zoom_lvl].width * sprite[zoom_lvl].height * bpp;
+			uint decomp_size = (type & 0x08) ? reader.ReadDword() : sprite[zoom_lvl].width * sprite[zoom_lvl].height * bpp;
 
-			bool valid = DecodeSingleSprite(&sprite[zoom_lvl], file_slot, file_pos, sprite_type, decomp_size, type, zoom_lvl, colour, 2);
-			if (FioGetPos() != start_pos + num) {
-				WarnCorruptSprite(file_slot, file_pos, __LINE__);
+			bool valid = DecodeSingleSprite(reader, &sprite[zoom_lvl], file_slot, file_pos, sprite_type, decomp_size, type, zoom_lvl, colour, 2);
+			if (reader.GetPos() != start_pos + num) {
+				WarnCorruptSprite(reader, file_slot, file_pos, __LINE__);
 				return 0;
 			}
 
 			if (valid) SetBit(loaded_sprites, zoom_lvl);
 		} else {
 			/* Not the wanted zoom level or colour depth, continue searching. */
-			FioSkipBytes(num - 2);
+			reader.SkipBytes(num - 2);
 		}
 
-	} while (FioReadDword() == id);
+	} while (reader.ReadDword() == id);
 
 	return loaded_sprites;
 }
@@ -328,8 +414,63 @@ uint8 LoadSpriteV2(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_po
 uint8 SpriteLoaderGrf::LoadSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, bool load_32bpp)
 {
 	if (this->container_ver >= 2) {
-		return LoadSpriteV2(sprite, file_slot, file_pos, sprite_type, load_32bpp);
+		/* Is the sprite not present/stripped in the GRF? */
+		if (file_pos == SIZE_MAX) return 0;
+
+		/* Open the right file and go to the correct position */
+		FioSeekToFile(file_slot, file_pos);
+		FioSpriteReader reader;
+		return LoadSpriteV2(reader, sprite, file_slot, file_pos, sprite_type, load_32bpp);
 	} else {
 		return LoadSpriteV1(sprite, file_slot, file_pos, sprite_type, load_32bpp);
 	}
 }
+
+/**
+ * Read the data of all variants of a sprite from the file, so it can be decoded later on without accessing the file.
+ * @param file_slot File slot.
+ * @param file_pos File position of the sprite.
+ * @param[out] size Size of the read data.
+ * @return The read data, to be freed by the caller, or NULL if the sprite can't be read in advance.
+ * @note Only sprites from container version 2 GRFs can be read in advance.
+ */
+byte *SpriteLoaderGrf::ReadRawSprite(uint8 file_slot, size_t file_pos, size_t *size)
+{
+	if (this->container_ver < 2 || file_pos == SIZE_MAX) return NULL;
+
+	/* Find the end of the last variant of the sprite; include the ID of the next sprite, which ends the list of variants. */
+	FioSeekToFile(file_slot, file_pos);
+	uint32 id = FioReadDword();
+	do {
+		FioSkipBytes(FioReadDword());
+	} while (FioReadDword() == id);
+
+	*size = FioGetPos() - file_pos;
+	byte *data = MallocT<byte>(*size);
+	FioSeekToFile(file_slot, file_pos);
+	FioReadBlock(data, *size);
+	return data;
+}
+
+/**
+ * Decode a sprite from data read by #ReadRawSprite. This does not access the file
+ * nor show any messages, so it can be done by multiple threads at the same time.
+ * @param[out] sprite The sprites to fill with data.
+ * @param data The data of the sprite.
+ * @param size The size of the data.
+ * @param file_slot The file the data was read from.
+ * @param file_pos The position within the file the data was read from.
+ * @param sprite_type The type of sprite we're trying to load.
+ * @param load_32bpp True if 32bpp sprites should be loaded, false for a 8bpp sprite.
+ * @param[out] fallback Set when the sprite has to be loaded with #LoadSprite instead, e.g. because it is corrupt.
+ * @return Bit mask of the zoom levels successfully loaded or 0 if no sprite could be loaded.
+ */
+uint8 SpriteLoaderGrf::DecodeRawSprite(SpriteLoader::Sprite *sprite, const byte *data, size_t size, uint8 file_slot, size_t file_pos, SpriteType sprite_type, bool load_32bpp, bool *fallback)
+{
+	assert(this->container_ver >= 2);
+
+	MemorySpriteReader reader(data, size, file_pos);
+	uint8 loaded_sprites = LoadSpriteV2(reader, sprite, file_slot, file_pos, sprite_type, load_32bpp);
+	*fallback = reader.fallback;
+	return loaded_sprites;
+}
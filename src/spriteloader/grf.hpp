@@ -20,6 +20,9 @@ class SpriteLoaderGrf : public SpriteLoader {
 public:
 	SpriteLoaderGrf(byte container_ver) : container_ver(container_ver) {}
 	uint8 LoadSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, bool load_32bpp);
+
+	byte *ReadRawSprite(uint8 file_slot, size_t file_pos, size_t *size);
+	uint8 DecodeRawSprite(SpriteLoader::Sprite *sprite, const byte *data, size_t size, uint8 file_slot, size_t file_pos, SpriteType sprite_type, bool load_32bpp, bool *fallback);
 };
 
 #endif /* SPRITELOADER_GRF_HPP */
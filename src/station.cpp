@@ -202,7 +202,7 @@ void Station::MarkTilesDirty(bool cargo_change) const
 	TileIndex tile = this->train_station.tile;
 	int w, h;
 
-	if (tile == INVALID_TILE) return;
+	if (tile == INVALID_TILE || _headless) return;
 
 	/* cargo_change is set if we're refreshing the tiles due to cargo moving
 	 * around. */
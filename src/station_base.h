@@ -13,6 +13,7 @@
 #define STATION_BASE_H
 
 #include "core/random_func.hpp"
+#include "core/flatmap.hpp"
 #include "base_station_base.h"
 #include "newgrf_airport.h"
 #include "cargopacket.h"
@@ -28,14 +29,15 @@ static const byte INITIAL_STATION_RATING = 175;
 
 /**
  * Flow statistics telling how much flow should be sent along a link. This is
- * done by creating "flow shares" and using std::map's upper_bound() method to
+ * done by creating "flow shares" and using the map's upper_bound() method to
  * look them up with a random number. A flow share is the difference between a
  * key in a map and the previous key. So one key in the map doesn't actually
- * mean anything by itself.
+ * mean anything by itself. The shares are kept in a sorted array, as they're
+ * looked up for every packet routed, but only rebuilt by the link graph.
  */
 class FlowStat {
 public:
-	typedef std::map<uint32, StationID> SharesMap;
+	typedef FlatMap<uint32, StationID> SharesMap;
 
 	static const SharesMap empty_sharesmap;
 
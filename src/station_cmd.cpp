@@ -4220,6 +4220,7 @@ void FlowStat::Invalidate()
 {
 	assert(!this->shares.empty());
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size() + 1);
 	uint i = 0;
 	for (SharesMap::iterator it(this->shares.begin()); it != this->shares.end(); ++it) {
 		new_shares[++i] = it->second;
@@ -4245,6 +4246,7 @@ void FlowStat::ChangeShare(StationID st, int flow)
 	uint added_shares = 0;
 	uint last_share = 0;
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size() + 1);
 	for (SharesMap::iterator it(this->shares.begin()); it != this->shares.end(); ++it) {
 		if (it->second == st) {
 			if (flow < 0) {
@@ -4291,6 +4293,7 @@ void FlowStat::RestrictShare(StationID st)
 	uint flow = 0;
 	uint last_share = 0;
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size() + 1);
 	for (SharesMap::iterator it(this->shares.begin()); it != this->shares.end(); ++it) {
 		if (flow == 0) {
 			if (it->first > this->unrestricted) return; // Not present or already restricted.
@@ -4336,6 +4339,7 @@ void FlowStat::ReleaseShare(StationID st)
 	}
 	if (flow == 0) return;
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size() + 1);
 	new_shares[flow] = st;
 	for (SharesMap::iterator it(this->shares.begin()); it != this->shares.end(); ++it) {
 		if (it->second != st) {
@@ -4357,6 +4361,7 @@ void FlowStat::ScaleToMonthly(uint runtime)
 {
 	assert(runtime > 0);
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size() + 1);
 	uint share = 0;
 	for (SharesMap::iterator i = this->shares.begin(); i != this->shares.end(); ++i) {
 		share = max(share + 1, i->first * 30 / runtime);
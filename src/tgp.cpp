@@ -16,6 +16,8 @@
 #include "genworld.h"
 #include "core/random_func.hpp"
 #include "landscape_type.h"
+#include "debug.h"
+#include "thread/thread.h"
 
 #include "safeguards.h"
 
@@ -299,6 +301,61 @@ static inline bool IsValidXY(int x, int y)
 }
 
 
+/** Minimum number of heights a thread of HeightMapParallel processes. */
+static const int HEIGHT_MAP_THREAD_THRESHOLD = 65536;
+
+/**
+ * Number of threads HeightMapParallel uses, or 0 to choose it by the number of
+ * processor cores and the size of the map. The generated height map is the same
+ * for any number of threads; this is for testing that.
+ */
+uint _tgp_threads = 0;
+
+/**
+ * Processes a range of rows or columns of the height map.
+ * @param begin The first row or column to process.
+ * @param end The row or column after the last one to process.
+ * @param data The parameters of the pass.
+ */
+typedef void HeightMapRangeProc(int begin, int end, void *data);
+
+/** A pass of HeightMapParallel. */
+struct HeightMapPass {
+	HeightMapRangeProc *proc; ///< The pass to run.
+	void *data;               ///< The parameters of the pass.
+};
+
+/**
+ * Run a part of a HeightMapParallel call.
+ * @param part Unused.
+ * @param begin The first row or column to process.
+ * @param end The row or column after the last one to process.
+ * @param data The HeightMapPass to run.
+ */
+static void HeightMapPassThread(uint part, uint begin, uint end, void *data)
+{
+	HeightMapPass *pass = (HeightMapPass *)data;
+	pass->proc(begin, end, pass->data);
+}
+
+/**
+ * Run a pass over the height map, splitting its rows or columns over multiple threads.
+ * The pass may only change the heights of the rows or columns it is given, and may
+ * not use the random number generator, so the result does not depend on the number
+ * of threads.
+ * @param proc The pass to run.
+ * @param data The parameters of the pass.
+ * @param count The number of rows or columns to process.
+ * @param heights The number of heights in each row or column.
+ */
+static void HeightMapParallel(HeightMapRangeProc *proc, void *data, int count, int heights)
+{
+	uint num_threads = _tgp_threads != 0 ? _tgp_threads : min<int>(GetCPUCoreCount(), count * heights / HEIGHT_MAP_THREAD_THRESHOLD);
+
+	HeightMapPass pass = { proc, data };
+	RunParallel(&HeightMapPassThread, &pass, count, num_threads, "ottd:tgp");
+}
+
 /**
  * Allocate array of (MapSizeX()+1)*(MapSizeY()+1) heights and init the _height_map structure members
  * @return true on success
@@ -339,6 +396,44 @@ static inline height_t RandomHeight(amplitude_t rMax)
 	return A2H(RandomRange(2 * rMax + 1) - rMax);
 }
 
+/**
+ * Interpolate the heights at odd x, even y tiles of a range of rows.
+ * @param begin The first row to process, in steps of two times the step.
+ * @param end The row after the last one to process, in steps of two times the step.
+ * @param data The step between the tiles with known heights.
+ */
+static void HeightMapInterpolateX(int begin, int end, void *data)
+{
+	const int step = *(int *)data;
+	for (int y = begin * 2 * step; y < end * 2 * step; y += 2 * step) {
+		for (int x = 0; x <= _height_map.size_x - 2 * step; x += 2 * step) {
+			height_t h00 = _height_map.height(x + 0 * step, y);
+			height_t h02 = _height_map.height(x + 2 * step, y);
+			height_t h01 = (h00 + h02) / 2;
+			_height_map.height(x + 1 * step, y) = h01;
+		}
+	}
+}
+
+/**
+ * Interpolate the heights at odd y tiles of a range of rows.
+ * @param begin The first row to process, in steps of two times the step.
+ * @param end The row after the last one to process, in steps of two times the step.
+ * @param data The step between the tiles with known heights.
+ */
+static void HeightMapInterpolateY(int begin, int end, void *data)
+{
+	const int step = *(int *)data;
+	for (int y = begin * 2 * step; y < end * 2 * step; y += 2 * step) {
+		for (int x = 0; x <= _height_map.size_x; x += step) {
+			height_t h00 = _height_map.height(x, y + 0 * step);
+			height_t h20 = _height_map.height(x, y + 2 * step);
+			height_t h10 = (h00 + h20) / 2;
+			_height_map.height(x, y + 1 * step) = h10;
+		}
+	}
+}
+
 /**
  * Base Perlin noise generator - fills height map with raw Perlin noise.
  *
@@ -377,24 +472,11 @@ static void HeightMapGenerate()
 
 		/* It is regular iteration round.
 		 * Interpolate height values at odd x, even y tiles */
-		for (int y = 0; y <= _height_map.size_y; y += 2 * step) {
-			for (int x = 0; x <= _height_map.size_x - 2 * step; x += 2 * step) {
-				height_t h00 = _height_map.height(x + 0 * step, y);
-				height_t h02 = _height_map.height(x + 2 * step, y);
-				height_t h01 = (h00 + h02) / 2;
-				_height_map.height(x + 1 * step, y) = h01;
-			}
-		}
+		int step_data = step;
+		HeightMapParallel(&HeightMapInterpolateX, &step_data, _height_map.size_y / (2 * step) + 1, _height_map.dim_x / 2);
 
 		/* Interpolate height values at odd y tiles */
-		for (int y = 0; y <= _height_map.size_y - 2 * step; y += 2 * step) {
-			for (int x = 0; x <= _height_map.size_x; x += step) {
-				height_t h00 = _height_map.height(x, y + 0 * step);
-				height_t h20 = _height_map.height(x, y + 2 * step);
-				height_t h10 = (h00 + h20) / 2;
-				_height_map.height(x, y + 1 * step) = h10;
-			}
-		}
+		HeightMapParallel(&HeightMapInterpolateY, &step_data, _height_map.size_y / (2 * step), _height_map.dim_x);
 
 		/* Add noise for next higher frequency (smaller steps) */
 		for (int y = 0; y <= _height_map.size_y; y += step) {
@@ -443,12 +525,24 @@ static int *HeightMapMakeHistogram(height_t h_min, height_t h_max, int *hist_buf
 	return hist;
 }
 
-/** Applies sine wave redistribution onto height map */
-static void HeightMapSineTransform(height_t h_min, height_t h_max)
+/** Parameters of HeightMapSineTransformRows. */
+struct SineTransformData {
+	height_t h_min; ///< Heights below this height are not changed.
+	height_t h_max; ///< Maximum height after the transformation.
+};
+
+/**
+ * Applies sine wave redistribution onto a range of rows of the height map.
+ * @param begin The first row to transform.
+ * @param end The row after the last one to transform.
+ * @param data The SineTransformData of the transformation.
+ */
+static void HeightMapSineTransformRows(int begin, int end, void *data)
 {
-	height_t *h;
+	const height_t h_min = ((SineTransformData *)data)->h_min;
+	const height_t h_max = ((SineTransformData *)data)->h_max;
 
-	FOR_ALL_TILES_IN_HEIGHT(h) {
+	for (height_t *h = &_height_map.height(0, begin); h < &_height_map.height(0, end); h++) {
 		double fheight;
 
 		if (*h < h_min) continue;
@@ -520,103 +614,95 @@ static void HeightMapSineTransform(height_t h_min, height_t h_max)
 	}
 }
 
-/**
- * Additional map variety is provided by applying different curve maps
- * to different parts of the map. A randomized low resolution grid contains
- * which curve map to use on each part of the make. This filtered non-linearly
- * to smooth out transitions between curves, so each tile could have between
- * 100% of one map applied or 25% of four maps.
- *
- * The curve maps define different land styles, i.e. lakes, low-lands, hills
- * and mountain ranges, although these are dependent on the landscape style
- * chosen as well.
- *
- * The level parameter dictates the resolution of the grid. A low resolution
- * grid will result in larger continuous areas of a land style, a higher
- * resolution grid splits the style into smaller areas.
- * @param level Rough indication of the size of the grid sections to style. Small level means large grid sections.
- */
-static void HeightMapCurves(uint level)
+/** Applies sine wave redistribution onto height map */
+static void HeightMapSineTransform(height_t h_min, height_t h_max)
 {
-	height_t mh = TGPGetMaxHeight() - I2H(1); // height levels above sea level only
+	SineTransformData data = { h_min, h_max };
+	HeightMapParallel(&HeightMapSineTransformRows, &data, _height_map.size_y + 1, _height_map.dim_x);
+}
 
-	/** Basically scale height X to height Y. Everything in between is interpolated. */
-	struct control_point_t {
-		height_t x; ///< The height to scale from.
-		height_t y; ///< The height to scale to.
-	};
-	/* Scaled curve maps; value is in height_ts. */
-#define F(fraction) ((height_t)(fraction * mh))
-	const control_point_t curve_map_1[] = { { F(0.0), F(0.0) },                       { F(0.8), F(0.13) },                       { F(1.0), F(0.4)  } };
-	const control_point_t curve_map_2[] = { { F(0.0), F(0.0) }, { F(0.53), F(0.13) }, { F(0.8), F(0.27) },                       { F(1.0), F(0.6)  } };
-	const control_point_t curve_map_3[] = { { F(0.0), F(0.0) }, { F(0.53), F(0.27) }, { F(0.8), F(0.57) },                       { F(1.0), F(0.8)  } };
-	const control_point_t curve_map_4[] = { { F(0.0), F(0.0) }, { F(0.4),  F(0.3)  }, { F(0.7), F(0.8)  }, { F(0.92), F(0.99) }, { F(1.0), F(0.99) } };
-#undef F
+/** Basically scale height X to height Y. Everything in between is interpolated. */
+struct control_point_t {
+	height_t x; ///< The height to scale from.
+	height_t y; ///< The height to scale to.
+};
 
-	/** Helper structure to index the different curve maps. */
-	struct control_point_list_t {
-		size_t length;               ///< The length of the curve map.
-		const control_point_t *list; ///< The actual curve map.
-	};
-	const control_point_list_t curve_maps[] = {
-		{ lengthof(curve_map_1), curve_map_1 },
-		{ lengthof(curve_map_2), curve_map_2 },
-		{ lengthof(curve_map_3), curve_map_3 },
-		{ lengthof(curve_map_4), curve_map_4 },
-	};
+/** Helper structure to index the different curve maps. */
+struct control_point_list_t {
+	size_t length;               ///< The length of the curve map.
+	const control_point_t *list; ///< The actual curve map.
+};
 
-	height_t ht[lengthof(curve_maps)];
-	MemSetT(ht, 0, lengthof(ht));
+/** Number of different curve maps used by HeightMapCurves. */
+static const uint NUM_CURVE_MAPS = 4;
 
-	/* Set up a grid to choose curve maps based on location; attempt to get a somewhat square grid */
-	float factor = sqrt((float)_height_map.size_x / (float)_height_map.size_y);
-	uint sx = Clamp((int)(((1 << level) * factor) + 0.5), 1, 128);
-	uint sy = Clamp((int)(((1 << level) / factor) + 0.5), 1, 128);
-	byte *c = AllocaM(byte, sx * sy);
+/** Position of a row or column of the height map in the grid of curve maps. */
+struct CurveGridPosition {
+	uint p1;  ///< Grid position of the curve map before the row or column.
+	uint p2;  ///< Grid position of the curve map after the row or column.
+	float r;  ///< Bi-linear ratio of the curve map after the row or column.
+	float ri; ///< Bi-linear ratio of the curve map before the row or column.
+};
 
-	for (uint i = 0; i < sx * sy; i++) {
-		c[i] = Random() % lengthof(curve_maps);
+/**
+ * Get the position of a row or column of the height map in the grid of curve maps.
+ * @param pos The row or column.
+ * @param size The number of rows or columns of the height map.
+ * @param grid_size The number of rows or columns of the grid.
+ * @return The grid positions and bi-linear ratio.
+ */
+static CurveGridPosition GetCurveGridPosition(int pos, int size, uint grid_size)
+{
+	CurveGridPosition p;
+	float f = (float)(grid_size * pos) / size + 1.0f;
+	p.p1 = (uint)f;
+	p.p2 = p.p1;
+	float r = 2.0f * (f - p.p1) - 1.0f;
+	r = sin(r * M_PI_2);
+	r = sin(r * M_PI_2);
+	p.r = 0.5f * (r + 1.0f);
+	p.ri = 1.0f - p.r;
+
+	if (p.p1 > 0) {
+		p.p1--;
+		if (p.p2 >= grid_size) p.p2--;
 	}
+	return p;
+}
 
-	/* Apply curves */
-	for (int x = 0; x < _height_map.size_x; x++) {
+/** Parameters of HeightMapCurvesRows. */
+struct CurvesData {
+	const control_point_list_t *curve_maps; ///< The curve maps to apply.
+	const byte *grid;                       ///< The curve map to use for each section of the grid.
+	uint sx;                                ///< Number of columns of the grid.
+	uint sy;                                ///< Number of rows of the grid.
+	const CurveGridPosition *columns;       ///< Grid positions of the columns of the height map.
+};
 
-		/* Get our X grid positions and bi-linear ratio */
-		float fx = (float)(sx * x) / _height_map.size_x + 1.0f;
-		uint x1 = (uint)fx;
-		uint x2 = x1;
-		float xr = 2.0f * (fx - x1) - 1.0f;
-		xr = sin(xr * M_PI_2);
-		xr = sin(xr * M_PI_2);
-		xr = 0.5f * (xr + 1.0f);
-		float xri = 1.0f - xr;
-
-		if (x1 > 0) {
-			x1--;
-			if (x2 >= sx) x2--;
-		}
+/**
+ * Apply the curve maps to a range of rows of the height map.
+ * @param begin The first row to process.
+ * @param end The row after the last one to process.
+ * @param data The CurvesData of the curve maps.
+ */
+static void HeightMapCurvesRows(int begin, int end, void *data)
+{
+	const CurvesData *cd = (const CurvesData *)data;
 
-		for (int y = 0; y < _height_map.size_y; y++) {
-
-			/* Get our Y grid position and bi-linear ratio */
-			float fy = (float)(sy * y) / _height_map.size_y + 1.0f;
-			uint y1 = (uint)fy;
-			uint y2 = y1;
-			float yr = 2.0f * (fy - y1) - 1.0f;
-			yr = sin(yr * M_PI_2);
-			yr = sin(yr * M_PI_2);
-			yr = 0.5f * (yr + 1.0f);
-			float yri = 1.0f - yr;
-
-			if (y1 > 0) {
-				y1--;
-				if (y2 >= sy) y2--;
-			}
+	height_t ht[NUM_CURVE_MAPS];
+	MemSetT(ht, 0, lengthof(ht));
 
-			uint corner_a = c[x1 + sx * y1];
-			uint corner_b = c[x1 + sx * y2];
-			uint corner_c = c[x2 + sx * y1];
-			uint corner_d = c[x2 + sx * y2];
+	for (int y = begin; y < end; y++) {
+		/* Get our Y grid position and bi-linear ratio */
+		const CurveGridPosition py = GetCurveGridPosition(y, _height_map.size_y, cd->sy);
+
+		for (int x = 0; x < _height_map.size_x; x++) {
+			const CurveGridPosition &px = cd->columns[x];
+
+			uint corner_a = cd->grid[px.p1 + cd->sx * py.p1];
+			uint corner_b = cd->grid[px.p1 + cd->sx * py.p2];
+			uint corner_c = cd->grid[px.p2 + cd->sx * py.p1];
+			uint corner_d = cd->grid[px.p2 + cd->sx * py.p2];
 
 			/* Bitmask of which curve maps are chosen, so that we do not bother
 			 * calculating a curve which won't be used. */
@@ -635,12 +721,12 @@ static void HeightMapCurves(uint level)
 			*h -= I2H(1);
 
 			/* Apply all curve maps that are used on this tile. */
-			for (uint t = 0; t < lengthof(curve_maps); t++) {
+			for (uint t = 0; t < NUM_CURVE_MAPS; t++) {
 				if (!HasBit(corner_bits, t)) continue;
 
 				bool found = false;
-				const control_point_t *cm = curve_maps[t].list;
-				for (uint i = 0; i < curve_maps[t].length - 1; i++) {
+				const control_point_t *cm = cd->curve_maps[t].list;
+				for (uint i = 0; i < cd->curve_maps[t].length - 1; i++) {
 					const control_point_t &p1 = cm[i];
 					const control_point_t &p2 = cm[i + 1];
 
@@ -654,7 +740,7 @@ static void HeightMapCurves(uint level)
 			}
 
 			/* Apply interpolation of curve map results. */
-			*h = (height_t)((ht[corner_a] * yri + ht[corner_b] * yr) * xri + (ht[corner_c] * yri + ht[corner_d] * yr) * xr);
+			*h = (height_t)((ht[corner_a] * py.ri + ht[corner_b] * py.r) * px.ri + (ht[corner_c] * py.ri + ht[corner_d] * py.r) * px.r);
 
 			/* Readd sea level */
 			*h += I2H(1);
@@ -662,6 +748,64 @@ static void HeightMapCurves(uint level)
 	}
 }
 
+/**
+ * Additional map variety is provided by applying different curve maps
+ * to different parts of the map. A randomized low resolution grid contains
+ * which curve map to use on each part of the make. This filtered non-linearly
+ * to smooth out transitions between curves, so each tile could have between
+ * 100% of one map applied or 25% of four maps.
+ *
+ * The curve maps define different land styles, i.e. lakes, low-lands, hills
+ * and mountain ranges, although these are dependent on the landscape style
+ * chosen as well.
+ *
+ * The level parameter dictates the resolution of the grid. A low resolution
+ * grid will result in larger continuous areas of a land style, a higher
+ * resolution grid splits the style into smaller areas.
+ * @param level Rough indication of the size of the grid sections to style. Small level means large grid sections.
+ */
+static void HeightMapCurves(uint level)
+{
+	height_t mh = TGPGetMaxHeight() - I2H(1); // height levels above sea level only
+
+	/* Scaled curve maps; value is in height_ts. */
+#define F(fraction) ((height_t)(fraction * mh))
+	const control_point_t curve_map_1[] = { { F(0.0), F(0.0) },                       { F(0.8), F(0.13) },                       { F(1.0), F(0.4)  } };
+	const control_point_t curve_map_2[] = { { F(0.0), F(0.0) }, { F(0.53), F(0.13) }, { F(0.8), F(0.27) },                       { F(1.0), F(0.6)  } };
+	const control_point_t curve_map_3[] = { { F(0.0), F(0.0) }, { F(0.53), F(0.27) }, { F(0.8), F(0.57) },                       { F(1.0), F(0.8)  } };
+	const control_point_t curve_map_4[] = { { F(0.0), F(0.0) }, { F(0.4),  F(0.3)  }, { F(0.7), F(0.8)  }, { F(0.92), F(0.99) }, { F(1.0), F(0.99) } };
+#undef F
+
+	const control_point_list_t curve_maps[NUM_CURVE_MAPS] = {
+		{ lengthof(curve_map_1), curve_map_1 },
+		{ lengthof(curve_map_2), curve_map_2 },
+		{ lengthof(curve_map_3), curve_map_3 },
+		{ lengthof(curve_map_4), curve_map_4 },
+	};
+
+	/* Set up a grid to choose curve maps based on location; attempt to get a somewhat square grid */
+	float factor = sqrt((float)_height_map.size_x / (float)_height_map.size_y);
+	uint sx = Clamp((int)(((1 << level) * factor) + 0.5), 1, 128);
+	uint sy = Clamp((int)(((1 << level) / factor) + 0.5), 1, 128);
+	byte *c = AllocaM(byte, sx * sy);
+
+	for (uint i = 0; i < sx * sy; i++) {
+		c[i] = Random() % lengthof(curve_maps);
+	}
+
+	/* Get our X grid positions and bi-linear ratios */
+	CurveGridPosition *columns = MallocT<CurveGridPosition>(_height_map.size_x);
+	for (int x = 0; x < _height_map.size_x; x++) {
+		columns[x] = GetCurveGridPosition(x, _height_map.size_x, sx);
+	}
+
+	/* Apply curves */
+	CurvesData data = { curve_maps, c, sx, sy, columns };
+	HeightMapParallel(&HeightMapCurvesRows, &data, _height_map.size_y, _height_map.size_x);
+
+	free(columns);
+}
+
 /** Adjusts heights in height map to contain required amount of water tiles */
 static void HeightMapAdjustWaterLevel(amplitude_t water_percent, height_t h_max_new)
 {
@@ -706,35 +850,21 @@ static void HeightMapAdjustWaterLevel(amplitude_t water_percent, height_t h_max_
 static double perlin_coast_noise_2D(const double x, const double y, const double p, const int prime);
 
 /**
- * This routine sculpts in from the edge a random amount, again a Perlin
- * sequence, to avoid the rigid flat-edge slopes that were present before. The
- * Perlin noise map doesn't know where we are going to slice across, and so we
- * often cut straight through high terrain. The smoothing routine makes it
- * legal, gradually increasing up from the edge to the original terrain height.
- * By cutting parts of this away, it gives a far more irregular edge to the
- * map-edge. Sometimes it works beautifully with the existing sea & lakes, and
- * creates a very realistic coastline. Other times the variation is less, and
- * the map-edge shows its cliff-like roots.
- *
- * This routine may be extended to randomly sculpt the height of the terrain
- * near the edge. This will have the coast edge at low level (1-3), rising in
- * smoothed steps inland to about 15 tiles in. This should make it look as
- * though the map has been built for the map size, rather than a slice through
- * a larger map.
- *
- * Please note that all the small numbers; 53, 101, 167, etc. are small primes
- * to help give the perlin noise a bit more of a random feel.
+ * Lower a range of rows near the north east and south west borders to sea level.
+ * @param begin The first row to process.
+ * @param end The row after the last one to process.
+ * @param data The borders that are lowered.
  */
-static void HeightMapCoastLines(uint8 water_borders)
+static void HeightMapCoastLinesRows(int begin, int end, void *data)
 {
+	const uint8 water_borders = *(uint8 *)data;
 	int smallest_size = min(_settings_game.game_creation.map_x, _settings_game.game_creation.map_y);
 	const int margin = 4;
 	int y, x;
 	double max_x;
-	double max_y;
 
 	/* Lower to sea level */
-	for (y = 0; y <= _height_map.size_y; y++) {
+	for (y = begin; y < end; y++) {
 		if (HasBit(water_borders, BORDER_NE)) {
 			/* Top right */
 			max_x = abs((perlin_coast_noise_2D(_height_map.size_y - y, y, 0.9, 53) + 0.25) * 5 + (perlin_coast_noise_2D(y, y, 0.35, 179) + 1) * 12);
@@ -755,9 +885,24 @@ static void HeightMapCoastLines(uint8 water_borders)
 			}
 		}
 	}
+}
+
+/**
+ * Lower a range of columns near the north west and south east borders to sea level.
+ * @param begin The first column to process.
+ * @param end The column after the last one to process.
+ * @param data The borders that are lowered.
+ */
+static void HeightMapCoastLinesColumns(int begin, int end, void *data)
+{
+	const uint8 water_borders = *(uint8 *)data;
+	int smallest_size = min(_settings_game.game_creation.map_x, _settings_game.game_creation.map_y);
+	const int margin = 4;
+	int y, x;
+	double max_y;
 
 	/* Lower to sea level */
-	for (x = 0; x <= _height_map.size_x; x++) {
+	for (x = begin; x < end; x++) {
 		if (HasBit(water_borders, BORDER_NW)) {
 			/* Top left */
 			max_y = abs((perlin_coast_noise_2D(x, _height_map.size_y / 2, 0.9, 167) + 0.4) * 5 + (perlin_coast_noise_2D(x, _height_map.size_y / 3, 0.4, 211) + 0.7) * 9);
@@ -780,6 +925,32 @@ static void HeightMapCoastLines(uint8 water_borders)
 	}
 }
 
+/**
+ * This routine sculpts in from the edge a random amount, again a Perlin
+ * sequence, to avoid the rigid flat-edge slopes that were present before. The
+ * Perlin noise map doesn't know where we are going to slice across, and so we
+ * often cut straight through high terrain. The smoothing routine makes it
+ * legal, gradually increasing up from the edge to the original terrain height.
+ * By cutting parts of this away, it gives a far more irregular edge to the
+ * map-edge. Sometimes it works beautifully with the existing sea & lakes, and
+ * creates a very realistic coastline. Other times the variation is less, and
+ * the map-edge shows its cliff-like roots.
+ *
+ * This routine may be extended to randomly sculpt the height of the terrain
+ * near the edge. This will have the coast edge at low level (1-3), rising in
+ * smoothed steps inland to about 15 tiles in. This should make it look as
+ * though the map has been built for the map size, rather than a slice through
+ * a larger map.
+ *
+ * Please note that all the small numbers; 53, 101, 167, etc. are small primes
+ * to help give the perlin noise a bit more of a random feel.
+ */
+static void HeightMapCoastLines(uint8 water_borders)
+{
+	HeightMapParallel(&HeightMapCoastLinesRows, &water_borders, _height_map.size_y + 1, _height_map.dim_x);
+	HeightMapParallel(&HeightMapCoastLinesColumns, &water_borders, _height_map.size_x + 1, _height_map.size_y + 1);
+}
+
 /** Start at given point, move in given direction, find and Smooth coast in that direction */
 static void HeightMapSmoothCoastInDirection(int org_x, int org_y, int dir_x, int dir_y)
 {
@@ -834,28 +1005,92 @@ static void HeightMapSmoothCoasts(uint8 water_borders)
 }
 
 /**
- * This routine provides the essential cleanup necessary before OTTD can
- * display the terrain. When generated, the terrain heights can jump more than
- * one level between tiles. This routine smooths out those differences so that
- * the most it can change is one level. When OTTD can support cliffs, this
- * routine may not be necessary.
+ * Limit the heights of a range of rows by their neighbours to the north east.
+ * @param begin The first row to process.
+ * @param end The row after the last one to process.
+ * @param data The maximum height difference between neighbours.
  */
-static void HeightMapSmoothSlopes(height_t dh_max)
+static void HeightMapSmoothSlopesRowsNorth(int begin, int end, void *data)
 {
-	for (int y = 0; y <= (int)_height_map.size_y; y++) {
-		for (int x = 0; x <= (int)_height_map.size_x; x++) {
-			height_t h_max = min(_height_map.height(x > 0 ? x - 1 : x, y), _height_map.height(x, y > 0 ? y - 1 : y)) + dh_max;
+	const height_t dh_max = *(height_t *)data;
+	for (int y = begin; y < end; y++) {
+		for (int x = 1; x <= _height_map.size_x; x++) {
+			height_t h_max = _height_map.height(x - 1, y) + dh_max;
 			if (_height_map.height(x, y) > h_max) _height_map.height(x, y) = h_max;
 		}
 	}
-	for (int y = _height_map.size_y; y >= 0; y--) {
-		for (int x = _height_map.size_x; x >= 0; x--) {
-			height_t h_max = min(_height_map.height(x < _height_map.size_x ? x + 1 : x, y), _height_map.height(x, y < _height_map.size_y ? y + 1 : y)) + dh_max;
+}
+
+/**
+ * Limit the heights of a range of columns by their neighbours to the north west.
+ * @param begin The first column to process.
+ * @param end The column after the last one to process.
+ * @param data The maximum height difference between neighbours.
+ */
+static void HeightMapSmoothSlopesColumnsNorth(int begin, int end, void *data)
+{
+	const height_t dh_max = *(height_t *)data;
+	for (int y = 1; y <= _height_map.size_y; y++) {
+		for (int x = begin; x < end; x++) {
+			height_t h_max = _height_map.height(x, y - 1) + dh_max;
 			if (_height_map.height(x, y) > h_max) _height_map.height(x, y) = h_max;
 		}
 	}
 }
 
+/**
+ * Limit the heights of a range of rows by their neighbours to the south west.
+ * @param begin The first row to process.
+ * @param end The row after the last one to process.
+ * @param data The maximum height difference between neighbours.
+ */
+static void HeightMapSmoothSlopesRowsSouth(int begin, int end, void *data)
+{
+	const height_t dh_max = *(height_t *)data;
+	for (int y = begin; y < end; y++) {
+		for (int x = _height_map.size_x - 1; x >= 0; x--) {
+			height_t h_max = _height_map.height(x + 1, y) + dh_max;
+			if (_height_map.height(x, y) > h_max) _height_map.height(x, y) = h_max;
+		}
+	}
+}
+
+/**
+ * Limit the heights of a range of columns by their neighbours to the south east.
+ * @param begin The first column to process.
+ * @param end The column after the last one to process.
+ * @param data The maximum height difference between neighbours.
+ */
+static void HeightMapSmoothSlopesColumnsSouth(int begin, int end, void *data)
+{
+	const height_t dh_max = *(height_t *)data;
+	for (int y = _height_map.size_y - 1; y >= 0; y--) {
+		for (int x = begin; x < end; x++) {
+			height_t h_max = _height_map.height(x, y + 1) + dh_max;
+			if (_height_map.height(x, y) > h_max) _height_map.height(x, y) = h_max;
+		}
+	}
+}
+
+/**
+ * This routine provides the essential cleanup necessary before OTTD can
+ * display the terrain. When generated, the terrain heights can jump more than
+ * one level between tiles. This routine smooths out those differences so that
+ * the most it can change is one level. When OTTD can support cliffs, this
+ * routine may not be necessary.
+ */
+static void HeightMapSmoothSlopes(height_t dh_max)
+{
+	/* Limiting each height by its lower neighbour in the north west and north east
+	 * is the same as limiting it by all heights to the north, based on the distance
+	 * to them. That can be done for the rows and then for the columns, so the rows
+	 * and columns can be processed independently. The same goes for the south. */
+	HeightMapParallel(&HeightMapSmoothSlopesRowsNorth, &dh_max, _height_map.size_y + 1, _height_map.dim_x);
+	HeightMapParallel(&HeightMapSmoothSlopesColumnsNorth, &dh_max, _height_map.dim_x, _height_map.size_y + 1);
+	HeightMapParallel(&HeightMapSmoothSlopesRowsSouth, &dh_max, _height_map.size_y + 1, _height_map.dim_x);
+	HeightMapParallel(&HeightMapSmoothSlopesColumnsSouth, &dh_max, _height_map.dim_x, _height_map.size_y + 1);
+}
+
 /**
  * Height map terraform post processing:
  *  - water level adjusting
@@ -973,6 +1208,21 @@ static void TgenSetTileHeight(TileIndex tile, int height)
 	}
 }
 
+/**
+ * Get a hash of the height map, to check that the same height map is generated
+ * for the same seed and settings, e.g. when changing the generator.
+ * @return The FNV-1a hash of the heights.
+ */
+static uint32 HeightMapHash()
+{
+	uint32 hash = 2166136261U;
+	height_t *h;
+	FOR_ALL_TILES_IN_HEIGHT(h) {
+		hash = (hash ^ (uint16)*h) * 16777619U;
+	}
+	return hash;
+}
+
 /**
  * The main new land generator using Perlin noise. Desert landscape is handled
  * different to all others to give a desert valley between two high mountains.
@@ -1001,6 +1251,8 @@ void GenerateTerrainPerlin()
 
 	int max_height = H2I(TGPGetMaxHeight());
 
+	DEBUG(map, 1, "Generated height map with hash %08x", HeightMapHash());
+
 	/* Transfer height map into OTTD map */
 	for (int y = 0; y < _height_map.size_y; y++) {
 		for (int x = 0; x < _height_map.size_x; x++) {
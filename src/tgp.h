@@ -12,6 +12,8 @@
 #ifndef TGP_H
 #define TGP_H
 
+extern uint _tgp_threads;
+
 void GenerateTerrainPerlin();
 
 #endif /* TGP_H */
@@ -0,0 +1,74 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file parallel.cpp Running a job on multiple threads. */
+
+#include "../stdafx.h"
+#include "../core/math_func.hpp"
+#include "thread.h"
+
+#include "../safeguards.h"
+
+/** A part of a job of RunParallel, which is run by a single thread. */
+struct ParallelJobPart {
+	ParallelJobProc *proc; ///< The procedure that runs the parts of the job.
+	void *data;            ///< The data of the job.
+	uint part;             ///< The number of the part.
+	uint begin;            ///< The first element of the part.
+	uint end;              ///< The element after the last one of the part.
+	ThreadObject *thread;  ///< The thread of the part, or NULL when run by the calling thread.
+};
+
+/**
+ * Run a part of a job of RunParallel.
+ * @param arg The ParallelJobPart to run.
+ */
+static void ParallelJobThread(void *arg)
+{
+	ParallelJobPart *part = (ParallelJobPart *)arg;
+	part->proc(part->part, part->begin, part->end, part->data);
+}
+
+/**
+ * Run a job on multiple threads. The elements of the job are split into parts
+ * of consecutive elements, one for each thread. The calling thread runs the first
+ * part itself and then waits for the other threads; parts for which no thread
+ * could be started are run by the calling thread too.
+ * @param proc The procedure that runs a part of the job.
+ * @param data The data of the job, which is passed to \a proc.
+ * @param count The number of elements of the job.
+ * @param num_threads The number of threads to use, including the calling thread.
+ *                    At most #MAX_PARALLEL_THREADS threads and one thread for each element are used.
+ * @param name The name of the started threads.
+ */
+void RunParallel(ParallelJobProc *proc, void *data, uint count, uint num_threads, const char *name)
+{
+	num_threads = Clamp(min(num_threads, count), 1U, MAX_PARALLEL_THREADS);
+
+	ParallelJobPart parts[MAX_PARALLEL_THREADS];
+	for (uint i = 0; i < num_threads; i++) {
+		parts[i].proc = proc;
+		parts[i].data = data;
+		parts[i].part = i;
+		parts[i].begin = (uint)((uint64)count * i / num_threads);
+		parts[i].end = (uint)((uint64)count * (i + 1) / num_threads);
+		parts[i].thread = NULL;
+		if (i != 0 && !ThreadObject::New(&ParallelJobThread, &parts[i], &parts[i].thread, name)) parts[i].thread = NULL;
+	}
+
+	ParallelJobThread(&parts[0]);
+	for (uint i = 1; i < num_threads; i++) {
+		if (parts[i].thread != NULL) {
+			parts[i].thread->Join();
+			delete parts[i].thread;
+		} else {
+			ParallelJobThread(&parts[i]);
+		}
+	}
+}
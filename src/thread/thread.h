@@ -123,4 +123,18 @@ private:
  */
 uint GetCPUCoreCount();
 
+/** Maximum number of threads RunParallel runs a job on. */
+static const uint MAX_PARALLEL_THREADS = 8;
+
+/**
+ * Run a part of a job of RunParallel.
+ * @param part The number of the part, which is below the number of threads of the job.
+ * @param begin The first element of the part.
+ * @param end The element after the last one of the part.
+ * @param data The data of the job.
+ */
+typedef void ParallelJobProc(uint part, uint begin, uint end, void *data);
+
+void RunParallel(ParallelJobProc *proc, void *data, uint count, uint num_threads, const char *name);
+
 #endif /* THREAD_H */
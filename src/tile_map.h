@@ -16,6 +16,7 @@
 #include "map_func.h"
 #include "core/bitmath_func.hpp"
 #include "settings_type.h"
+#include "pathfinder/water_regions.h"
 
 /**
  * Returns the height of a tile
@@ -61,6 +62,7 @@ static inline void SetTileHeight(TileIndex tile, uint height)
 	assert(tile < MapSize());
 	assert(height <= MAX_TILE_HEIGHT);
 	_m[tile].height = height;
+	InvalidateWaterRegionsAroundCorner(tile);
 }
 
 /**
@@ -138,6 +140,7 @@ static inline void SetTileType(TileIndex tile, TileType type)
 	 * the upper edges of the map are also VOID tiles. */
 	assert(IsInnerTile(tile) == (type != MP_VOID));
 	SB(_m[tile].type, 4, 4, type);
+	InvalidateWaterRegion(tile);
 }
 
 /**
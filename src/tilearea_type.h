@@ -48,6 +48,8 @@ struct OrthogonalTileArea {
 
 	bool Contains(TileIndex tile) const;
 
+	OrthogonalTileArea &Expand(int rad);
+
 	void ClampToMap();
 
 	/**
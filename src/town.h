@@ -40,6 +40,7 @@ static const uint16 MAX_TOWN_GROWTH_TICKS = 930; ///< Max amount of original tow
 
 typedef Pool<Town, TownID, 64, 64000> TownPool;
 extern TownPool _town_pool;
+extern uint32 _town_growth_ticks;
 
 /** Data structure with cached data of towns. */
 struct TownCache {
@@ -91,7 +92,8 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 
 	uint16 time_until_rebuild;     ///< time until we rebuild a house
 
-	uint16 grow_counter;           ///< counter to count when to grow, value is smaller than or equal to growth_rate
+	uint16 grow_counter;           ///< counter to count when to grow, value is smaller than or equal to growth_rate; only up to date when the town isn't growing, see GetGrowCounter()
+	uint32 grow_tick;              ///< NOSAVE: value of #_town_growth_ticks at which a growing town grows next
 	uint16 growth_rate;            ///< town growth rate
 
 	byte fund_buildings_months;    ///< fund buildings program in action?
@@ -129,6 +131,10 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 
 	void UpdateVirtCoord();
 
+	uint16 GetGrowCounter() const;
+	void SetGrowCounter(uint16 counter);
+	void SetGrowing(bool growing);
+
 	static inline Town *GetByTile(TileIndex tile)
 	{
 		return Town::Get(GetTownIndex(tile));
@@ -183,6 +189,7 @@ void ResetHouses();
 void ClearTownHouse(Town *t, TileIndex tile);
 void UpdateTownMaxPass(Town *t);
 void UpdateTownRadius(Town *t);
+void RebuildTownGrowthSchedule();
 void UpdateTownCargoes(Town *t);
 void UpdateTownCargoTotal(Town *t);
 void UpdateTownCargoBitmap();
@@ -59,6 +59,93 @@ CargoTypes _town_cargoes_accepted; ///< Bitmap of all cargoes accepted by houses
 TownPool _town_pool("Town");
 INSTANTIATE_POOL_METHODS(Town)
 
+uint32 _town_growth_ticks; ///< Number of ticks towns have been handled in.
+
+static const uint TOWN_GROWTH_SCHEDULE_SLOTS = 1024; ///< Number of slots growing towns are divided over by the tick they grow next.
+static std::vector<TownID> _town_growth_schedule[TOWN_GROWTH_SCHEDULE_SLOTS]; ///< Growing towns per slot, sorted by index.
+
+/**
+ * Add a growing town to the slot of the tick it grows next.
+ * @param t The town.
+ */
+static void ScheduleTownGrowth(const Town *t)
+{
+	std::vector<TownID> &slot = _town_growth_schedule[t->grow_tick % TOWN_GROWTH_SCHEDULE_SLOTS];
+	slot.insert(std::lower_bound(slot.begin(), slot.end(), t->index), t->index);
+}
+
+/**
+ * Remove a growing town from the slot of the tick it grows next.
+ * @param t The town.
+ */
+static void UnscheduleTownGrowth(const Town *t)
+{
+	std::vector<TownID> &slot = _town_growth_schedule[t->grow_tick % TOWN_GROWTH_SCHEDULE_SLOTS];
+	std::vector<TownID>::iterator it = std::lower_bound(slot.begin(), slot.end(), t->index);
+	if (it != slot.end() && *it == t->index) slot.erase(it);
+}
+
+/**
+ * Get the number of ticks until the town grows, if it is growing.
+ * @return The counter.
+ */
+uint16 Town::GetGrowCounter() const
+{
+	if (!HasBit(this->flags, TOWN_IS_GROWING)) return this->grow_counter;
+	/* While the towns growing in this tick are handled, their counter is 0. */
+	uint32 ticks_left = this->grow_tick - _town_growth_ticks;
+	return ticks_left == 0 ? 0 : ticks_left - 1;
+}
+
+/**
+ * Set the number of ticks until the town grows, if it is growing.
+ * @param counter The new counter.
+ */
+void Town::SetGrowCounter(uint16 counter)
+{
+	this->grow_counter = counter;
+	if (!HasBit(this->flags, TOWN_IS_GROWING)) return;
+
+	UnscheduleTownGrowth(this);
+	this->grow_tick = _town_growth_ticks + counter + 1;
+	ScheduleTownGrowth(this);
+}
+
+/**
+ * Start or stop the growth of the town, keeping its counter.
+ * @param growing Whether the town should grow.
+ */
+void Town::SetGrowing(bool growing)
+{
+	if (growing == HasBit(this->flags, TOWN_IS_GROWING)) return;
+
+	uint16 counter = this->GetGrowCounter();
+	if (growing) {
+		SetBit(this->flags, TOWN_IS_GROWING);
+		this->SetGrowCounter(counter);
+	} else {
+		UnscheduleTownGrowth(this);
+		ClrBit(this->flags, TOWN_IS_GROWING);
+		this->grow_counter = counter;
+	}
+}
+
+/** Rebuild the growth schedule from the stored counters, e.g. after loading a game. */
+void RebuildTownGrowthSchedule()
+{
+	for (uint i = 0; i < TOWN_GROWTH_SCHEDULE_SLOTS; i++) _town_growth_schedule[i].clear();
+
+	Town *t;
+	FOR_ALL_TOWNS(t) t->SetGrowCounter(t->grow_counter);
+}
+
+/** Clear the growth schedule for a new game. */
+void InitializeTowns()
+{
+	for (uint i = 0; i < TOWN_GROWTH_SCHEDULE_SLOTS; i++) _town_growth_schedule[i].clear();
+	_town_growth_ticks = 0;
+}
+
 Town::~Town()
 {
 	free(this->name);
@@ -66,6 +153,8 @@ Town::~Town()
 
 	if (CleaningPool()) return;
 
+	UnscheduleTownGrowth(this);
+
 	/* Delete town authority window
 	 * and remove from list of sorted towns */
 	DeleteWindowById(WC_TOWN_VIEW, this->index);
@@ -777,29 +866,39 @@ void UpdateTownCargoBitmap()
 
 static bool GrowTown(Town *t);
 
+/**
+ * Handle a growing town whose counter ran out.
+ * @param t The town.
+ */
 static void TownTickHandler(Town *t)
 {
-	if (HasBit(t->flags, TOWN_IS_GROWING)) {
-		int i = (int)t->grow_counter - 1;
-		if (i < 0) {
-			if (GrowTown(t)) {
-				i = t->growth_rate;
-			} else {
-				/* If growth failed wait a bit before retrying */
-				i = min(t->growth_rate, TOWN_GROWTH_TICKS - 1);
-			}
-		}
-		t->grow_counter = i;
+	uint16 i;
+	if (GrowTown(t)) {
+		i = t->growth_rate;
+	} else {
+		/* If growth failed wait a bit before retrying */
+		i = min(t->growth_rate, TOWN_GROWTH_TICKS - 1);
 	}
+	t->SetGrowCounter(i);
 }
 
 void OnTick_Town()
 {
 	if (_game_mode == GM_EDITOR) return;
 
-	Town *t;
-	FOR_ALL_TOWNS(t) {
-		TownTickHandler(t);
+	/* Decrease the counters of all growing towns. */
+	_town_growth_ticks++;
+
+	/* Only handle the towns that grow in this tick, in order of their index.
+	 * Handling a town reschedules it, so collect them first. */
+	const std::vector<TownID> &slot = _town_growth_schedule[_town_growth_ticks % TOWN_GROWTH_SCHEDULE_SLOTS];
+	std::vector<TownID> due;
+	for (std::vector<TownID>::const_iterator it = slot.begin(); it != slot.end(); ++it) {
+		if (Town::Get(*it)->grow_tick == _town_growth_ticks) due.push_back(*it);
+	}
+
+	for (std::vector<TownID>::const_iterator it = due.begin(); it != due.end(); ++it) {
+		TownTickHandler(Town::Get(*it));
 	}
 }
 
@@ -2640,12 +2739,13 @@ CommandCost CmdTownGrowthRate(TileIndex tile, DoCommandFlag flags, uint32 p1, ui
 			ClrBit(t->flags, TOWN_CUSTOM_GROWTH);
 		} else {
 			uint old_rate = t->growth_rate;
-			if (t->grow_counter >= old_rate) {
+			uint16 grow_counter = t->GetGrowCounter();
+			if (grow_counter >= old_rate) {
 				/* This also catches old_rate == 0 */
-				t->grow_counter = p2;
+				t->SetGrowCounter(p2);
 			} else {
 				/* Scale grow_counter, so half finished houses stay half finished */
-				t->grow_counter = t->grow_counter * p2 / old_rate;
+				t->SetGrowCounter(grow_counter * p2 / old_rate);
 			}
 			t->growth_rate = p2;
 			SetBit(t->flags, TOWN_CUSTOM_GROWTH);
@@ -2947,7 +3047,8 @@ static CommandCost TownActionFundBuildings(Town *t, DoCommandFlag flags)
 		 * tick-perfect and gives player some time window where he can
 		 * spam funding with the exact same efficiency.
 		 */
-		t->grow_counter = min(t->grow_counter, 2 * TOWN_GROWTH_TICKS - (t->growth_rate - t->grow_counter) % TOWN_GROWTH_TICKS);
+		uint16 grow_counter = t->GetGrowCounter();
+		t->SetGrowCounter(min(grow_counter, 2 * TOWN_GROWTH_TICKS - (t->growth_rate - grow_counter) % TOWN_GROWTH_TICKS));
 
 		SetWindowDirty(WC_TOWN_VIEW, t->index);
 	}
@@ -3152,10 +3253,10 @@ static void UpdateTownGrowCounter(Town *t, uint16 prev_growth_rate)
 {
 	if (t->growth_rate == TOWN_GROWTH_RATE_NONE) return;
 	if (prev_growth_rate == TOWN_GROWTH_RATE_NONE) {
-		t->grow_counter = min(t->growth_rate, t->grow_counter);
+		t->SetGrowCounter(min(t->growth_rate, t->GetGrowCounter()));
 		return;
 	}
-	t->grow_counter = RoundDivSU((uint32)t->grow_counter * (t->growth_rate + 1), prev_growth_rate + 1);
+	t->SetGrowCounter(RoundDivSU((uint32)t->GetGrowCounter() * (t->growth_rate + 1), prev_growth_rate + 1));
 }
 
 /**
@@ -3222,7 +3323,7 @@ static void UpdateTownGrowth(Town *t)
 {
 	UpdateTownGrowthRate(t);
 
-	ClrBit(t->flags, TOWN_IS_GROWING);
+	t->SetGrowing(false);
 	SetWindowDirty(WC_TOWN_VIEW, t->index);
 
 	if (_settings_game.economy.town_growth_rate == 0 && t->fund_buildings_months == 0) return;
@@ -3245,14 +3346,14 @@ static void UpdateTownGrowth(Town *t)
 	}
 
 	if (HasBit(t->flags, TOWN_CUSTOM_GROWTH)) {
-		if (t->growth_rate != TOWN_GROWTH_RATE_NONE) SetBit(t->flags, TOWN_IS_GROWING);
+		if (t->growth_rate != TOWN_GROWTH_RATE_NONE) t->SetGrowing(true);
 		SetWindowDirty(WC_TOWN_VIEW, t->index);
 		return;
 	}
 
 	if (t->fund_buildings_months == 0 && CountActiveStations(t) == 0 && !Chance16(1, 12)) return;
 
-	SetBit(t->flags, TOWN_IS_GROWING);
+	t->SetGrowing(true);
 	SetWindowDirty(WC_TOWN_VIEW, t->index);
 }
 
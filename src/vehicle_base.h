@@ -24,6 +24,7 @@
 #include "group_type.h"
 #include "base_consist.h"
 #include "network/network.h"
+#include "gfx_func.h"
 #include <list>
 #include <map>
 
@@ -71,6 +72,7 @@ struct NewGRFCache {
 	uint32 consist_cargo_information; ///< Cache for NewGRF var 42. (Note: The cargotype is untranslated in the cache because the accessing GRF is yet unknown.)
 	uint32 company_information;       ///< Cache for NewGRF var 43.
 	uint32 position_in_vehicle;       ///< Cache for NewGRF var 4D.
+	uint32 resolve_epoch;             ///< Identifies the state cached resolver results belong to, 0 if not yet assigned. See #VehicleResolverObject::ResolveCached.
 	uint8  cache_valid;               ///< Bitset that indicates which cache values are valid.
 };
 
@@ -451,6 +453,7 @@ public:
 	inline void InvalidateNewGRFCache()
 	{
 		this->grf_cache.cache_valid = 0;
+		this->grf_cache.resolve_epoch = 0;
 	}
 
 	/**
@@ -1135,8 +1138,8 @@ struct SpecializedVehicle : public Vehicle {
 	 */
 	inline void UpdateViewport(bool force_update, bool update_delta)
 	{
-		/* Skip updating sprites on dedicated servers without screen */
-		if (_network_dedicated) return;
+		/* Skip updating sprites on dedicated servers and other video drivers without screen */
+		if (_headless) return;
 
 		/* Explicitly choose method to call to prevent vtable dereference -
 		 * it gives ~3% runtime improvements in games with many vehicles */
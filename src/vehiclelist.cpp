@@ -120,21 +120,14 @@ bool GenerateVehicleSortList(VehicleList *list, const VehicleListIdentifier &vli
 	const Vehicle *v;
 
 	switch (vli.type) {
-		case VL_STATION_LIST:
-			FOR_ALL_VEHICLES(v) {
-				if (v->type == vli.vtype && v->IsPrimaryVehicle()) {
-					const Order *order;
-
-					FOR_VEHICLE_ORDERS(v, order) {
-						if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT))
-								&& order->GetDestination() == vli.index) {
-							*list->Append() = v;
-							break;
-						}
-					}
-				}
+		case VL_STATION_LIST: {
+			VehicleList candidates;
+			FindVehiclesWithOrderDestination(1 << ODK_STATION | 1 << ODK_IMPLICIT, vli.index, &candidates);
+			for (const Vehicle * const *it = candidates.Begin(); it != candidates.End(); it++) {
+				if ((*it)->type == vli.vtype) *list->Append() = *it;
 			}
 			break;
+		}
 
 		case VL_SHARED_ORDERS:
 			/* Add all vehicles from this vehicle's shared order list */
@@ -166,20 +159,14 @@ bool GenerateVehicleSortList(VehicleList *list, const VehicleListIdentifier &vli
 			}
 			break;
 
-		case VL_DEPOT_LIST:
-			FOR_ALL_VEHICLES(v) {
-				if (v->type == vli.vtype && v->IsPrimaryVehicle()) {
-					const Order *order;
-
-					FOR_VEHICLE_ORDERS(v, order) {
-						if (order->IsType(OT_GOTO_DEPOT) && !(order->GetDepotActionType() & ODATFB_NEAREST_DEPOT) && order->GetDestination() == vli.index) {
-							*list->Append() = v;
-							break;
-						}
-					}
-				}
+		case VL_DEPOT_LIST: {
+			VehicleList candidates;
+			FindVehiclesWithOrderDestination(1 << ODK_DEPOT, vli.index, &candidates);
+			for (const Vehicle * const *it = candidates.Begin(); it != candidates.End(); it++) {
+				if ((*it)->type == vli.vtype) *list->Append() = *it;
 			}
 			break;
+		}
 
 		default: return false;
 	}
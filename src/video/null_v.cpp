@@ -27,18 +27,28 @@ const char *VideoDriver_Null::Start(const char * const *parm)
 #endif
 
 	this->ticks = GetDriverParamInt(parm, "ticks", 1000);
+
+	/* Do not render, nor blit; unless a blitter was asked for, e.g. to measure how fast it draws. */
+	if (_blitter_autodetected) {
+		DEBUG(misc, 1, "Forcing blitter 'null'...");
+		BlitterFactory::SelectBlitter("null");
+	}
+
+	int bpp = BlitterFactory::GetCurrentBlitter()->GetScreenDepth();
+	this->video_mem = (bpp == 0) ? NULL : MallocT<byte>(_cur_resolution.width * _cur_resolution.height * (bpp / 8));
+
 	_screen.width  = _screen.pitch = _cur_resolution.width;
 	_screen.height = _cur_resolution.height;
-	_screen.dst_ptr = NULL;
+	_screen.dst_ptr = this->video_mem;
 	ScreenSizeChanged();
-
-	/* Do not render, nor blit */
-	DEBUG(misc, 1, "Forcing blitter 'null'...");
-	BlitterFactory::SelectBlitter("null");
+	BlitterFactory::GetCurrentBlitter()->PostResize();
 	return NULL;
 }
 
-void VideoDriver_Null::Stop() { }
+void VideoDriver_Null::Stop()
+{
+	free(this->video_mem);
+}
 
 void VideoDriver_Null::MakeDirty(int left, int top, int width, int height) {}
 
@@ -17,7 +17,8 @@
 /** The null video driver. */
 class VideoDriver_Null : public VideoDriver {
 private:
-	uint ticks; ///< Amount of ticks to run.
+	uint ticks;      ///< Amount of ticks to run.
+	void *video_mem; ///< The screen, if the blitter draws anything.
 
 public:
 	/* virtual */ const char *Start(const char * const *param);
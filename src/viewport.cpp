@@ -1273,6 +1273,13 @@ static void ViewportAddSigns(DrawPixelInfo *dpi)
  */
 void ViewportSign::UpdatePosition(int center, int top, StringID str, StringID str_small)
 {
+	/* Without a screen the sign is never drawn, so don't bother measuring its text. */
+	if (_headless) {
+		this->center = center;
+		this->top = top;
+		return;
+	}
+
 	if (this->width_normal != 0) this->MarkDirty();
 
 	this->top = top;
@@ -1300,6 +1307,8 @@ void ViewportSign::UpdatePosition(int center, int top, StringID str, StringID st
  */
 void ViewportSign::MarkDirty(ZoomLevel maxzoom) const
 {
+	if (_headless) return;
+
 	Rect zoomlevels[ZOOM_LVL_COUNT];
 
 	for (ZoomLevel zoom = ZOOM_LVL_BEGIN; zoom != ZOOM_LVL_END; zoom++) {
@@ -1745,6 +1754,8 @@ static void MarkViewportDirty(const ViewPort *vp, int left, int top, int right,
  */
 void MarkAllViewportsDirty(int left, int top, int right, int bottom)
 {
+	if (_headless) return;
+
 	Window *w;
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
 		ViewPort *vp = w->viewport;
@@ -1778,6 +1789,8 @@ void ConstrainAllViewportsZoom()
  */
 void MarkTileDirtyByTile(TileIndex tile, int bridge_level_offset, int tile_height_override)
 {
+	if (_headless) return;
+
 	Point pt = RemapCoords(TileX(tile) * TILE_SIZE, TileY(tile) * TILE_SIZE, tile_height_override * TILE_HEIGHT);
 	MarkAllViewportsDirty(
 			pt.x - MAX_TILE_EXTENT_LEFT,
@@ -59,6 +59,34 @@ Window *_z_front_window = NULL;
 /** List of windows opened at the screen sorted from the back. */
 Window *_z_back_window  = NULL;
 
+/** Number of buckets of the indices of the windows; a power of two. */
+static const uint WINDOW_INDEX_SIZE = 256;
+/** Index of the windows by their class and number, so they can be found without walking the z-ordering. */
+static Window *_window_index[WINDOW_INDEX_SIZE];
+/** Index of the windows by their class, so they can be found without walking the z-ordering. */
+static Window *_window_class_index[WINDOW_INDEX_SIZE];
+
+/**
+ * Get the bucket of the index by class and number a window is in.
+ * @param cls The class of the window.
+ * @param number The number of the window.
+ * @return The bucket.
+ */
+static inline Window **GetWindowIndexBucket(WindowClass cls, WindowNumber number)
+{
+	return &_window_index[((uint)cls * 97 + (uint)number) & (WINDOW_INDEX_SIZE - 1)];
+}
+
+/**
+ * Get the bucket of the index by class a window is in.
+ * @param cls The class of the window.
+ * @return The bucket.
+ */
+static inline Window **GetWindowClassIndexBucket(WindowClass cls)
+{
+	return &_window_class_index[(uint)cls & (WINDOW_INDEX_SIZE - 1)];
+}
+
 /** If false, highlight is white, otherwise the by the widget defined colour. */
 bool _window_highlight_colour = false;
 
@@ -1110,12 +1138,22 @@ Window::~Window()
  */
 Window *FindWindowById(WindowClass cls, WindowNumber number)
 {
-	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) return w;
+	Window *found = NULL;
+	for (Window *w = *GetWindowIndexBucket(cls, number); w != NULL; w = w->index_next) {
+		if (w->window_class != cls || w->window_number != number) continue;
+		if (found == NULL) {
+			found = w;
+			continue;
+		}
+
+		/* There are multiple windows with this number; return the one furthest to the back. */
+		FOR_ALL_WINDOWS_FROM_BACK(w) {
+			if (w->window_class == cls && w->window_number == number) return w;
+		}
+		NOT_REACHED();
 	}
 
-	return NULL;
+	return found;
 }
 
 /**
@@ -1126,12 +1164,22 @@ Window *FindWindowById(WindowClass cls, WindowNumber number)
  */
 Window *FindWindowByClass(WindowClass cls)
 {
-	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) return w;
+	Window *found = NULL;
+	for (Window *w = *GetWindowClassIndexBucket(cls); w != NULL; w = w->class_index_next) {
+		if (w->window_class != cls) continue;
+		if (found == NULL) {
+			found = w;
+			continue;
+		}
+
+		/* There are multiple windows of this class; return the one furthest to the back. */
+		FOR_ALL_WINDOWS_FROM_BACK(w) {
+			if (w->window_class == cls) return w;
+		}
+		NOT_REACHED();
 	}
 
-	return NULL;
+	return found;
 }
 
 /**
@@ -1420,6 +1468,70 @@ static void RemoveWindowFromZOrdering(Window *w)
 	w->z_front = w->z_back = NULL;
 }
 
+/**
+ * Adds a window to the indices by class and number.
+ * The window is indexed by the class of its description, as the class of the
+ * window itself becomes #WC_INVALID when it is deleted, while it is only
+ * removed from the indices when it is freed. So a window may not change its
+ * class; windows that need another class need another description.
+ * @param w Window to add
+ */
+static void AddWindowToIndex(Window *w)
+{
+	Window **bucket = GetWindowIndexBucket(w->window_desc->cls, w->window_number);
+	w->index_next = *bucket;
+	*bucket = w;
+
+	bucket = GetWindowClassIndexBucket(w->window_desc->cls);
+	w->class_index_next = *bucket;
+	*bucket = w;
+}
+
+/**
+ * Removes a window from the indices by class and number.
+ * @param w Window to remove
+ */
+static void RemoveWindowFromIndex(Window *w)
+{
+	Window **v = GetWindowIndexBucket(w->window_desc->cls, w->window_number);
+	while (*v != w) {
+		assert(*v != NULL);
+		v = &(*v)->index_next;
+	}
+	*v = w->index_next;
+	w->index_next = NULL;
+
+	v = GetWindowClassIndexBucket(w->window_desc->cls);
+	while (*v != w) {
+		assert(*v != NULL);
+		v = &(*v)->class_index_next;
+	}
+	*v = w->class_index_next;
+	w->class_index_next = NULL;
+}
+
+/**
+ * Change the number of the window, keeping it findable by its new number.
+ * @param window_number The new number of the window.
+ */
+void Window::ChangeWindowNumber(WindowNumber window_number)
+{
+	/* Only move the window in the index by class and number, so the windows
+	 * of its class can be walked while it changes its number. */
+	Window **v = GetWindowIndexBucket(this->window_desc->cls, this->window_number);
+	while (*v != this) {
+		assert(*v != NULL);
+		v = &(*v)->index_next;
+	}
+	*v = this->index_next;
+
+	this->window_number = window_number;
+
+	v = GetWindowIndexBucket(this->window_desc->cls, this->window_number);
+	this->index_next = *v;
+	*v = this;
+}
+
 /**
  * On clicking on a window, make it the frontmost window of all windows with an equal
  * or lower z-priority. The window is marked dirty for a repaint
@@ -1473,6 +1585,7 @@ void Window::InitializeData(WindowNumber window_number)
 
 	/* Insert the window into the correct location in the z-ordering. */
 	AddWindowToZOrdering(this);
+	AddWindowToIndex(this);
 }
 
 /**
@@ -1877,6 +1990,8 @@ void InitWindowSystem()
 
 	_z_back_window = NULL;
 	_z_front_window = NULL;
+	MemSetT(_window_index, 0, lengthof(_window_index));
+	MemSetT(_window_class_index, 0, lengthof(_window_class_index));
 	_focused_window = NULL;
 	_mouseover_last_w = NULL;
 	_last_scroll_window = NULL;
@@ -1907,6 +2022,8 @@ void UnInitWindowSystem()
 
 	_z_front_window = NULL;
 	_z_back_window = NULL;
+	MemSetT(_window_index, 0, lengthof(_window_index));
+	MemSetT(_window_class_index, 0, lengthof(_window_class_index));
 }
 
 /**
@@ -3059,6 +3176,7 @@ void InputLoop()
 		if (w->window_class != WC_INVALID) continue;
 
 		RemoveWindowFromZOrdering(w);
+		RemoveWindowFromIndex(w);
 		free(w);
 	}
 
@@ -3178,8 +3296,9 @@ void UpdateWindows()
  */
 void SetWindowDirty(WindowClass cls, WindowNumber number)
 {
-	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	if (_headless) return;
+
+	for (const Window *w = *GetWindowIndexBucket(cls, number); w != NULL; w = w->index_next) {
 		if (w->window_class == cls && w->window_number == number) w->SetDirty();
 	}
 }
@@ -3192,8 +3311,9 @@ void SetWindowDirty(WindowClass cls, WindowNumber number)
  */
 void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_index)
 {
-	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	if (_headless) return;
+
+	for (const Window *w = *GetWindowIndexBucket(cls, number); w != NULL; w = w->index_next) {
 		if (w->window_class == cls && w->window_number == number) {
 			w->SetWidgetDirty(widget_index);
 		}
@@ -3206,8 +3326,9 @@ void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_inde
  */
 void SetWindowClassesDirty(WindowClass cls)
 {
-	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	if (_headless) return;
+
+	for (const Window *w = *GetWindowClassIndexBucket(cls); w != NULL; w = w->class_index_next) {
 		if (w->window_class == cls) w->SetDirty();
 	}
 }
@@ -3271,6 +3392,13 @@ void Window::ProcessHighlightedInvalidations()
  * Finally, note that invalidations triggered from commands or the game loop result in OnInvalidateData() being called twice.
  * Once in command-scope, once in GUI-scope. So make sure to not process differential-changes twice.
  *
+ * Without a screen only the main window, the toolbar and the status bar exist, and
+ * their data is never shown; so in that case the invalidation is skipped entirely.
+ *
+ * When multiple windows have the same class and number, they are invalidated in the
+ * order of the index of the windows, i.e. the one that got its number last first,
+ * and not in z-order.
+ *
  * @param cls Window class
  * @param number Window number within the class
  * @param data The data to invalidate with
@@ -3278,11 +3406,15 @@ void Window::ProcessHighlightedInvalidations()
  */
 void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool gui_scope)
 {
-	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	if (_headless) return;
+
+	for (Window *w = *GetWindowIndexBucket(cls, number); w != NULL; /* nothing */) {
+		/* The invalidation might change the number of the window, and with that its bucket. */
+		Window *next = w->index_next;
 		if (w->window_class == cls && w->window_number == number) {
 			w->InvalidateData(data, gui_scope);
 		}
+		w = next;
 	}
 }
 
@@ -3290,15 +3422,17 @@ void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool g
  * Mark window data of all windows of a given class as invalid (in need of re-computing)
  * Note that by default the invalidation is not considered to be called from GUI scope.
  * See InvalidateWindowData() for details on GUI-scope vs. command-scope.
+ * The windows are invalidated in the order of the index of the windows, i.e. the
+ * window opened last first, and not in z-order.
  * @param cls Window class
  * @param data The data to invalidate with
  * @param gui_scope Whether the call is done from GUI scope
  */
 void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
 {
-	Window *w;
+	if (_headless) return;
 
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	for (Window *w = *GetWindowClassIndexBucket(cls); w != NULL; w = w->class_index_next) {
 		if (w->window_class == cls) {
 			w->InvalidateData(data, gui_scope);
 		}
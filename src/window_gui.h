@@ -303,8 +303,8 @@ public:
 
 	WindowDesc *window_desc;    ///< Window description
 	WindowFlags flags;          ///< Window flags
-	WindowClass window_class;   ///< Window class
-	WindowNumber window_number; ///< Window number within the window class
+	WindowClass window_class;   ///< Window class; always the class of #window_desc until the window is deleted
+	WindowNumber window_number; ///< Window number within the window class; change it with #ChangeWindowNumber
 
 	uint8 timeout_timer;      ///< Timer value of the WF_TIMEOUT for flags.
 	uint8 white_border_timer; ///< Timer value of the WF_WHITE_BORDER for flags.
@@ -332,6 +332,8 @@ public:
 	Window *parent;                  ///< Parent window.
 	Window *z_front;                 ///< The window in front of us in z-order.
 	Window *z_back;                  ///< The window behind us in z-order.
+	Window *index_next;              ///< The next window in the same bucket of the index by class and number.
+	Window *class_index_next;        ///< The next window in the same bucket of the index by class.
 
 	template <class NWID>
 	inline const NWID *GetWidget(uint widnum) const;
@@ -514,6 +516,7 @@ public:
 
 	void SetDirty() const;
 	void ReInit(int rx = 0, int ry = 0);
+	void ChangeWindowNumber(WindowNumber window_number);
 
 	/** Is window shaded currently? */
 	inline bool IsShaded() const